@@ -0,0 +1,342 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "util.hpp"
+#include "arg_parser.hpp"
+#include "authenticode.hpp"
+#include "import_index.hpp"
+#include "import_patcher.hpp"
+#include "injector.hpp"
+#include "mapped_file.hpp"
+#include "output_writer.hpp"
+#include "pe_checksum.hpp"
+#include "pe_generator.hpp"
+#include "pe_reader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+
+// the phases main() goes through for a single job, timed separately
+enum class bench_phase {
+    read,
+    signature,
+    parse,
+    lookup,
+    list,
+    modify,
+    build,
+    checksum,
+    write,
+    rebuild,
+    count
+};
+
+constexpr const char* BENCH_PHASE_NAMES[] = { "read", "signature", "parse", "lookup", "list", "modify", "build", "checksum", "write", "rebuild" };
+static_assert(std::size(BENCH_PHASE_NAMES) == static_cast<size_t>(bench_phase::count));
+
+// functions added by the modify phase, enough to force a new import section
+constexpr uint32_t BENCH_ADDED_IMPORTS = 8;
+
+struct bench_case {
+    std::string name;
+    pe_generator_config config;
+    std::string path;
+};
+
+struct bench_samples {
+    std::vector<double> phases[static_cast<size_t>(bench_phase::count)];
+};
+
+class bench_timer {
+public:
+    explicit bench_timer(std::vector<double>& samples) : samples(samples), start(std::chrono::steady_clock::now()) {}
+    ~bench_timer()
+    {
+        samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+private:
+    std::vector<double>& samples;
+    std::chrono::steady_clock::time_point start;
+};
+
+double median_of(std::vector<double> values)
+{
+    if (values.empty()) return 0.0;
+    size_t middle = values.size() / 2;
+    std::ranges::nth_element(values, values.begin() + static_cast<std::ptrdiff_t>(middle));
+    double upper = values[middle];
+    if (values.size() % 2 != 0) return upper;
+    double lower = *std::max_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(middle));
+    return (lower + upper) / 2.0;
+}
+
+// median absolute deviation, tells whether the median can be trusted without being thrown off by one slow run
+double deviation_of(const std::vector<double>& values, double median)
+{
+    std::vector<double> deviations;
+    deviations.reserve(values.size());
+    for (double value : values)
+    {
+        deviations.push_back(std::abs(value - median));
+    }
+    return median_of(std::move(deviations));
+}
+
+bool run_iteration(const bench_case& benchCase, const std::string& scratch, bool includeRebuild, bench_samples& samples, spdlog::logger& quiet)
+{
+    auto samples_of = [&samples](bench_phase phase) -> std::vector<double>& { return samples.phases[static_cast<size_t>(phase)]; };
+
+    mapped_file image;
+    {
+        bench_timer timer(samples_of(bench_phase::read));
+        if (!image.open(benchCase.path)) return false;
+    }
+    {
+        bench_timer timer(samples_of(bench_phase::signature));
+        pe_reader reader(image.bytes());
+        if (!reader.parse() || authenticode::has_signature(reader)) return false;
+    }
+
+    std::unique_ptr<LIEF::PE::Binary> binary;
+    {
+        bench_timer timer(samples_of(bench_phase::parse));
+        // the profile add uses when it patches in place
+        binary = LIEF::PE::Parser::parse(std::make_unique<LIEF::SpanStream>(image.data(), static_cast<size_t>(image.size())),
+            parse_profile::resolve("auto", "add", false));
+    }
+    if (!binary) return false;
+
+    import_index imports;
+    size_t found = 0;
+    {
+        bench_timer timer(samples_of(bench_phase::lookup));
+        imports.build(*binary);
+        for (uint32_t module = 0; module < benchCase.config.modules; ++module)
+        {
+            std::string moduleName = pe_generator::module_name(module);
+            for (uint32_t index = 0; index < benchCase.config.importsPerModule; ++index)
+            {
+                if (imports.find(moduleName, pe_generator::import_name(module, index))) ++found;
+            }
+        }
+    }
+    if (found != static_cast<size_t>(benchCase.config.modules) * benchCase.config.importsPerModule) return false;
+
+    {
+        bench_timer timer(samples_of(bench_phase::list));
+        pe_reader reader(image.bytes());
+        bool parsed = reader.parse();
+        std::vector<pe_export> exports = parsed ? reader.exports() : std::vector<pe_export> {};
+        std::vector<pe_import> delayImports = parsed ? reader.delay_imports() : std::vector<pe_import> {};
+        injection_job job;
+        job.target = benchCase.path;
+        job.format = "tsv";
+        job.output = (std::filesystem::path(scratch) / "list.tsv").string();
+        if (!injector::write_listing(job, imports, delayImports, exports, quiet).success) return false;
+    }
+
+    import_patcher patcher(image.bytes());
+    {
+        bench_timer timer(samples_of(bench_phase::modify));
+        if (!patcher.load()) return false;
+        for (uint32_t index = 0; index < BENCH_ADDED_IMPORTS; ++index)
+        {
+            patcher.add_import("bench.dll", pe_generator::export_name(index));
+        }
+    }
+    {
+        bench_timer timer(samples_of(bench_phase::build));
+        if (!patcher.build()) return false;
+    }
+    {
+        bench_timer timer(samples_of(bench_phase::checksum));
+        pe_reader reader(image.bytes());
+        if (!reader.parse()) return false;
+        (void)pe_checksum::compute(image.bytes(), reader.optional_header_offset() + pe::OPTIONAL_CHECKSUM);
+    }
+    {
+        bench_timer timer(samples_of(bench_phase::write));
+        image.close();
+        if (!patcher.write(benchCase.path, (std::filesystem::path(scratch) / (benchCase.name + "_patched.exe")).string())) return false;
+    }
+
+    if (includeRebuild)
+    {
+        bench_timer timer(samples_of(bench_phase::rebuild));
+        LIEF::PE::Import& library = binary->add_import("bench.dll");
+        for (uint32_t index = 0; index < BENCH_ADDED_IMPORTS; ++index)
+        {
+            library.add_entry(LIEF::PE::ImportEntry(pe_generator::export_name(index)));
+        }
+        LIEF::PE::Builder::config_t builderConfig;
+        builderConfig.imports = true;
+        builderConfig.relocations = true;
+        std::ostringstream output;
+        binary->write(output, builderConfig);
+    }
+    return true;
+}
+
+uint32_t number_arg(const arg_parser& parser, const std::string& name, uint32_t fallback)
+{
+    if (!parser.has_arg(name)) return fallback;
+    try
+    {
+        return static_cast<uint32_t>(std::stoul(parser.get_arg_value(name)));
+    }
+    catch (const std::exception&)
+    {
+        spdlog::warn("Invalid value for --{}, using {}", name, fallback);
+        return fallback;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    auto console = spdlog::stdout_color_mt("console");
+    console->set_pattern("%v");
+    spdlog::set_default_logger(console);
+    LIEF::logging::set_level(LIEF::logging::LEVEL::ERR);
+
+    arg_parser parser;
+    parser.set_description("Times every phase of a single job against synthetic PE32 and PE32+ images.\n"
+                           "Reports the median of all iterations after the warmup runs.\n");
+    parser.add_default_arg("help", "", "Show help message", false, true);
+    parser.add_default_arg("iterations", "15", "Timed runs per image", false, false, "Defaults to 15");
+    parser.add_default_arg("warmup", "2", "Untimed runs before the timed ones", false, false, "Defaults to 2");
+    parser.add_default_arg("modules", "16", "Imported modules in the synthetic images", false, false, "Defaults to 16");
+    parser.add_default_arg("imports", "64", "Imports per module", false, false, "Defaults to 64");
+    parser.add_default_arg("exports", "256", "Exports in the synthetic images", false, false, "Defaults to 256");
+    parser.add_default_arg("size", "4", "Minimum image size in MiB", false, false, "Padded with a .data section, defaults to 0 (as small as possible)");
+    parser.add_default_arg("rebuild", "", "Also time a full LIEF rebuild", false, true, "Slow on big images, off by default");
+    parser.add_default_arg("directory", "bench", "Scratch directory for the images and outputs", false, false, "Defaults to a directory in the system temp path");
+    parser.add_default_arg("output", "bench.tsv", "Also write the results as tsv", false, false, "One row per image and phase: image, phase, median_ms, mad_ms, min_ms, max_ms");
+
+    if (!parser.parse_args(argc, argv))
+    {
+        parser.print_help();
+        return 1;
+    }
+    if (parser.has_flag("help"))
+    {
+        parser.print_help();
+        return 0;
+    }
+    // every argument is optional, only check what was given
+    if (!parser.args.empty() && !parser.validate_args())
+    {
+        parser.print_help();
+        return 1;
+    }
+
+    // a wrong kernel would time fine and write broken checksums, so it has to agree with the scalar sum first
+    std::string checksumError;
+    if (!pe_checksum::self_check(checksumError))
+    {
+        spdlog::critical("Checksum self-check failed: {}", checksumError);
+        return 1;
+    }
+    spdlog::info("checksum: the {} kernel matches the scalar sum", pe_checksum::kernel());
+
+    uint32_t iterations = std::max<uint32_t>(number_arg(parser, "iterations", 15), 1);
+    uint32_t warmup = number_arg(parser, "warmup", 2);
+    bool includeRebuild = parser.has_flag("rebuild");
+
+    pe_generator_config config;
+    config.modules = number_arg(parser, "modules", config.modules);
+    config.importsPerModule = number_arg(parser, "imports", config.importsPerModule);
+    config.exports = number_arg(parser, "exports", config.exports);
+    config.imageSize = static_cast<uint64_t>(number_arg(parser, "size", 0)) << 20;
+
+    std::string scratch = parser.has_arg("directory") ? parser.get_arg_value("directory") : (std::filesystem::temp_directory_path() / "StaticInjectionBench").string();
+    std::error_code ec;
+    std::filesystem::create_directories(scratch, ec);
+
+    std::vector<bench_case> cases;
+    for (bool pe32Plus : { false, true })
+    {
+        bench_case benchCase;
+        benchCase.name = pe32Plus ? "pe32plus" : "pe32";
+        benchCase.config = config;
+        benchCase.config.pe32Plus = pe32Plus;
+        benchCase.path = (std::filesystem::path(scratch) / (benchCase.name + ".exe")).string();
+
+        std::vector<uint8_t> image = pe_generator::generate(benchCase.config);
+        std::ofstream file(benchCase.path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+        if (!file.good())
+        {
+            spdlog::critical("Failed to write {}", benchCase.path);
+            return 1;
+        }
+        spdlog::info("{}: {} modules x {} imports, {} exports, {} bytes", benchCase.name, config.modules, config.importsPerModule, config.exports, image.size());
+        cases.push_back(std::move(benchCase));
+    }
+
+    // the phases log nothing useful while being timed, keep them off the console
+    spdlog::logger quiet("bench");
+    quiet.set_level(spdlog::level::off);
+
+    output_writer results;
+    bool writeResults = parser.has_arg("output");
+    if (writeResults)
+    {
+        if (!results.open(parser.get_arg_value("output")))
+        {
+            spdlog::critical("Failed to open the output! ({})", results.error());
+            return 1;
+        }
+        results.write("image\tphase\tmedian_ms\tmad_ms\tmin_ms\tmax_ms\n");
+    }
+
+    for (const auto& benchCase : cases)
+    {
+        bench_samples discarded;
+        for (uint32_t i = 0; i < warmup; ++i)
+        {
+            (void)run_iteration(benchCase, scratch, includeRebuild, discarded, quiet);
+        }
+
+        bench_samples samples;
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            if (!run_iteration(benchCase, scratch, includeRebuild, samples, quiet))
+            {
+                spdlog::critical("{}: iteration {} failed", benchCase.name, i + 1);
+                return 1;
+            }
+        }
+
+        spdlog::info("");
+        spdlog::info("{} ({} iterations)", benchCase.name, iterations);
+        spdlog::info("  {:<10} {:>10} {:>10} {:>10} {:>10}", "phase", "median ms", "mad ms", "min ms", "max ms");
+        double total = 0.0;
+        for (size_t phase = 0; phase < static_cast<size_t>(bench_phase::count); ++phase)
+        {
+            const std::vector<double>& values = samples.phases[phase];
+            if (values.empty()) continue;
+            double median = median_of(values);
+            double deviation = deviation_of(values, median);
+            auto [low, high] = std::ranges::minmax(values);
+            total += median;
+            spdlog::info("  {:<10} {:>10.3f} {:>10.3f} {:>10.3f} {:>10.3f}", BENCH_PHASE_NAMES[phase], median, deviation, low, high);
+
+            if (writeResults)
+            {
+                results.write(fmt::format("{}\t{}\t{:.4f}\t{:.4f}\t{:.4f}\t{:.4f}\n", benchCase.name, BENCH_PHASE_NAMES[phase], median, deviation, low, high));
+            }
+        }
+        spdlog::info("  {:<10} {:>10.3f}", "total", total);
+    }
+
+    if (writeResults && !results.close())
+    {
+        spdlog::critical("Failed to write the results! ({})", results.error());
+        return 1;
+    }
+    return 0;
+}
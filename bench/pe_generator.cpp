@@ -0,0 +1,221 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "pe_generator.hpp"
+#include "pe_format.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+constexpr uint32_t GENERATOR_FILE_ALIGNMENT = 0x200;
+constexpr uint32_t GENERATOR_SECTION_ALIGNMENT = 0x1000;
+constexpr uint32_t GENERATOR_HEADERS_SIZE = 0x400;
+constexpr uint32_t GENERATOR_NT_OFFSET = 0x80;
+
+std::string pe_generator::module_name(uint32_t module)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "mod%04u.dll", module);
+    return name;
+}
+
+std::string pe_generator::import_name(uint32_t module, uint32_t index)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "Import%04u_%04u", module, index);
+    return name;
+}
+
+std::string pe_generator::export_name(uint32_t index)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "Export%06u", index);
+    return name;
+}
+
+std::vector<uint8_t> pe_generator::generate(const pe_generator_config& config)
+{
+    const uint32_t width = config.pe32Plus ? 8 : 4;
+    const uint32_t textRva = GENERATOR_SECTION_ALIGNMENT;
+    const uint32_t rdataRva = textRva + GENERATOR_SECTION_ALIGNMENT;
+
+    // .rdata is laid out first relative to its own start, rvas are fixed up with rdataRva
+    std::vector<uint8_t> rdata;
+    auto reserve = [&rdata](size_t size, size_t alignment) {
+        rdata.resize(pe::align_up(rdata.size(), alignment));
+        size_t offset = rdata.size();
+        rdata.resize(offset + size, 0);
+        return static_cast<uint32_t>(offset);
+    };
+    auto add_string = [&](const std::string& text, size_t alignment) {
+        uint32_t offset = reserve(text.size() + 1, alignment);
+        std::memcpy(rdata.data() + offset, text.data(), text.size());
+        return offset;
+    };
+    auto put_thunk = [&](uint32_t offset, uint64_t value) {
+        if (config.pe32Plus) pe::write<uint64_t>(rdata.data() + offset, value);
+        else pe::write<uint32_t>(rdata.data() + offset, static_cast<uint32_t>(value));
+    };
+
+    uint32_t descriptorTable = reserve((config.modules + 1) * sizeof(pe::import_descriptor), 4);
+    std::vector<uint32_t> lookupTables(config.modules);
+    std::vector<uint32_t> addressTables(config.modules);
+    for (uint32_t module = 0; module < config.modules; ++module)
+    {
+        lookupTables[module] = reserve((config.importsPerModule + 1) * width, width);
+    }
+    uint32_t iatStart = static_cast<uint32_t>(pe::align_up(rdata.size(), width));
+    for (uint32_t module = 0; module < config.modules; ++module)
+    {
+        addressTables[module] = reserve((config.importsPerModule + 1) * width, width);
+    }
+    uint32_t iatSize = static_cast<uint32_t>(rdata.size()) - iatStart;
+
+    for (uint32_t module = 0; module < config.modules; ++module)
+    {
+        for (uint32_t index = 0; index < config.importsPerModule; ++index)
+        {
+            // hint/name entry: a 2 byte hint followed by the name
+            uint32_t entry = reserve(2, 2);
+            add_string(import_name(module, index), 1);
+            pe::write<uint16_t>(rdata.data() + entry, static_cast<uint16_t>(index));
+            put_thunk(lookupTables[module] + index * width, rdataRva + entry);
+            put_thunk(addressTables[module] + index * width, rdataRva + entry);
+        }
+
+        pe::import_descriptor descriptor {};
+        descriptor.OriginalFirstThunk = rdataRva + lookupTables[module];
+        descriptor.FirstThunk = rdataRva + addressTables[module];
+        descriptor.Name = rdataRva + add_string(module_name(module), 2);
+        pe::write(rdata.data() + descriptorTable + module * sizeof(pe::import_descriptor), descriptor);
+    }
+
+    uint32_t exportStart = 0;
+    uint32_t exportSize = 0;
+    if (config.exports != 0)
+    {
+        exportStart = reserve(sizeof(pe::export_directory), 4);
+        uint32_t functions = reserve(config.exports * 4, 4);
+        uint32_t names = reserve(config.exports * 4, 4);
+        uint32_t ordinals = reserve(config.exports * 2, 2);
+
+        pe::export_directory directory {};
+        directory.Name = rdataRva + add_string("synthetic.exe", 1);
+        directory.Base = 1;
+        directory.NumberOfFunctions = config.exports;
+        directory.NumberOfNames = config.exports;
+        directory.AddressOfFunctions = rdataRva + functions;
+        directory.AddressOfNames = rdataRva + names;
+        directory.AddressOfNameOrdinals = rdataRva + ordinals;
+        // zero padded names are already in the order the name pointer table needs
+        for (uint32_t index = 0; index < config.exports; ++index)
+        {
+            pe::write<uint32_t>(rdata.data() + functions + index * 4, textRva + index % 16);
+            pe::write<uint32_t>(rdata.data() + names + index * 4, rdataRva + add_string(export_name(index), 1));
+            pe::write<uint16_t>(rdata.data() + ordinals + index * 2, static_cast<uint16_t>(index));
+        }
+        pe::write(rdata.data() + exportStart, directory);
+        exportSize = static_cast<uint32_t>(rdata.size()) - exportStart;
+    }
+
+    std::vector<uint8_t> text(GENERATOR_FILE_ALIGNMENT, 0xCC);
+    text[0] = 0xC3; // ret
+
+    uint32_t rdataRawSize = static_cast<uint32_t>(pe::align_up(rdata.size(), GENERATOR_FILE_ALIGNMENT));
+    uint32_t dataRva = static_cast<uint32_t>(pe::align_up(rdataRva + rdata.size(), GENERATOR_SECTION_ALIGNMENT));
+    uint64_t used = GENERATOR_HEADERS_SIZE + text.size() + rdataRawSize;
+    uint32_t dataRawSize = config.imageSize > used ? static_cast<uint32_t>(pe::align_up(config.imageSize - used, GENERATOR_FILE_ALIGNMENT)) : 0;
+
+    std::vector<pe::section_header> sections;
+    auto add_section = [&sections](const char* name, uint32_t rva, uint32_t virtualSize, uint32_t rawSize, uint32_t rawOffset, uint32_t characteristics) {
+        pe::section_header section {};
+        std::memcpy(section.Name, name, std::min<size_t>(std::strlen(name), sizeof(section.Name)));
+        section.VirtualAddress = rva;
+        section.VirtualSize = virtualSize;
+        section.SizeOfRawData = rawSize;
+        section.PointerToRawData = rawOffset;
+        section.Characteristics = characteristics;
+        sections.push_back(section);
+    };
+    add_section(".text", textRva, static_cast<uint32_t>(text.size()), static_cast<uint32_t>(text.size()), GENERATOR_HEADERS_SIZE,
+        pe::SCN_CNT_CODE | pe::SCN_MEM_EXECUTE | pe::SCN_MEM_READ);
+    add_section(".rdata", rdataRva, static_cast<uint32_t>(rdata.size()), rdataRawSize, GENERATOR_HEADERS_SIZE + static_cast<uint32_t>(text.size()),
+        pe::SCN_CNT_INITIALIZED_DATA | pe::SCN_MEM_READ);
+    if (dataRawSize != 0)
+    {
+        add_section(".data", dataRva, dataRawSize, dataRawSize, GENERATOR_HEADERS_SIZE + static_cast<uint32_t>(text.size()) + rdataRawSize,
+            pe::SCN_CNT_INITIALIZED_DATA | pe::SCN_MEM_READ | pe::SCN_MEM_WRITE);
+    }
+    const pe::section_header& last = sections.back();
+    uint32_t sizeOfImage = static_cast<uint32_t>(pe::align_up(last.VirtualAddress + last.VirtualSize, GENERATOR_SECTION_ALIGNMENT));
+
+    std::vector<uint8_t> image(GENERATOR_HEADERS_SIZE, 0);
+    pe::dos_header dos {};
+    dos.e_magic = pe::DOS_MAGIC;
+    dos.e_lfanew = GENERATOR_NT_OFFSET;
+    pe::write(image.data(), dos);
+    pe::write(image.data() + GENERATOR_NT_OFFSET, pe::NT_SIGNATURE);
+
+    pe::file_header fileHeader {};
+    fileHeader.Machine = config.pe32Plus ? 0x8664 : 0x14C;
+    fileHeader.NumberOfSections = static_cast<uint16_t>(sections.size());
+    fileHeader.SizeOfOptionalHeader = config.pe32Plus ? sizeof(pe::optional_header64) : sizeof(pe::optional_header32);
+    fileHeader.Characteristics = config.pe32Plus ? 0x0023 : 0x0103; // relocs stripped, executable, large address aware / 32 bit machine
+    uint32_t optionalOffset = GENERATOR_NT_OFFSET + 4 + sizeof(pe::file_header);
+    pe::write(image.data() + GENERATOR_NT_OFFSET + 4, fileHeader);
+
+    auto fill_optional = [&](auto& optional) {
+        optional.SizeOfCode = static_cast<uint32_t>(text.size());
+        optional.SizeOfInitializedData = rdataRawSize + dataRawSize;
+        optional.AddressOfEntryPoint = textRva;
+        optional.BaseOfCode = textRva;
+        optional.SectionAlignment = GENERATOR_SECTION_ALIGNMENT;
+        optional.FileAlignment = GENERATOR_FILE_ALIGNMENT;
+        optional.MajorOperatingSystemVersion = 6;
+        optional.MajorSubsystemVersion = 6;
+        optional.SizeOfImage = sizeOfImage;
+        optional.SizeOfHeaders = GENERATOR_HEADERS_SIZE;
+        optional.Subsystem = 3; // console
+        optional.DllCharacteristics = 0x8100; // nx compat, terminal server aware, no relocations so no dynamic base
+        optional.SizeOfStackReserve = 0x100000;
+        optional.SizeOfStackCommit = 0x1000;
+        optional.SizeOfHeapReserve = 0x100000;
+        optional.SizeOfHeapCommit = 0x1000;
+        optional.NumberOfRvaAndSizes = pe::NUMBER_OF_DIRECTORIES;
+        if (config.modules != 0)
+        {
+            optional.DataDirectory[pe::DIRECTORY_IMPORT] = { rdataRva + descriptorTable, (config.modules + 1) * static_cast<uint32_t>(sizeof(pe::import_descriptor)) };
+            optional.DataDirectory[pe::DIRECTORY_IAT] = { rdataRva + iatStart, iatSize };
+        }
+        if (config.exports != 0) optional.DataDirectory[pe::DIRECTORY_EXPORT] = { rdataRva + exportStart, exportSize };
+        pe::write(image.data() + optionalOffset, optional);
+    };
+    if (config.pe32Plus)
+    {
+        pe::optional_header64 optional {};
+        optional.Magic = pe::PE32_PLUS_MAGIC;
+        optional.ImageBase = 0x140000000ull;
+        fill_optional(optional);
+    } else
+    {
+        pe::optional_header32 optional {};
+        optional.Magic = pe::PE32_MAGIC;
+        optional.ImageBase = 0x400000;
+        optional.BaseOfData = rdataRva;
+        fill_optional(optional);
+    }
+
+    uint32_t sectionTable = optionalOffset + fileHeader.SizeOfOptionalHeader;
+    for (size_t i = 0; i < sections.size(); ++i)
+    {
+        pe::write(image.data() + sectionTable + i * sizeof(pe::section_header), sections[i]);
+    }
+
+    image.insert(image.end(), text.begin(), text.end());
+    rdata.resize(rdataRawSize, 0);
+    image.insert(image.end(), rdata.begin(), rdata.end());
+    image.resize(image.size() + dataRawSize, 0);
+    return image;
+}
@@ -0,0 +1,25 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct pe_generator_config {
+    bool pe32Plus = true;
+    uint32_t modules = 16;
+    uint32_t importsPerModule = 64;
+    uint32_t exports = 256;
+    uint64_t imageSize = 0; // the file is padded with a .data section up to this size, 0 keeps it as small as possible
+};
+
+// builds well-formed synthetic PE32/PE32+ images so the benchmarks don't depend on binaries lying around
+// imports are named mod0000.dll::Import0000_0000 and exports Export000000, both sorted like a linker would
+class pe_generator {
+public:
+    [[nodiscard]] static std::vector<uint8_t> generate(const pe_generator_config& config);
+    [[nodiscard]] static std::string module_name(uint32_t module);
+    [[nodiscard]] static std::string import_name(uint32_t module, uint32_t index);
+    [[nodiscard]] static std::string export_name(uint32_t index);
+};
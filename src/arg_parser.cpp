@@ -39,6 +39,17 @@ std::string arg_parser::get_arg_value(const std::string& name) const
     return "";
 }
 
+std::vector<std::string> arg_parser::get_arg_values(const std::string& name) const
+{
+    std::vector<std::string> values;
+    for (const auto& arg : args) {
+        if (arg.name == name && arg.has_value()) {
+            values.push_back(arg.value);
+        }
+    }
+    return values;
+}
+
 bool arg_parser::parse_args(const int argc, char* argv[])
 {
     for (int i = 1; i < argc; ++i) {
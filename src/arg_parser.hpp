@@ -47,6 +47,7 @@ public:
     [[nodiscard]] bool has_flag(const std::string& name) const;
     [[nodiscard]] bool has_arg(const std::string& name) const;
     [[nodiscard]] std::string get_arg_value(const std::string& name) const;
+    [[nodiscard]] std::vector<std::string> get_arg_values(const std::string& name) const;
 
     [[nodiscard]] bool parse_args(int argc, char* argv[]);
     [[nodiscard]] bool validate_args() const;
@@ -0,0 +1,112 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "authenticode.hpp"
+#include "sha.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+
+constexpr uint16_t WIN_CERT_TYPE_PKCS_SIGNED_DATA = 0x0002;
+constexpr uint32_t WIN_CERTIFICATE_HEADER_SIZE = 8;
+
+bool authenticode::has_signature(const pe_reader& reader)
+{
+    // unlike every other directory the security entry holds a file offset, not an rva
+    pe::data_directory security = reader.directory(pe::DIRECTORY_SECURITY);
+    if (security.VirtualAddress == 0 || security.Size < WIN_CERTIFICATE_HEADER_SIZE) return false;
+    return static_cast<uint64_t>(security.VirtualAddress) + security.Size <= reader.bytes().size();
+}
+
+std::vector<uint8_t> authenticode::digest(const pe_reader& reader, authenticode_algorithm algorithm)
+{
+    std::span<const uint8_t> image = reader.bytes();
+
+    // holes in the hashed range, sorted by offset
+    std::vector<std::pair<uint64_t, uint64_t>> excluded;
+    excluded.emplace_back(reader.optional_header_offset() + pe::OPTIONAL_CHECKSUM, 4);
+    if (reader.directory_count() > pe::DIRECTORY_SECURITY)
+    {
+        excluded.emplace_back(reader.data_directory_offset() + pe::DIRECTORY_SECURITY * sizeof(pe::data_directory), sizeof(pe::data_directory));
+    }
+    if (has_signature(reader))
+    {
+        pe::data_directory security = reader.directory(pe::DIRECTORY_SECURITY);
+        excluded.emplace_back(security.VirtualAddress, security.Size);
+    }
+    std::ranges::sort(excluded);
+
+    sha1 sha1Hash;
+    sha256 sha256Hash;
+    auto feed = [&](uint64_t begin, uint64_t end) {
+        if (end <= begin) return;
+        std::span<const uint8_t> range = image.subspan(static_cast<size_t>(begin), static_cast<size_t>(end - begin));
+        if (algorithm == authenticode_algorithm::sha1) sha1Hash.update(range);
+        else sha256Hash.update(range);
+    };
+
+    uint64_t position = 0;
+    for (const auto& [offset, size] : excluded)
+    {
+        feed(position, std::min<uint64_t>(offset, image.size()));
+        position = std::max(position, std::min<uint64_t>(offset + size, image.size()));
+    }
+    feed(position, image.size());
+
+    if (algorithm == authenticode_algorithm::sha1)
+    {
+        auto result = sha1Hash.finish();
+        return { result.begin(), result.end() };
+    }
+    auto result = sha256Hash.finish();
+    return { result.begin(), result.end() };
+}
+
+signature_check authenticode::verify(const pe_reader& reader)
+{
+    signature_check check;
+    if (!has_signature(reader)) return check;
+
+    pe::data_directory security = reader.directory(pe::DIRECTORY_SECURITY);
+    const uint8_t* entry = reader.bytes().data() + security.VirtualAddress;
+    uint32_t length = pe::read<uint32_t>(entry);
+    uint16_t type = pe::read<uint16_t>(entry + 6);
+    if (length < WIN_CERTIFICATE_HEADER_SIZE || length > security.Size || type != WIN_CERT_TYPE_PKCS_SIGNED_DATA)
+    {
+        check.status = signature_status::unsupported;
+        check.details = "the certificate table doesn't start with a pkcs#7 SignedData entry";
+        return check;
+    }
+
+    auto signature = LIEF::PE::SignatureParser::parse(std::vector<uint8_t>(entry, entry + length), true);
+    if (!signature)
+    {
+        check.status = signature_status::unsupported;
+        check.details = "failed to parse the pkcs#7 SignedData";
+        return check;
+    }
+
+    const LIEF::PE::ContentInfo& content = signature->content_info();
+    authenticode_algorithm algorithm;
+    switch (content.digest_algorithm())
+    {
+    case LIEF::PE::ALGORITHMS::SHA_1:
+        algorithm = authenticode_algorithm::sha1;
+        check.algorithm = "sha1";
+        break;
+    case LIEF::PE::ALGORITHMS::SHA_256:
+        algorithm = authenticode_algorithm::sha256;
+        check.algorithm = "sha256";
+        break;
+    default:
+        check.status = signature_status::unsupported;
+        check.details = "the signature uses a digest other than sha1 or sha256";
+        return check;
+    }
+
+    std::vector<uint8_t> expected = content.digest();
+    std::vector<uint8_t> actual = digest(reader, algorithm);
+    check.status = expected == actual ? signature_status::intact : signature_status::modified;
+    return check;
+}
@@ -0,0 +1,41 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include "pe_reader.hpp"
+
+#include <string>
+#include <vector>
+
+enum class authenticode_algorithm {
+    sha1,
+    sha256
+};
+
+enum class signature_status {
+    unsigned_image,
+    intact,      // the stored digest matches the image
+    modified,    // the image changed after it was signed
+    unsupported  // couldn't parse the signature or it uses a digest we don't compute
+};
+
+struct signature_check {
+    signature_status status = signature_status::unsigned_image;
+    std::string algorithm;
+    std::string details;
+};
+
+// signature handling straight from the security directory of a mapped image, no windows api involved
+class authenticode {
+public:
+    // the security directory points at a certificate table that lies inside the file
+    [[nodiscard]] static bool has_signature(const pe_reader& reader);
+
+    // the authenticode image hash: every byte of the file except the checksum, the security directory entry and the certificate table
+    // streamed over the mapping in a single pass
+    [[nodiscard]] static std::vector<uint8_t> digest(const pe_reader& reader, authenticode_algorithm algorithm);
+
+    // compares the digest stored in the pkcs#7 SignedData with a freshly computed one
+    // this proves the image wasn't changed after signing, it doesn't validate the certificate chain
+    [[nodiscard]] static signature_check verify(const pe_reader& reader);
+};
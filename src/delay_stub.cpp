@@ -0,0 +1,207 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "delay_stub.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+// FAST_FAIL_FATAL_APP_EXIT, raised with int 29h when the DLL or the function can't be resolved
+// the import would have failed the process at startup the same way if it was a regular one
+constexpr uint8_t DELAY_STUB_FAIL_CODE = 7;
+
+// a forward jump waiting for bind(), width is the size of its displacement
+struct delay_stub_jump {
+    size_t operand;
+    size_t width;
+};
+
+// tiny assembler buffer, rel32 operands are computed against the rva the code will live at
+class delay_stub_code {
+public:
+    explicit delay_stub_code(uint32_t rva) : base(rva) {}
+
+    void emit(std::initializer_list<uint8_t> bytes) { code.insert(code.end(), bytes.begin(), bytes.end()); }
+    void emit_u32(uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i) code.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+    // for operands that end the instruction, which holds for every rip relative form used here
+    void emit_rel32(uint32_t target) { emit_u32(target - (here() + 4)); }
+
+    // forward jumps, the displacement is filled in by bind()
+    [[nodiscard]] delay_stub_jump jump8(uint8_t opcode)
+    {
+        code.push_back(opcode);
+        code.push_back(0);
+        return { code.size() - 1, 1 };
+    }
+    // the rel32 form of a short jcc opcode (0x7x becomes 0x0F 0x8x), for targets past the rel8 range
+    [[nodiscard]] delay_stub_jump jump32(uint8_t opcode)
+    {
+        emit({ 0x0F, static_cast<uint8_t>(opcode + 0x10) });
+        emit_u32(0);
+        return { code.size() - 4, 4 };
+    }
+    void bind(delay_stub_jump jump)
+    {
+        size_t distance = code.size() - (jump.operand + jump.width);
+        // a short jump that grew past its range would land in the middle of some instruction
+        assert(jump.width == 4 || distance <= INT8_MAX);
+        for (size_t i = 0; i < jump.width; ++i) code[jump.operand + i] = static_cast<uint8_t>(distance >> (i * 8));
+    }
+
+    [[nodiscard]] uint32_t here() const { return base + static_cast<uint32_t>(code.size()); }
+    [[nodiscard]] std::vector<uint8_t> take() { return std::move(code); }
+
+private:
+    uint32_t base;
+    std::vector<uint8_t> code;
+};
+
+std::vector<uint8_t> delay_stub::resolver(bool pe32Plus, uint32_t rva, const delay_stub_layout& layout)
+{
+    return pe32Plus ? resolver64(rva, layout) : resolver32(rva, layout);
+}
+
+std::vector<uint8_t> delay_stub::thunk(bool pe32Plus, uint32_t rva, uint32_t slotRva, uint32_t iatRva, uint32_t resolverRva)
+{
+    delay_stub_code code(rva);
+    if (pe32Plus)
+    {
+        code.emit({ 0x48, 0x8D, 0x05 }); // lea rax, [rip + slot]
+        code.emit_rel32(slotRva);
+    } else
+    {
+        code.emit({ 0x68 });             // push slot offset into the IAT
+        code.emit_u32(slotRva - iatRva);
+    }
+    code.emit({ 0xE9 });                 // jmp resolver
+    code.emit_rel32(resolverRva);
+    return code.take();
+}
+
+std::vector<uint8_t> delay_stub::resolver64(uint32_t rva, const delay_stub_layout& layout)
+{
+    // entered from a thunk with rax = the IAT slot and the caller's arguments still in rcx, rdx, r8, r9 and xmm0-3
+    delay_stub_code code(rva);
+    code.emit({ 0x50, 0x51, 0x52, 0x41, 0x50, 0x41, 0x51 }); // push rax, rcx, rdx, r8, r9
+    code.emit({ 0x48, 0x83, 0xEC, 0x60 });                    // sub rsp, 0x60: shadow space plus xmm0-3, keeps rsp 16 byte aligned
+    code.emit({ 0xF3, 0x0F, 0x7F, 0x44, 0x24, 0x20 });        // movdqu [rsp + 0x20], xmm0
+    code.emit({ 0xF3, 0x0F, 0x7F, 0x4C, 0x24, 0x30 });        // movdqu [rsp + 0x30], xmm1
+    code.emit({ 0xF3, 0x0F, 0x7F, 0x54, 0x24, 0x40 });        // movdqu [rsp + 0x40], xmm2
+    code.emit({ 0xF3, 0x0F, 0x7F, 0x5C, 0x24, 0x50 });        // movdqu [rsp + 0x50], xmm3
+
+    code.emit({ 0x48, 0x8B, 0x0D });                          // mov rcx, [rip + module handle]
+    code.emit_rel32(layout.moduleHandle);
+    code.emit({ 0x48, 0x85, 0xC9 });                          // test rcx, rcx
+    delay_stub_jump haveModule = code.jump8(0x75);            // jnz have_module
+    code.emit({ 0x48, 0x8D, 0x0D });                          // lea rcx, [rip + module name]
+    code.emit_rel32(layout.moduleName);
+    code.emit({ 0xFF, 0x15 });                                // call [rip + LoadLibraryA]
+    code.emit_rel32(layout.loadLibrary);
+    code.emit({ 0x48, 0x85, 0xC0 });                          // test rax, rax
+    delay_stub_jump failLoad = code.jump32(0x74);             // jz fail
+    code.emit({ 0x48, 0x89, 0x05 });                          // mov [rip + module handle], rax
+    code.emit_rel32(layout.moduleHandle);
+    code.emit({ 0x48, 0x89, 0xC1 });                          // mov rcx, rax
+    code.bind(haveModule);
+
+    // the INT entry sits at the same offset from the INT as the slot from the IAT
+    code.emit({ 0x48, 0x8B, 0x94, 0x24, 0x80, 0x00, 0x00, 0x00 }); // mov rdx, [rsp + 0x80] (the saved slot)
+    code.emit({ 0x48, 0x8D, 0x05 });                          // lea rax, [rip + IAT]
+    code.emit_rel32(layout.iat);
+    code.emit({ 0x48, 0x29, 0xC2 });                          // sub rdx, rax
+    code.emit({ 0x48, 0x8D, 0x05 });                          // lea rax, [rip + INT]
+    code.emit_rel32(layout.names);
+    code.emit({ 0x48, 0x8B, 0x14, 0x10 });                    // mov rdx, [rax + rdx]
+    code.emit({ 0x48, 0x85, 0xD2 });                          // test rdx, rdx
+    delay_stub_jump byOrdinal = code.jump8(0x78);             // js by_ordinal
+    code.emit({ 0x48, 0x8D, 0x05 });                          // lea rax, [rip + image base]
+    code.emit_rel32(0);
+    code.emit({ 0x48, 0x8D, 0x54, 0x10, 0x02 });              // lea rdx, [rax + rdx + 2] (skip the hint)
+    delay_stub_jump resolve = code.jump8(0xEB);               // jmp resolve
+    code.bind(byOrdinal);
+    code.emit({ 0x0F, 0xB7, 0xD2 });                          // movzx edx, dx
+    code.bind(resolve);
+    code.emit({ 0xFF, 0x15 });                                // call [rip + GetProcAddress]
+    code.emit_rel32(layout.getProcAddress);
+    code.emit({ 0x48, 0x85, 0xC0 });                          // test rax, rax
+    delay_stub_jump failResolve = code.jump32(0x74);          // jz fail
+    code.emit({ 0x48, 0x8B, 0x94, 0x24, 0x80, 0x00, 0x00, 0x00 }); // mov rdx, [rsp + 0x80]
+    code.emit({ 0x48, 0x89, 0x02 });                          // mov [rdx], rax, later calls go straight to the function
+
+    code.emit({ 0xF3, 0x0F, 0x6F, 0x44, 0x24, 0x20 });        // movdqu xmm0, [rsp + 0x20]
+    code.emit({ 0xF3, 0x0F, 0x6F, 0x4C, 0x24, 0x30 });        // movdqu xmm1, [rsp + 0x30]
+    code.emit({ 0xF3, 0x0F, 0x6F, 0x54, 0x24, 0x40 });        // movdqu xmm2, [rsp + 0x40]
+    code.emit({ 0xF3, 0x0F, 0x6F, 0x5C, 0x24, 0x50 });        // movdqu xmm3, [rsp + 0x50]
+    code.emit({ 0x48, 0x83, 0xC4, 0x60 });                    // add rsp, 0x60
+    code.emit({ 0x41, 0x59, 0x41, 0x58, 0x5A, 0x59 });        // pop r9, r8, rdx, rcx
+    code.emit({ 0x48, 0x83, 0xC4, 0x08 });                    // add rsp, 8 (the saved slot)
+    code.emit({ 0xFF, 0xE0 });                                // jmp rax
+
+    code.bind(failLoad);
+    code.bind(failResolve);
+    code.emit({ 0xB9, DELAY_STUB_FAIL_CODE, 0x00, 0x00, 0x00 }); // mov ecx, FAST_FAIL_FATAL_APP_EXIT
+    code.emit({ 0xCD, 0x29 });                                // int 29h
+    return code.take();
+}
+
+std::vector<uint8_t> delay_stub::resolver32(uint32_t rva, const delay_stub_layout& layout)
+{
+    // entered from a thunk with the slot's offset into the IAT pushed, ecx and edx may carry fastcall/thiscall arguments
+    delay_stub_code code(rva);
+    code.emit({ 0x51, 0x52, 0x53 });                          // push ecx, edx, ebx
+    code.emit({ 0xE8, 0x00, 0x00, 0x00, 0x00 });              // call next
+    uint32_t anchor = code.here();
+    code.emit({ 0x5B });                                      // next: pop ebx, everything below is addressed relative to it
+    auto relative = [anchor](uint32_t target) { return target - anchor; };
+
+    code.emit({ 0x8B, 0x83 });                                // mov eax, [ebx + module handle]
+    code.emit_u32(relative(layout.moduleHandle));
+    code.emit({ 0x85, 0xC0 });                                // test eax, eax
+    delay_stub_jump haveModule = code.jump8(0x75);            // jnz have_module
+    code.emit({ 0x8D, 0x83 });                                // lea eax, [ebx + module name]
+    code.emit_u32(relative(layout.moduleName));
+    code.emit({ 0x50 });                                      // push eax
+    code.emit({ 0xFF, 0x93 });                                // call [ebx + LoadLibraryA]
+    code.emit_u32(relative(layout.loadLibrary));
+    code.emit({ 0x85, 0xC0 });                                // test eax, eax
+    delay_stub_jump failLoad = code.jump32(0x74);             // jz fail
+    code.emit({ 0x89, 0x83 });                                // mov [ebx + module handle], eax
+    code.emit_u32(relative(layout.moduleHandle));
+    code.bind(haveModule);
+
+    code.emit({ 0x8B, 0x54, 0x24, 0x0C });                    // mov edx, [esp + 12] (the slot offset)
+    code.emit({ 0x8B, 0x94, 0x13 });                          // mov edx, [ebx + edx + INT]
+    code.emit_u32(relative(layout.names));
+    code.emit({ 0x85, 0xD2 });                                // test edx, edx
+    delay_stub_jump byOrdinal = code.jump8(0x78);             // js by_ordinal
+    code.emit({ 0x8D, 0x94, 0x13 });                          // lea edx, [ebx + edx + image base + 2] (skip the hint)
+    code.emit_u32(relative(2));
+    delay_stub_jump resolve = code.jump8(0xEB);               // jmp resolve
+    code.bind(byOrdinal);
+    code.emit({ 0x0F, 0xB7, 0xD2 });                          // movzx edx, dx
+    code.bind(resolve);
+    code.emit({ 0x52, 0x50 });                                // push edx, push eax
+    code.emit({ 0xFF, 0x93 });                                // call [ebx + GetProcAddress]
+    code.emit_u32(relative(layout.getProcAddress));
+    code.emit({ 0x85, 0xC0 });                                // test eax, eax
+    delay_stub_jump failResolve = code.jump32(0x74);          // jz fail
+    code.emit({ 0x8B, 0x54, 0x24, 0x0C });                    // mov edx, [esp + 12]
+    code.emit({ 0x89, 0x84, 0x13 });                          // mov [ebx + edx + IAT], eax
+    code.emit_u32(relative(layout.iat));
+
+    code.emit({ 0x5B, 0x5A, 0x59 });                          // pop ebx, edx, ecx
+    code.emit({ 0x8D, 0x64, 0x24, 0x04 });                    // lea esp, [esp + 4] (the slot offset)
+    code.emit({ 0xFF, 0xE0 });                                // jmp eax
+
+    code.bind(failLoad);
+    code.bind(failResolve);
+    code.emit({ 0xB9, DELAY_STUB_FAIL_CODE, 0x00, 0x00, 0x00 }); // mov ecx, FAST_FAIL_FATAL_APP_EXIT
+    code.emit({ 0xCD, 0x29 });                                // int 29h
+    return code.take();
+}
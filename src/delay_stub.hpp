@@ -0,0 +1,36 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include <cstdint>
+#include <vector>
+
+// where the resolver of one delay-loaded module finds its data, all RVAs inside the patched image
+struct delay_stub_layout {
+    uint32_t moduleName = 0;
+    uint32_t moduleHandle = 0;
+    uint32_t iat = 0;
+    uint32_t names = 0;          // the delay INT, same layout as the IAT
+    uint32_t loadLibrary = 0;    // IAT slot of KERNEL32!LoadLibraryA
+    uint32_t getProcAddress = 0; // IAT slot of KERNEL32!GetProcAddress
+};
+
+// machine code for delay-load thunks that don't depend on the target linking delayimp.lib
+// every delay IAT slot starts out pointing at its thunk, the thunk hands the slot to the module's resolver,
+// which loads the DLL once, patches the slot with the real address and jumps there with the caller's arguments intact
+// the code is position independent (rip relative on x64, call/pop on x86), only the IAT slots need base relocations
+class delay_stub {
+public:
+    static constexpr uint32_t THUNK_SIZE64 = 12;
+    static constexpr uint32_t THUNK_SIZE32 = 10;
+
+    [[nodiscard]] static uint32_t thunk_size(bool pe32Plus) { return pe32Plus ? THUNK_SIZE64 : THUNK_SIZE32; }
+
+    // rva is where the returned bytes will be placed
+    [[nodiscard]] static std::vector<uint8_t> resolver(bool pe32Plus, uint32_t rva, const delay_stub_layout& layout);
+    [[nodiscard]] static std::vector<uint8_t> thunk(bool pe32Plus, uint32_t rva, uint32_t slotRva, uint32_t iatRva, uint32_t resolverRva);
+
+private:
+    [[nodiscard]] static std::vector<uint8_t> resolver64(uint32_t rva, const delay_stub_layout& layout);
+    [[nodiscard]] static std::vector<uint8_t> resolver32(uint32_t rva, const delay_stub_layout& layout);
+};
@@ -0,0 +1,232 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "dependency_resolver.hpp"
+#include "mapped_file.hpp"
+#include "pe_reader.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <iterator>
+
+// forwarders can chain (kernel32 -> kernelbase -> ntdll), a loop would never end without a cap
+constexpr uint32_t MAX_FORWARDER_HOPS = 8;
+
+bool dependency_resolver::resolve(const std::string& target)
+{
+    nodes.clear();
+    nodeIndexes.clear();
+    missingExports.clear();
+
+    dependency_module root;
+    root.name = std::filesystem::path(target).filename().string();
+    nodes.push_back(std::move(root));
+    nodeIndexes.emplace(util::to_lower(nodes.front().name), 0);
+    if (!load(nodes.front(), target)) return false;
+
+    searchOrder = search_order(target, pe32Plus);
+
+    // breadth first, modules found along the way are appended and visited in turn, so depth is the shortest chain
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        for (size_t j = 0; j < nodes[i].imports.size(); ++j)
+        {
+            // copied, find_or_add can grow the node list under us
+            dependency_import import = nodes[i].imports[j];
+            size_t dependency = find_or_add(import.module, i);
+            if (nodes[dependency].path.empty() || nodes[dependency].apiSet) continue;
+            if (!exports_function(dependency, import.function, 0))
+            {
+                missingExports.push_back({ dependency, i, import.function });
+            }
+        }
+    }
+    return true;
+}
+
+size_t dependency_resolver::missing_module_count() const
+{
+    return static_cast<size_t>(std::ranges::count_if(nodes, [](const dependency_module& module) { return module.path.empty() && !module.apiSet; }));
+}
+
+std::string dependency_resolver::find_module(const std::string& target, const std::string& module, bool pe32Plus)
+{
+    std::string key = util::to_lower(module);
+    std::string lookup = key.contains('.') ? key : key + ".dll";
+    for (const auto& directory : search_order(target, pe32Plus))
+    {
+        auto found = directory_listing(directory).find(lookup);
+        if (found == directory_listing(directory).end()) continue;
+        mapped_file image;
+        if (!image.open(found->second)) continue;
+        pe_reader reader(image.bytes());
+        if (reader.parse() && reader.is_pe32_plus() == pe32Plus) return found->second;
+    }
+    return {};
+}
+
+bool dependency_resolver::is_api_set(std::string_view module)
+{
+    std::string name = util::to_lower(module);
+    return name.starts_with("api-ms-") || name.starts_with("ext-ms-");
+}
+
+std::vector<std::string> dependency_resolver::search_order(const std::string& target, bool pe32Plus) const
+{
+    std::vector<std::string> directories;
+    std::string targetDirectory = std::filesystem::path(target).parent_path().string();
+    directories.push_back(targetDirectory.empty() ? "." : targetDirectory);
+    directories.insert(directories.end(), searchPaths.begin(), searchPaths.end());
+    std::ranges::move(system_directories(pe32Plus), std::back_inserter(directories));
+    return directories;
+}
+
+std::vector<std::string> dependency_resolver::system_directories(bool pe32Plus)
+{
+    std::vector<std::string> directories;
+#ifdef _WIN32
+    char buffer[MAX_PATH];
+    // a 32-bit image on 64-bit windows loads its system DLLs from SysWOW64, the call fails on 32-bit windows
+    UINT length = pe32Plus ? 0 : GetSystemWow64DirectoryA(buffer, MAX_PATH);
+    if (length == 0 || length >= MAX_PATH) length = GetSystemDirectoryA(buffer, MAX_PATH);
+    if (length != 0 && length < MAX_PATH) directories.emplace_back(buffer, length);
+
+    length = GetWindowsDirectoryA(buffer, MAX_PATH);
+    if (length != 0 && length < MAX_PATH)
+    {
+        std::string windows(buffer, length);
+        directories.push_back((std::filesystem::path(windows) / "System").string());
+        directories.push_back(windows);
+    }
+#else
+    (void)pe32Plus;
+#endif
+    return directories;
+}
+
+bool dependency_resolver::load(dependency_module& module, const std::string& path)
+{
+    mapped_file image;
+    if (!image.open(path))
+    {
+        lastError = image.error();
+        return false;
+    }
+    pe_reader reader(image.bytes());
+    if (!reader.parse())
+    {
+        lastError = reader.error();
+        return false;
+    }
+    if (&module == &nodes.front())
+    {
+        pe32Plus = reader.is_pe32_plus();
+    } else if (reader.is_pe32_plus() != pe32Plus)
+    {
+        // the loader skips DLLs of the wrong bitness and keeps searching, so does this
+        lastError = "wrong bitness";
+        return false;
+    }
+
+    // everything is copied out, the mapping is gone once this returns
+    for (const auto& import : reader.imports())
+    {
+        module.imports.push_back({ std::string(import.module), import.isOrdinal ? "#" + std::to_string(import.ordinal) : std::string(import.function) });
+    }
+    for (const auto& entry : reader.exports())
+    {
+        if (!entry.name.empty()) module.namedExports.emplace_back(std::string(entry.name), std::string(entry.forwarder));
+        module.ordinalExports.emplace_back(entry.ordinal, std::string(entry.forwarder));
+    }
+    std::ranges::sort(module.namedExports);
+    std::ranges::sort(module.ordinalExports);
+    module.path = path;
+    return true;
+}
+
+size_t dependency_resolver::find_or_add(const std::string& name, size_t importer)
+{
+    std::string key = util::to_lower(name);
+    auto it = nodeIndexes.find(key);
+    if (it != nodeIndexes.end())
+    {
+        // imports of one module are grouped, checking the last importer is enough to keep the list unique
+        std::vector<size_t>& importedBy = nodes[it->second].importedBy;
+        if (it->second != importer && (importedBy.empty() || importedBy.back() != importer)) importedBy.push_back(importer);
+        return it->second;
+    }
+
+    dependency_module module;
+    module.name = name;
+    module.depth = nodes[importer].depth + 1;
+    module.importedBy.push_back(importer);
+    if (is_api_set(name))
+    {
+        module.apiSet = true;
+    } else
+    {
+        std::string lookup = key.contains('.') ? key : key + ".dll";
+        for (const auto& directory : searchOrder)
+        {
+            auto found = directory_listing(directory).find(lookup);
+            if (found != directory_listing(directory).end() && load(module, found->second)) break;
+            // a failed load may have filled in part of the tables
+            module.imports.clear();
+            module.namedExports.clear();
+            module.ordinalExports.clear();
+        }
+    }
+
+    nodes.push_back(std::move(module));
+    nodeIndexes.emplace(std::move(key), nodes.size() - 1);
+    return nodes.size() - 1;
+}
+
+bool dependency_resolver::exports_function(size_t moduleIndex, const std::string& function, uint32_t hops)
+{
+    const std::string* forwarder = nullptr;
+    if (function.starts_with('#'))
+    {
+        uint16_t ordinal = 0;
+        auto [end, ec] = std::from_chars(function.data() + 1, function.data() + function.size(), ordinal);
+        if (ec != std::errc()) return false;
+        const auto& exports = nodes[moduleIndex].ordinalExports;
+        auto it = std::ranges::lower_bound(exports, ordinal, {}, &std::pair<uint16_t, std::string>::first);
+        if (it == exports.end() || it->first != ordinal) return false;
+        forwarder = &it->second;
+    } else
+    {
+        const auto& exports = nodes[moduleIndex].namedExports;
+        auto it = std::ranges::lower_bound(exports, function, {}, &std::pair<std::string, std::string>::first);
+        if (it == exports.end() || it->first != function) return false;
+        forwarder = &it->second;
+    }
+    if (forwarder->empty()) return true;
+    if (hops >= MAX_FORWARDER_HOPS) return false;
+
+    // "OTHER.Function" or "OTHER.#12", the module part has no extension
+    std::string target = *forwarder;
+    size_t dot = target.rfind('.');
+    if (dot == std::string::npos) return false;
+    std::string forwardedFunction = target.substr(dot + 1);
+    size_t forwardedModule = find_or_add(target.substr(0, dot) + ".dll", moduleIndex);
+    const dependency_module& module = nodes[forwardedModule];
+    if (module.apiSet) return true;
+    return !module.path.empty() && exports_function(forwardedModule, forwardedFunction, hops + 1);
+}
+
+const std::unordered_map<std::string, std::string>& dependency_resolver::directory_listing(const std::string& directory)
+{
+    auto it = listings.find(directory);
+    if (it != listings.end()) return it->second;
+
+    std::unordered_map<std::string, std::string> files;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator entry(directory, std::filesystem::directory_options::skip_permission_denied, ec), end; !ec && entry != end; entry.increment(ec))
+    {
+        files.emplace(util::to_lower(entry->path().filename().string()), entry->path().string());
+    }
+    return listings.emplace(directory, std::move(files)).first->second;
+}
@@ -0,0 +1,76 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct dependency_import {
+    std::string module;
+    std::string function; // "#123" for imports by ordinal
+};
+
+// one module of the graph, read once no matter how many others import it
+struct dependency_module {
+    std::string name;             // as the first importer spelled it, the target's file name for the root
+    std::string path;             // empty when it wasn't found on the search path
+    bool apiSet = false;          // api-ms-*/ext-ms-* contracts are resolved by the loader's schema, not from disk
+    uint32_t depth = 0;           // shortest import chain from the target
+    std::vector<dependency_import> imports;
+    std::vector<size_t> importedBy;
+
+    // sorted so checking an import is a binary search, forwarders are kept as "OTHER.Function"
+    std::vector<std::pair<std::string, std::string>> namedExports;
+    std::vector<std::pair<uint16_t, std::string>> ordinalExports;
+};
+
+struct missing_export {
+    size_t module;   // index of the module that should export it
+    size_t importer; // index of the module importing it
+    std::string function;
+};
+
+// resolves the transitive import graph of an image against a search path
+// modules are looked up like the loader does for a desktop app: the target's own directory, the given
+// directories, then the system directories, skipping images built for the other bitness
+class dependency_resolver {
+public:
+    explicit dependency_resolver(std::vector<std::string> searchPaths) : searchPaths(std::move(searchPaths)) {}
+
+    [[nodiscard]] bool resolve(const std::string& target);
+
+    [[nodiscard]] const std::string& error() const { return lastError; }
+    // the target is always the first module
+    [[nodiscard]] const std::vector<dependency_module>& modules() const { return nodes; }
+    [[nodiscard]] const std::vector<missing_export>& missing_exports() const { return missingExports; }
+    [[nodiscard]] size_t missing_module_count() const;
+
+    // the file the loader would pick for one module imported by target, skipping other bitness, empty when there's none
+    // for callers that only need the first level, listings are shared with resolve()
+    [[nodiscard]] std::string find_module(const std::string& target, const std::string& module, bool pe32Plus);
+
+    [[nodiscard]] static bool is_api_set(std::string_view module);
+    // the directories searched after the ones given, for an image of the given bitness
+    [[nodiscard]] static std::vector<std::string> system_directories(bool pe32Plus);
+
+private:
+    [[nodiscard]] std::vector<std::string> search_order(const std::string& target, bool pe32Plus) const;
+    [[nodiscard]] bool load(dependency_module& module, const std::string& path);
+    [[nodiscard]] size_t find_or_add(const std::string& name, size_t importer);
+    [[nodiscard]] bool exports_function(size_t moduleIndex, const std::string& function, uint32_t hops);
+    [[nodiscard]] const std::unordered_map<std::string, std::string>& directory_listing(const std::string& directory);
+
+    std::vector<std::string> searchPaths;
+    std::vector<std::string> searchOrder; // target directory, searchPaths, system directories
+    std::string lastError;
+    bool pe32Plus = false;
+
+    std::vector<dependency_module> nodes;
+    std::unordered_map<std::string, size_t> nodeIndexes; // lower-cased module name
+    std::vector<missing_export> missingExports;
+    // lower-cased file name -> path for every searched directory, one listing per directory and run
+    // also gives the case-insensitive lookup the loader does on file systems that don't have it
+    std::unordered_map<std::string, std::unordered_map<std::string, std::string>> listings;
+};
@@ -0,0 +1,269 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "export_cache.hpp"
+#include "hash.hpp"
+#include "pe_reader.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+struct export_cache_header {
+    char magic[4];
+    uint32_t version;
+    uint64_t fileSize;
+    int64_t modifiedTime;
+    uint64_t contentHash;
+    uint32_t count;
+    uint32_t pathLength;
+    uint32_t stringsSize;
+    uint32_t reserved;
+};
+
+struct export_cache_record {
+    uint32_t nameOffset;
+    uint16_t nameLength;
+    uint16_t ordinal;
+    uint32_t hint;
+};
+
+static_assert(sizeof(export_cache_header) == 48);
+static_assert(sizeof(export_cache_record) == 12);
+
+constexpr char EXPORT_CACHE_MAGIC[4] = { 'S', 'I', 'E', 'X' };
+constexpr uint32_t EXPORT_CACHE_VERSION = 2;
+
+bool export_table::assign(std::vector<uint8_t> data)
+{
+    file.close();
+    owned = std::move(data);
+    bytes = owned;
+    return validate();
+}
+
+bool export_table::assign(mapped_file mapped)
+{
+    owned.clear();
+    file = std::move(mapped);
+    bytes = file.bytes();
+    return validate();
+}
+
+void export_table::reset()
+{
+    file.close();
+    owned.clear();
+    bytes = {};
+    count = 0;
+}
+
+bool export_table::validate()
+{
+    count = 0;
+    if (bytes.size() < sizeof(export_cache_header)) return false;
+    export_cache_header header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, EXPORT_CACHE_MAGIC, 4) != 0 || header.version != EXPORT_CACHE_VERSION) return false;
+
+    recordsOffset = pe::align_up(sizeof(header) + header.pathLength, 4);
+    stringsOffset = recordsOffset + static_cast<uint64_t>(header.count) * sizeof(export_cache_record);
+    if (stringsOffset + header.stringsSize != bytes.size()) return false;
+
+    count = header.count;
+    return true;
+}
+
+std::optional<export_symbol> export_table::find(std::string_view name) const
+{
+    size_t low = 0;
+    size_t high = count;
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        export_symbol symbol = at(middle);
+        int order = symbol.name.compare(name);
+        if (order == 0) return symbol;
+        if (order < 0) low = middle + 1;
+        else high = middle;
+    }
+    return std::nullopt;
+}
+
+std::optional<export_symbol> export_table::find(uint16_t ordinal) const
+{
+    // ordinal adds are rare, a scan beats keeping a second sorted index in every cache file
+    for (size_t i = 0; i < count; ++i)
+    {
+        export_symbol symbol = at(i);
+        if (symbol.ordinal == ordinal) return symbol;
+    }
+    return std::nullopt;
+}
+
+export_symbol export_table::at(size_t index) const
+{
+    export_cache_record record;
+    std::memcpy(&record, bytes.data() + recordsOffset + index * sizeof(record), sizeof(record));
+    export_symbol symbol;
+    uint64_t stringsSize = bytes.size() - stringsOffset;
+    if (static_cast<uint64_t>(record.nameOffset) + record.nameLength <= stringsSize)
+    {
+        symbol.name = { reinterpret_cast<const char*>(bytes.data() + stringsOffset + record.nameOffset), record.nameLength };
+    }
+    symbol.ordinal = record.ordinal;
+    symbol.hint = record.hint;
+    return symbol;
+}
+
+bool export_table::matches(const std::string& path, const dll_fingerprint& fingerprint) const
+{
+    if (bytes.size() < sizeof(export_cache_header)) return false;
+    export_cache_header header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (header.fileSize != fingerprint.size || header.modifiedTime != fingerprint.modifiedTime || header.contentHash != fingerprint.contentHash) return false;
+    if (header.pathLength != path.size() || sizeof(header) + header.pathLength > bytes.size()) return false;
+    return std::memcmp(bytes.data() + sizeof(header), path.data(), path.size()) == 0;
+}
+
+std::vector<uint8_t> export_table::serialize(const std::string& path, const dll_fingerprint& fingerprint, std::vector<export_symbol> symbols)
+{
+    std::ranges::sort(symbols, {}, &export_symbol::name);
+
+    export_cache_header header {};
+    std::memcpy(header.magic, EXPORT_CACHE_MAGIC, 4);
+    header.version = EXPORT_CACHE_VERSION;
+    header.fileSize = fingerprint.size;
+    header.modifiedTime = fingerprint.modifiedTime;
+    header.contentHash = fingerprint.contentHash;
+    header.count = static_cast<uint32_t>(symbols.size());
+    header.pathLength = static_cast<uint32_t>(path.size());
+
+    std::vector<uint8_t> strings;
+    std::vector<export_cache_record> records;
+    records.reserve(symbols.size());
+    for (const auto& symbol : symbols)
+    {
+        records.push_back({ static_cast<uint32_t>(strings.size()), static_cast<uint16_t>(symbol.name.size()), symbol.ordinal, symbol.hint });
+        strings.insert(strings.end(), symbol.name.begin(), symbol.name.end());
+    }
+    header.stringsSize = static_cast<uint32_t>(strings.size());
+
+    std::vector<uint8_t> data(sizeof(header));
+    std::memcpy(data.data(), &header, sizeof(header));
+    data.insert(data.end(), path.begin(), path.end());
+    data.resize(pe::align_up(data.size(), 4), 0);
+    size_t recordBytes = records.size() * sizeof(export_cache_record);
+    data.resize(data.size() + recordBytes);
+    if (recordBytes != 0) std::memcpy(data.data() + data.size() - recordBytes, records.data(), recordBytes);
+    data.insert(data.end(), strings.begin(), strings.end());
+    return data;
+}
+
+std::string export_cache::default_directory()
+{
+    return util::cache_directory("exports");
+}
+
+bool export_cache::fingerprint(const std::string& path, dll_fingerprint& result)
+{
+    std::error_code ec;
+    result.size = std::filesystem::file_size(path, ec);
+    if (ec) return false;
+    result.modifiedTime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    if (ec) return false;
+
+    // the headers carry the link timestamp, checksum and section layout, that's enough to tell two builds apart
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    char headers[4096];
+    file.read(headers, sizeof(headers));
+    result.contentHash = hash::fnv1a(headers, static_cast<size_t>(file.gcount()));
+    return true;
+}
+
+bool export_cache::load(const std::string& dllPath, export_table& table)
+{
+    std::error_code ec;
+    std::string canonicalPath = std::filesystem::weakly_canonical(dllPath, ec).string();
+    if (ec) canonicalPath = std::filesystem::absolute(dllPath).string();
+
+    dll_fingerprint current;
+    if (!fingerprint(dllPath, current))
+    {
+        lastError = "failed to read the DLL";
+        return false;
+    }
+
+    std::string entryPath = directory.empty() ? "" : entry_path(canonicalPath);
+    if (!entryPath.empty())
+    {
+        mapped_file cached;
+        if (cached.open(entryPath) && table.assign(std::move(cached)) && table.matches(canonicalPath, current))
+        {
+            return true;
+        }
+        // stale or corrupt, let go of the mapping so the entry can be replaced
+        table.reset();
+    }
+
+    std::vector<std::string> names;
+    std::vector<export_symbol> symbols;
+    if (!collect_exports(dllPath, names, symbols)) return false;
+    std::vector<uint8_t> data = export_table::serialize(canonicalPath, current, std::move(symbols));
+
+    if (!entryPath.empty())
+    {
+        // a failed write only costs the next run a rebuild
+        std::filesystem::create_directories(directory, ec);
+        std::string ignored;
+        (void)util::replace_file(entryPath, data, ignored);
+    }
+
+    if (!table.assign(std::move(data)))
+    {
+        lastError = "failed to build the export table";
+        return false;
+    }
+    return true;
+}
+
+bool export_cache::collect_exports(const std::string& dllPath, std::vector<std::string>& names, std::vector<export_symbol>& symbols)
+{
+    // only the export directory is needed, map the DLL and walk it instead of running the full LIEF parse
+    mapped_file dll;
+    if (!dll.open(dllPath))
+    {
+        lastError = dll.error();
+        return false;
+    }
+    pe_reader reader(dll.bytes());
+    if (!reader.parse())
+    {
+        lastError = "failed to parse the DLL: " + reader.error();
+        return false;
+    }
+
+    std::vector<pe_export> exports = reader.exports();
+    names.reserve(exports.size());
+    symbols.reserve(exports.size());
+    for (const auto& entry : exports)
+    {
+        // names are copied out because the mapping goes away before the table is serialized
+        // the hint is the name pointer table index, exactly what the loader tries first
+        // exports without a name are kept too, "dll::#7" is checked against their ordinals
+        names.emplace_back(entry.name);
+        symbols.push_back({ names.back(), entry.ordinal, entry.hint });
+    }
+    return true;
+}
+
+std::string export_cache::entry_path(const std::string& canonicalPath) const
+{
+    std::string key = canonicalPath;
+#ifdef _WIN32
+    key = util::to_lower(key);
+#endif
+    return (std::filesystem::path(directory) / (hash::to_hex(hash::fnv1a(key)) + ".sxc")).string();
+}
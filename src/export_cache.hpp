@@ -0,0 +1,70 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include "mapped_file.hpp"
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+struct export_symbol {
+    std::string_view name; // points into the table it came from, empty for exports by ordinal only
+    uint16_t ordinal = 0;
+    uint32_t hint = 0;     // index into the DLL's export name pointer table
+};
+
+struct dll_fingerprint {
+    uint64_t size = 0;
+    int64_t modifiedTime = 0;
+    uint64_t contentHash = 0; // fnv-1a over the PE headers, catches rebuilt DLLs that kept size and mtime
+};
+
+// export table in the on-disk cache format, sorted by name with the ordinal-only exports (empty names) first
+// the same bytes are used whether they were just built or mapped from a cache file
+class export_table {
+public:
+    [[nodiscard]] bool assign(std::vector<uint8_t> data);
+    [[nodiscard]] bool assign(mapped_file file);
+    void reset();
+
+    [[nodiscard]] std::optional<export_symbol> find(std::string_view name) const;
+    // any export, named or not, by its biased ordinal
+    [[nodiscard]] std::optional<export_symbol> find(uint16_t ordinal) const;
+    [[nodiscard]] export_symbol at(size_t index) const;
+    [[nodiscard]] size_t size() const { return count; }
+    [[nodiscard]] bool matches(const std::string& path, const dll_fingerprint& fingerprint) const;
+
+    [[nodiscard]] static std::vector<uint8_t> serialize(const std::string& path, const dll_fingerprint& fingerprint, std::vector<export_symbol> symbols);
+
+private:
+    [[nodiscard]] bool validate();
+
+    mapped_file file;
+    std::vector<uint8_t> owned;
+    std::span<const uint8_t> bytes;
+    uint32_t count = 0;
+    uint64_t recordsOffset = 0;
+    uint64_t stringsOffset = 0;
+};
+
+// persistent export tables keyed by DLL path, one small mmap-able file per DLL
+// entries are checked against size, mtime and a header hash of the DLL and rebuilt when any of them changed
+class export_cache {
+public:
+    // an empty directory keeps everything in memory
+    explicit export_cache(std::string directory) : directory(std::move(directory)) {}
+
+    [[nodiscard]] static std::string default_directory();
+    [[nodiscard]] static bool fingerprint(const std::string& path, dll_fingerprint& result);
+
+    [[nodiscard]] bool load(const std::string& dllPath, export_table& table);
+    [[nodiscard]] const std::string& error() const { return lastError; }
+
+private:
+    [[nodiscard]] bool collect_exports(const std::string& dllPath, std::vector<std::string>& names, std::vector<export_symbol>& symbols);
+    [[nodiscard]] std::string entry_path(const std::string& canonicalPath) const;
+
+    std::string directory;
+    std::string lastError;
+};
@@ -0,0 +1,97 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+class hash {
+public:
+    static constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+    static constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+    // fnv-1a, good enough for short keys and header fingerprints, pass the previous result to chain calls
+    static uint64_t fnv1a(const void* data, size_t size, uint64_t seed = FNV_OFFSET)
+    {
+        auto bytes = static_cast<const uint8_t*>(data);
+        uint64_t value = seed;
+        for (size_t i = 0; i < size; ++i)
+        {
+            value ^= bytes[i];
+            value *= FNV_PRIME;
+        }
+        return value;
+    }
+
+    static uint64_t fnv1a(std::string_view text, uint64_t seed = FNV_OFFSET)
+    {
+        return fnv1a(text.data(), text.size(), seed);
+    }
+
+    // xxh64, for whole files where fnv-1a's byte at a time loop would dominate
+    static uint64_t xxh64(const void* data, size_t size, uint64_t seed = 0)
+    {
+        auto bytes = static_cast<const uint8_t*>(data);
+        const uint8_t* end = bytes + size;
+        uint64_t value;
+        if (size >= 32)
+        {
+            uint64_t lanes[4] = { seed + XXH_PRIME1 + XXH_PRIME2, seed + XXH_PRIME2, seed, seed - XXH_PRIME1 };
+            for (; bytes + 32 <= end; bytes += 32)
+            {
+                for (int i = 0; i < 4; ++i) lanes[i] = xxh_round(lanes[i], read64(bytes + i * 8));
+            }
+            value = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+            for (uint64_t lane : lanes) value = (value ^ xxh_round(0, lane)) * XXH_PRIME1 + XXH_PRIME4;
+        } else
+        {
+            value = seed + XXH_PRIME5;
+        }
+        value += size;
+
+        for (; bytes + 8 <= end; bytes += 8) value = rotl(value ^ xxh_round(0, read64(bytes)), 27) * XXH_PRIME1 + XXH_PRIME4;
+        if (bytes + 4 <= end)
+        {
+            uint32_t word;
+            std::memcpy(&word, bytes, sizeof(word));
+            value = rotl(value ^ (word * XXH_PRIME1), 23) * XXH_PRIME2 + XXH_PRIME3;
+            bytes += 4;
+        }
+        for (; bytes < end; ++bytes) value = rotl(value ^ (*bytes * XXH_PRIME5), 11) * XXH_PRIME1;
+
+        value ^= value >> 33;
+        value *= XXH_PRIME2;
+        value ^= value >> 29;
+        value *= XXH_PRIME3;
+        value ^= value >> 32;
+        return value;
+    }
+
+    // fixed width lowercase hex, used to name cache entries after their key
+    static std::string to_hex(uint64_t value)
+    {
+        std::string text(16, '0');
+        for (int i = 15; i >= 0; --i, value >>= 4) text[static_cast<size_t>(i)] = "0123456789abcdef"[value & 0xF];
+        return text;
+    }
+
+private:
+    static constexpr uint64_t XXH_PRIME1 = 0x9E3779B185EBCA87ull;
+    static constexpr uint64_t XXH_PRIME2 = 0xC2B2AE3D27D4EB4Full;
+    static constexpr uint64_t XXH_PRIME3 = 0x165667B19E3779F9ull;
+    static constexpr uint64_t XXH_PRIME4 = 0x85EBCA77C2B2AE63ull;
+    static constexpr uint64_t XXH_PRIME5 = 0x27D4EB2F165667C5ull;
+
+    static uint64_t rotl(uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+    static uint64_t xxh_round(uint64_t accumulator, uint64_t input) { return rotl(accumulator + input * XXH_PRIME2, 31) * XXH_PRIME1; }
+
+    static uint64_t read64(const uint8_t* bytes)
+    {
+        uint64_t value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+};
@@ -0,0 +1,110 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "image_diff.hpp"
+#include "util.hpp"
+
+bool diff_image::open(const std::string& path)
+{
+    list.clear();
+    if (!file.open(path)) return fail(file.error());
+
+    pe_reader reader(file.bytes());
+    if (!reader.parse()) return fail(reader.error());
+
+    auto add_imports = [this](const std::vector<pe_import>& imports, diff_table table) {
+        for (const auto& entry : imports)
+        {
+            list.push_back({ table, entry.isOrdinal, entry.isOrdinal ? entry.ordinal : uint16_t(0), entry.isOrdinal ? 0u : entry.hint, entry.slotRva,
+                entry.module, entry.isOrdinal ? std::string_view() : entry.function, {} });
+        }
+    };
+    std::vector<pe_import> imports = reader.imports();
+    std::vector<pe_import> delayImports = reader.delay_imports();
+    std::vector<pe_export> exports = reader.exports();
+    list.reserve(imports.size() + delayImports.size() + exports.size());
+    add_imports(imports, diff_table::imports);
+    add_imports(delayImports, diff_table::delay_imports);
+    for (const auto& entry : exports)
+    {
+        list.push_back({ diff_table::exports, entry.name.empty(), entry.ordinal, entry.name.empty() ? 0u : entry.hint, entry.rva, {}, entry.name, entry.forwarder });
+    }
+
+    std::ranges::sort(list, [](const diff_entry& a, const diff_entry& b) {
+        int order = compare_keys(a, b);
+        return order != 0 ? order < 0 : a.rva < b.rva;
+    });
+    return true;
+}
+
+std::vector<diff_change> diff_image::compare(const diff_image& baseline, const diff_image& candidate)
+{
+    std::vector<diff_change> changes;
+    const std::vector<diff_entry>& before = baseline.list;
+    const std::vector<diff_entry>& after = candidate.list;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < before.size() || j < after.size())
+    {
+        int order = i == before.size() ? 1 : j == after.size() ? -1 : compare_keys(before[i], after[j]);
+        if (order < 0)
+        {
+            changes.push_back({ diff_change_type::removed, &before[i++], nullptr });
+        } else if (order > 0)
+        {
+            changes.push_back({ diff_change_type::added, nullptr, &after[j++] });
+        } else
+        {
+            const diff_entry& a = before[i++];
+            const diff_entry& b = after[j++];
+            // the key already covers the module, the name and the ordinal of anything by ordinal
+            if (a.ordinal != b.ordinal || a.hint != b.hint || a.rva != b.rva || a.forwarder != b.forwarder)
+            {
+                changes.push_back({ diff_change_type::changed, &a, &b });
+            }
+        }
+    }
+    return changes;
+}
+
+std::string_view diff_image::table_name(diff_table table)
+{
+    switch (table)
+    {
+    case diff_table::imports: return "import";
+    case diff_table::delay_imports: return "delay-import";
+    case diff_table::exports: return "export";
+    }
+    return "";
+}
+
+std::string_view diff_image::change_name(diff_change_type type)
+{
+    switch (type)
+    {
+    case diff_change_type::added: return "added";
+    case diff_change_type::removed: return "removed";
+    case diff_change_type::changed: return "changed";
+    }
+    return "";
+}
+
+bool diff_image::fail(const std::string& message)
+{
+    lastError = message;
+    return false;
+}
+
+int diff_image::compare_keys(const diff_entry& a, const diff_entry& b)
+{
+    if (a.table != b.table) return a.table < b.table ? -1 : 1;
+
+    if (int order = util::compare_ignore_case(a.module, b.module); order != 0) return order;
+
+    // named entries before ordinal-only ones, names are exact like GetProcAddress
+    if (a.byOrdinal != b.byOrdinal) return a.byOrdinal ? 1 : -1;
+    if (a.byOrdinal) return a.ordinal == b.ordinal ? 0 : a.ordinal < b.ordinal ? -1 : 1;
+    int order = a.function.compare(b.function);
+    return order == 0 ? 0 : order < 0 ? -1 : 1;
+}
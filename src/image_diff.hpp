@@ -0,0 +1,75 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include "mapped_file.hpp"
+#include "pe_reader.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class diff_table : uint8_t {
+    imports,
+    delay_imports,
+    exports,
+};
+
+// one import or export flattened for the join, the views point into the image's mapping
+struct diff_entry {
+    diff_table table = diff_table::imports;
+    bool byOrdinal = false;
+    uint16_t ordinal = 0;       // imports by ordinal and every export
+    uint32_t hint = 0;          // named imports and exports
+    uint32_t rva = 0;           // the IAT slot of an import, what an export points at
+    std::string_view module;    // empty for exports
+    std::string_view function;  // empty for anything by ordinal
+    std::string_view forwarder; // "OTHER.Function" for forwarded exports
+};
+
+enum class diff_change_type : uint8_t {
+    added,
+    removed,
+    changed,
+};
+
+struct diff_change {
+    diff_change_type type = diff_change_type::changed;
+    const diff_entry* before = nullptr; // nullptr for added
+    const diff_entry* after = nullptr;  // nullptr for removed
+};
+
+// the import, delay import and export directories of one image, read straight from a mapping and kept sorted
+// entries are keyed by table, module (case-insensitive, like the loader), then function name or ordinal
+class diff_image {
+public:
+    [[nodiscard]] bool open(const std::string& path);
+
+    [[nodiscard]] const std::vector<diff_entry>& entries() const { return list; }
+    [[nodiscard]] const std::string& error() const { return lastError; }
+
+    // one merge pass over both sorted lists, duplicate keys pair up in slot order
+    // a pair is changed when its hint, ordinal, rva or forwarder differ, a slot move is a changed rva
+    // the changes point into both images, they stay valid as long as the images do
+    [[nodiscard]] static std::vector<diff_change> compare(const diff_image& baseline, const diff_image& candidate);
+
+    [[nodiscard]] static std::string_view table_name(diff_table table);
+    [[nodiscard]] static std::string_view change_name(diff_change_type type);
+
+private:
+    [[nodiscard]] bool fail(const std::string& message);
+    // -1, 0 or 1 over the key alone, the slot order only breaks ties for sorting
+    [[nodiscard]] static int compare_keys(const diff_entry& a, const diff_entry& b);
+
+    mapped_file file;
+    std::vector<diff_entry> list;
+    std::string lastError;
+};
+
+// a candidate with its changes against the baseline, kept together since the changes point into its mapping
+struct diff_outcome {
+    std::string path;
+    diff_image image;
+    bool readable = false;
+    std::vector<diff_change> changes;
+};
@@ -0,0 +1,295 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "import_binder.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <charconv>
+
+// same cap as the dependency walk, kernel32 -> kernelbase -> ntdll is the usual depth
+constexpr uint32_t MAX_BIND_FORWARDER_HOPS = 8;
+
+bool import_binder::bind(bool ignoreNoBind)
+{
+    filePatches.clear();
+    skippedDescriptors.clear();
+    relocatableModules.clear();
+    descriptorCount = 0;
+    boundCount = 0;
+    slotCount = 0;
+
+    if (!reader.parse()) return fail(reader.error());
+    if (reader.directory_count() <= pe::DIRECTORY_BOUND_IMPORT) return fail("image has no bound import directory entry");
+    auto characteristics = pe::read<uint16_t>(image.data() + reader.optional_header_offset() + pe::OPTIONAL_DLL_CHARACTERISTICS);
+    if ((characteristics & pe::DLLCHARACTERISTICS_NO_BIND) != 0 && !ignoreNoBind) return fail("the image is marked as not bindable (/ALLOWBIND:NO)");
+
+    pe::data_directory importDirectory = reader.directory(pe::DIRECTORY_IMPORT);
+    if (importDirectory.VirtualAddress == 0) return fail("image has no imports");
+    int64_t tableOffset = reader.offset_from_rva(importDirectory.VirtualAddress);
+    if (tableOffset < 0) return fail("import directory isn't backed by file data");
+
+    uint32_t width = reader.slot_width();
+    auto read_slot = [this, width](uint64_t offset) { return width == 8 ? pe::read<uint64_t>(image.data() + offset) : pe::read<uint32_t>(image.data() + offset); };
+    auto slot_bytes = [width](const std::vector<uint64_t>& values) {
+        std::vector<uint8_t> bytes(values.size() * width);
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            if (width == 8) pe::write<uint64_t>(bytes.data() + i * width, values[i]);
+            else pe::write<uint32_t>(bytes.data() + i * width, static_cast<uint32_t>(values[i]));
+        }
+        return bytes;
+    };
+
+    std::vector<bound_module> boundModules;
+    for (uint64_t offset = tableOffset; offset + sizeof(pe::import_descriptor) <= image.size(); offset += sizeof(pe::import_descriptor))
+    {
+        auto descriptor = pe::read<pe::import_descriptor>(image.data() + offset);
+        if (descriptor.Name == 0 && descriptor.FirstThunk == 0 && descriptor.OriginalFirstThunk == 0) break;
+        ++descriptorCount;
+        std::string module(reader.string_at(descriptor.Name));
+        uint64_t timeDateStampOffset = offset + offsetof(pe::import_descriptor, TimeDateStamp);
+
+        // the lookup table keeps the names, the IAT gets overwritten with addresses
+        std::string reason;
+        std::vector<uint64_t> thunks;
+        int64_t iatOffset = reader.offset_from_rva(descriptor.FirstThunk);
+        int64_t iltOffset = descriptor.OriginalFirstThunk != 0 ? reader.offset_from_rva(descriptor.OriginalFirstThunk) : -1;
+        if (descriptor.OriginalFirstThunk == 0) reason = "no import lookup table, binding would lose the function names";
+        else if (iatOffset < 0 || iltOffset < 0) reason = "thunks aren't backed by file data";
+        if (reason.empty())
+        {
+            for (uint64_t position = iltOffset; position + width <= image.size(); position += width)
+            {
+                uint64_t thunk = read_slot(position);
+                if (thunk == 0) break;
+                thunks.push_back(thunk);
+            }
+            if (static_cast<uint64_t>(iatOffset) + thunks.size() * width > image.size()) reason = "IAT isn't backed by file data";
+        }
+
+        const bound_dll* dll = nullptr;
+        if (reason.empty() && dependency_resolver::is_api_set(module)) reason = "API sets are resolved through the loader's schema";
+        else if (reason.empty() && !(dll = load_module(module))) reason = "not found on the search path";
+
+        std::vector<uint64_t> addresses;
+        std::vector<const bound_dll*> forwardedTo;
+        for (size_t i = 0; reason.empty() && i < thunks.size(); ++i)
+        {
+            bool byOrdinal = (thunks[i] & (reader.is_pe32_plus() ? pe::ORDINAL_FLAG64 : pe::ORDINAL_FLAG32)) != 0;
+            std::string function = byOrdinal ? "#" + std::to_string(thunks[i] & 0xFFFF) : std::string(reader.string_at(static_cast<uint32_t>(thunks[i]) + 2));
+            uint64_t address = 0;
+            if (resolve_export(*dll, function, 0, address, forwardedTo, reason)) addresses.push_back(address);
+        }
+
+        if (!reason.empty())
+        {
+            skippedDescriptors.push_back(module + ": " + reason);
+            // a stale bind would still be trusted if the DLL kept its timestamp, hand the descriptor back to the loader
+            if (descriptor.TimeDateStamp != 0 && !thunks.empty())
+            {
+                patch(iatOffset, slot_bytes(thunks));
+                patch_u32(timeDateStampOffset, 0);
+            }
+            continue;
+        }
+
+        patch(iatOffset, slot_bytes(addresses));
+        patch_u32(timeDateStampOffset, pe::BOUND_IMPORT_NEW_STYLE);
+        ++boundCount;
+        slotCount += addresses.size();
+
+        // a module imported through several descriptors gets one entry, its forwarder refs merged
+        auto it = std::ranges::find_if(boundModules, [&dll](const bound_module& bound) { return util::equals_ignore_case(bound.name, dll->name); });
+        if (it == boundModules.end()) it = boundModules.insert(boundModules.end(), { module, dll->timeDateStamp, {} });
+        for (const bound_dll* forwarded : forwardedTo)
+        {
+            if (forwarded != dll && std::ranges::find(it->forwardedTo, forwarded) == it->forwardedTo.end()) it->forwardedTo.push_back(forwarded);
+        }
+        for (const bound_dll* used : forwardedTo)
+        {
+            if (used->dynamicBase && std::ranges::find(relocatableModules, used->name) == relocatableModules.end()) relocatableModules.push_back(used->name);
+        }
+        if (dll->dynamicBase && std::ranges::find(relocatableModules, dll->name) == relocatableModules.end()) relocatableModules.push_back(dll->name);
+    }
+
+    if (boundModules.empty())
+    {
+        if (filePatches.empty()) return fail("none of the imports could be bound");
+        // everything went back to the loader, the old directory has nothing left to describe
+        patch_u32(reader.data_directory_offset() + pe::DIRECTORY_BOUND_IMPORT * sizeof(pe::data_directory), 0);
+        patch_u32(reader.data_directory_offset() + pe::DIRECTORY_BOUND_IMPORT * sizeof(pe::data_directory) + 4, 0);
+        return true;
+    }
+    return place_directory(build_directory(boundModules));
+}
+
+bool import_binder::write(const std::string& source, const std::string& destination)
+{
+    return import_patcher::write_patches(source, destination, image.size(), image.size(), filePatches, lastError);
+}
+
+uint64_t import_binder::patched_bytes() const
+{
+    uint64_t total = 0;
+    for (const auto& filePatch : filePatches) total += filePatch.bytes.size();
+    return total;
+}
+
+bool import_binder::fail(const std::string& message)
+{
+    lastError = message;
+    return false;
+}
+
+const import_binder::bound_dll* import_binder::load_module(const std::string& name)
+{
+    std::string key = util::to_lower(name);
+    auto it = loaded.find(key);
+    if (it != loaded.end()) return it->second.get();
+
+    auto dll = std::make_unique<bound_dll>();
+    dll->name = name;
+    std::string path = modules.find_module(target, name, reader.is_pe32_plus());
+    if (!path.empty() && dll->file.open(path))
+    {
+        dll->reader = pe_reader(dll->file.bytes());
+        if (dll->reader.parse())
+        {
+            dll->timeDateStamp = dll->reader.file_header().TimeDateStamp;
+            dll->imageBase = dll->reader.image_base();
+            auto characteristics = pe::read<uint16_t>(dll->file.bytes().data() + dll->reader.optional_header_offset() + pe::OPTIONAL_DLL_CHARACTERISTICS);
+            dll->dynamicBase = (characteristics & pe::DLLCHARACTERISTICS_DYNAMIC_BASE) != 0;
+        } else
+        {
+            dll.reset();
+        }
+    } else
+    {
+        dll.reset();
+    }
+    return loaded.emplace(std::move(key), std::move(dll)).first->second.get();
+}
+
+bool import_binder::resolve_export(const bound_dll& dll, const std::string& function, uint32_t hops, uint64_t& address,
+    std::vector<const bound_dll*>& forwardedTo, std::string& reason)
+{
+    std::optional<pe_export> found;
+    if (function.size() > 1 && function.front() == '#')
+    {
+        uint16_t ordinal = 0;
+        auto [end, ec] = std::from_chars(function.data() + 1, function.data() + function.size(), ordinal);
+        if (ec == std::errc()) found = dll.reader.find_export(ordinal);
+    } else
+    {
+        found = dll.reader.find_export(std::string_view(function));
+    }
+    if (!found)
+    {
+        reason = dll.name + " doesn't export " + function;
+        return false;
+    }
+    if (found->forwarder.empty())
+    {
+        address = dll.imageBase + found->rva;
+        return true;
+    }
+
+    // "OTHER.Function" or "OTHER.#12", the module part has no extension
+    std::string forwarder(found->forwarder);
+    size_t dot = forwarder.rfind('.');
+    if (dot == std::string::npos || hops >= MAX_BIND_FORWARDER_HOPS)
+    {
+        reason = "can't follow the forwarder of " + function + " (" + forwarder + ")";
+        return false;
+    }
+    std::string module = forwarder.substr(0, dot) + ".dll";
+    if (dependency_resolver::is_api_set(module))
+    {
+        reason = function + " forwards to the API set " + module;
+        return false;
+    }
+    const bound_dll* next = load_module(module);
+    if (!next)
+    {
+        reason = function + " forwards to " + module + ", which wasn't found";
+        return false;
+    }
+    if (std::ranges::find(forwardedTo, next) == forwardedTo.end()) forwardedTo.push_back(next);
+    return resolve_export(*next, forwarder.substr(dot + 1), hops + 1, address, forwardedTo, reason);
+}
+
+std::vector<uint8_t> import_binder::build_directory(const std::vector<bound_module>& boundModules) const
+{
+    // descriptors, each followed by its forwarder refs, a zero terminator, then the names they point at
+    size_t entries = 1;
+    for (const auto& module : boundModules) entries += 1 + module.forwardedTo.size();
+    std::vector<uint8_t> directory(entries * sizeof(pe::bound_import_descriptor), 0);
+
+    std::unordered_map<std::string, uint16_t> nameOffsets;
+    auto name_offset = [&directory, &nameOffsets](const std::string& name) {
+        auto it = nameOffsets.find(name);
+        if (it != nameOffsets.end()) return it->second;
+        auto offset = static_cast<uint16_t>(directory.size());
+        directory.insert(directory.end(), name.begin(), name.end());
+        directory.push_back(0);
+        nameOffsets.emplace(name, offset);
+        return offset;
+    };
+
+    size_t position = 0;
+    for (const auto& module : boundModules)
+    {
+        pe::bound_import_descriptor descriptor { module.timeDateStamp, name_offset(module.name), static_cast<uint16_t>(module.forwardedTo.size()) };
+        pe::write(directory.data() + position, descriptor);
+        position += sizeof(descriptor);
+        for (const bound_dll* forwarded : module.forwardedTo)
+        {
+            pe::bound_forwarder_ref ref { forwarded->timeDateStamp, name_offset(forwarded->name), 0 };
+            pe::write(directory.data() + position, ref);
+            position += sizeof(ref);
+        }
+    }
+    return directory;
+}
+
+bool import_binder::place_directory(std::vector<uint8_t> directory)
+{
+    // the classic spot is right behind the section table, the headers are mapped so its file offset is its rva
+    // name offsets are 16 bits, a directory that large doesn't fit the headers anyway
+    uint64_t headerEnd = reader.section_table_offset() + reader.sections().size() * sizeof(pe::section_header);
+    uint64_t limit = std::min<uint64_t>(reader.size_of_headers(), image.size());
+    for (const auto& section : reader.sections())
+    {
+        if (section.SizeOfRawData != 0 && section.PointerToRawData != 0) limit = std::min<uint64_t>(limit, section.PointerToRawData);
+    }
+    if (headerEnd + directory.size() > limit) return fail("no room for the bound import directory behind the section table");
+
+    pe::data_directory old = reader.directory(pe::DIRECTORY_BOUND_IMPORT);
+    for (uint64_t i = headerEnd; i < headerEnd + directory.size(); ++i)
+    {
+        bool inOld = old.VirtualAddress != 0 && i >= old.VirtualAddress && i < static_cast<uint64_t>(old.VirtualAddress) + old.Size;
+        if (image[i] != 0 && !inOld) return fail("the space after the section table is in use");
+    }
+
+    auto size = static_cast<uint32_t>(directory.size());
+    // whatever is left of a longer old directory at the same spot is cleared
+    if (old.VirtualAddress == headerEnd && old.Size > size && headerEnd + old.Size <= limit) directory.resize(old.Size, 0);
+    patch(headerEnd, std::move(directory));
+    patch_u32(reader.data_directory_offset() + pe::DIRECTORY_BOUND_IMPORT * sizeof(pe::data_directory), static_cast<uint32_t>(headerEnd));
+    patch_u32(reader.data_directory_offset() + pe::DIRECTORY_BOUND_IMPORT * sizeof(pe::data_directory) + 4, size);
+    return true;
+}
+
+void import_binder::patch(uint64_t offset, std::vector<uint8_t> bytes)
+{
+    filePatches.push_back({ offset, std::move(bytes) });
+}
+
+void import_binder::patch_u32(uint64_t offset, uint32_t value)
+{
+    std::vector<uint8_t> bytes(sizeof(value));
+    pe::write(bytes.data(), value);
+    filePatches.push_back({ offset, std::move(bytes) });
+}
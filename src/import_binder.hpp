@@ -0,0 +1,81 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include "dependency_resolver.hpp"
+#include "import_patcher.hpp"
+#include "mapped_file.hpp"
+#include "pe_reader.hpp"
+
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// offline bind step: fills the IAT with the export addresses of the DLLs found on disk and writes a bound import directory
+// with their timestamps, the loader skips resolving a descriptor when its DLLs match and load at their preferred base
+// descriptors that can't be bound completely are left to the loader (and unbound again if an earlier bind went stale)
+// everything is read from the files, nothing is loaded, so it works the same off windows
+class import_binder {
+public:
+    import_binder(std::span<const uint8_t> image, std::string target, std::vector<std::string> searchPaths)
+        : image(image), reader(image), target(std::move(target)), modules(std::move(searchPaths)) {}
+
+    // ignoreNoBind binds images linked with /ALLOWBIND:NO anyway
+    [[nodiscard]] bool bind(bool ignoreNoBind);
+    // see import_patcher::write
+    [[nodiscard]] bool write(const std::string& source, const std::string& destination);
+
+    [[nodiscard]] const std::string& error() const { return lastError; }
+    [[nodiscard]] const std::vector<file_patch>& patches() const { return filePatches; }
+    [[nodiscard]] uint64_t patched_bytes() const;
+    [[nodiscard]] size_t descriptor_count() const { return descriptorCount; }
+    [[nodiscard]] size_t bound_count() const { return boundCount; }
+    [[nodiscard]] size_t slot_count() const { return slotCount; }
+    // "MODULE: reason" for every descriptor left unbound
+    [[nodiscard]] const std::vector<std::string>& skipped() const { return skippedDescriptors; }
+    // bound DLLs with ASLR enabled, their bound addresses are only used if they still load at their preferred base
+    [[nodiscard]] const std::vector<std::string>& relocatable() const { return relocatableModules; }
+
+private:
+    struct bound_dll {
+        std::string name; // as the importer spelled it, forwarder targets get ".dll" appended
+        mapped_file file;
+        pe_reader reader { {} };
+        uint32_t timeDateStamp = 0;
+        uint64_t imageBase = 0;
+        bool dynamicBase = false;
+    };
+
+    struct bound_module {
+        std::string name;
+        uint32_t timeDateStamp = 0;
+        std::vector<const bound_dll*> forwardedTo;
+    };
+
+    [[nodiscard]] bool fail(const std::string& message);
+    // null when the module isn't on the search path, loaded once per run
+    [[nodiscard]] const bound_dll* load_module(const std::string& name);
+    // the VA module!function ends up at, following forwarders and noting the modules they lead to
+    [[nodiscard]] bool resolve_export(const bound_dll& dll, const std::string& function, uint32_t hops, uint64_t& address,
+        std::vector<const bound_dll*>& forwardedTo, std::string& reason);
+    [[nodiscard]] std::vector<uint8_t> build_directory(const std::vector<bound_module>& boundModules) const;
+    [[nodiscard]] bool place_directory(std::vector<uint8_t> directory);
+    void patch(uint64_t offset, std::vector<uint8_t> bytes);
+    void patch_u32(uint64_t offset, uint32_t value);
+
+    std::span<const uint8_t> image;
+    pe_reader reader;
+    std::string target;
+    dependency_resolver modules;
+    std::string lastError;
+
+    std::unordered_map<std::string, std::unique_ptr<bound_dll>> loaded; // lower-cased name
+    std::vector<file_patch> filePatches;
+    size_t descriptorCount = 0;
+    size_t boundCount = 0;
+    size_t slotCount = 0;
+    std::vector<std::string> skippedDescriptors;
+    std::vector<std::string> relocatableModules;
+};
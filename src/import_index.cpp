@@ -0,0 +1,152 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "import_index.hpp"
+
+void import_index::build(LIEF::PE::Binary& binary)
+{
+    entries.clear();
+    descriptors.clear();
+    slotWidth = binary.type() == LIEF::PE::PE_TYPE::PE32_PLUS ? 8 : 4;
+
+    uint32_t descriptorIndex = 0;
+    for (LIEF::PE::Import& import : binary.imports())
+    {
+        descriptors.push_back(&import);
+        uint32_t iatRva = import.import_address_table_rva();
+        uint32_t slotIndex = 0;
+        for (LIEF::PE::ImportEntry& entry : import.entries())
+        {
+            import_record record;
+            record.module = import.name();
+            record.isOrdinal = entry.is_ordinal();
+            if (record.isOrdinal) record.ordinal = entry.ordinal();
+            else record.function = entry.name();
+            record.hint = entry.hint();
+            record.slotRva = iatRva + slotIndex * slotWidth;
+            record.slotIndex = slotIndex;
+            record.descriptorIndex = descriptorIndex;
+            record.descriptor = &import;
+            record.entry = &entry;
+            entries.push_back(std::move(record));
+            ++slotIndex;
+        }
+        ++descriptorIndex;
+    }
+    index_entries();
+
+    moduleSlots.assign(table_capacity(descriptors.size()), {});
+    size_t mask = moduleSlots.size() - 1;
+    for (uint32_t i = 0; i < descriptors.size(); ++i)
+    {
+        const std::string& name = descriptors[i]->name();
+        uint64_t hash = hash_key(name, {});
+        size_t position = hash & mask;
+        bool duplicate = false;
+        while (moduleSlots[position].index != 0)
+        {
+            if (moduleSlots[position].hash == hash && util::equals_ignore_case(descriptors[moduleSlots[position].index - 1]->name(), name))
+            {
+                duplicate = true;
+                break;
+            }
+            position = (position + 1) & mask;
+        }
+        if (!duplicate) moduleSlots[position] = { hash, i + 1 };
+    }
+}
+
+void import_index::build(std::span<const pe_import> imports, uint32_t width)
+{
+    entries.clear();
+    descriptors.clear();
+    moduleSlots.clear();
+    slotWidth = width;
+
+    entries.reserve(imports.size());
+    for (const pe_import& import : imports)
+    {
+        import_record record;
+        record.module = import.module;
+        record.function = import.function;
+        record.isOrdinal = import.isOrdinal;
+        record.ordinal = import.ordinal;
+        record.hint = import.hint;
+        record.slotRva = import.slotRva;
+        entries.push_back(std::move(record));
+    }
+    index_entries();
+}
+
+void import_index::index_entries()
+{
+    entrySlots.assign(table_capacity(entries.size()), {});
+    size_t mask = entrySlots.size() - 1;
+    for (uint32_t i = 0; i < entries.size(); ++i)
+    {
+        uint64_t hash = hash_key(entries[i].module, function_key(entries[i]));
+        size_t position = hash & mask;
+        while (entrySlots[position].index != 0)
+        {
+            const import_record& existing = entries[entrySlots[position].index - 1];
+            // a module can be split over several descriptors, the later one wins like the old reverse scan did
+            if (entrySlots[position].hash == hash && util::equals_ignore_case(existing.module, entries[i].module) && function_key(existing) == function_key(entries[i]))
+                break;
+            position = (position + 1) & mask;
+        }
+        entrySlots[position] = { hash, i + 1 };
+    }
+}
+
+const import_record* import_index::find(std::string_view module, std::string_view function) const
+{
+    if (entrySlots.empty()) return nullptr;
+    uint64_t hash = hash_key(module, function);
+    size_t mask = entrySlots.size() - 1;
+    for (size_t position = hash & mask; entrySlots[position].index != 0; position = (position + 1) & mask)
+    {
+        if (entrySlots[position].hash != hash) continue;
+        const import_record& record = entries[entrySlots[position].index - 1];
+        bool functionMatches = record.isOrdinal ? function_key(record) == function : record.function == function;
+        if (functionMatches && util::equals_ignore_case(record.module, module)) return &record;
+    }
+    return nullptr;
+}
+
+const import_record* import_index::find_ordinal(std::string_view module, uint16_t ordinal) const
+{
+    return find(module, "#" + std::to_string(ordinal));
+}
+
+LIEF::PE::Import* import_index::find_module(std::string_view module) const
+{
+    if (moduleSlots.empty()) return nullptr;
+    uint64_t hash = hash_key(module, {});
+    size_t mask = moduleSlots.size() - 1;
+    for (size_t position = hash & mask; moduleSlots[position].index != 0; position = (position + 1) & mask)
+    {
+        LIEF::PE::Import* descriptor = descriptors[moduleSlots[position].index - 1];
+        if (moduleSlots[position].hash == hash && util::equals_ignore_case(descriptor->name(), module)) return descriptor;
+    }
+    return nullptr;
+}
+
+std::string import_index::function_key(const import_record& record)
+{
+    return record.isOrdinal ? "#" + std::to_string(record.ordinal) : record.function;
+}
+
+uint64_t import_index::hash_key(std::string_view module, std::string_view function)
+{
+    // fnv-1a, module folded to lowercase so the hash agrees with util::equals_ignore_case
+    return hash::fnv1a(function, util::hash_ignore_case(module) * hash::FNV_PRIME);
+}
+
+size_t import_index::table_capacity(size_t count)
+{
+    // keep the load factor at or below 1/2 so probe sequences stay short
+    size_t capacity = 16;
+    while (capacity < count * 2) capacity <<= 1;
+    return capacity;
+}
@@ -0,0 +1,60 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include "pe_reader.hpp"
+#include "util.hpp"
+
+#include <span>
+#include <string_view>
+
+struct import_record {
+    std::string module;     // as written in the import descriptor
+    std::string function;   // empty for imports by ordinal
+    bool isOrdinal = false;
+    uint16_t ordinal = 0;
+    uint16_t hint = 0;
+    uint32_t slotRva = 0;   // rva of this entry's slot in the IAT
+    uint32_t slotIndex = 0;
+    uint32_t descriptorIndex = 0;
+    LIEF::PE::Import* descriptor = nullptr;     // null when built from a pe_reader list
+    LIEF::PE::ImportEntry* entry = nullptr;
+};
+
+// flat open addressing index over every import of a parsed binary, keyed by (module, function)
+// modules match case-insensitively like the windows loader does, function names match exactly
+// holds pointers into the binary, rebuild it after adding or removing imports
+class import_index {
+public:
+    void build(LIEF::PE::Binary& binary);
+    // from pe_reader's imports or delay imports without a LIEF parse, records() keeps their order
+    // there are no descriptors, so find_module() finds nothing
+    void build(std::span<const pe_import> imports, uint32_t width);
+
+    [[nodiscard]] const import_record* find(std::string_view module, std::string_view function) const;
+    [[nodiscard]] const import_record* find_ordinal(std::string_view module, uint16_t ordinal) const;
+    // first descriptor importing from the module, or nullptr
+    [[nodiscard]] LIEF::PE::Import* find_module(std::string_view module) const;
+
+    [[nodiscard]] const std::vector<import_record>& records() const { return entries; }
+    [[nodiscard]] uint32_t slot_width() const { return slotWidth; }
+
+    // "#123" for ordinal imports, the name otherwise
+    [[nodiscard]] static std::string function_key(const import_record& record);
+
+private:
+    struct slot {
+        uint64_t hash = 0;
+        uint32_t index = 0; // record index + 1, 0 marks an empty slot
+    };
+
+    void index_entries();
+    [[nodiscard]] static uint64_t hash_key(std::string_view module, std::string_view function);
+    [[nodiscard]] static size_t table_capacity(size_t count);
+
+    std::vector<import_record> entries;
+    std::vector<LIEF::PE::Import*> descriptors;
+    std::vector<slot> entrySlots;
+    std::vector<slot> moduleSlots;
+    uint32_t slotWidth = 8;
+};
@@ -0,0 +1,799 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "import_patcher.hpp"
+#include "delay_stub.hpp"
+#include "pe_checksum.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+
+bool import_patcher::load()
+{
+    if (!reader.parse()) return fail(reader.error());
+    if (reader.directory_count() <= pe::DIRECTORY_IMPORT) return fail("image has no import directory entry");
+
+    pe32Plus = reader.is_pe32_plus();
+    machine = reader.file_header().Machine;
+    imageBase = reader.image_base();
+    optionalHeaderOffset = reader.optional_header_offset();
+    sectionTableOffset = reader.section_table_offset();
+    dataDirectoryOffset = reader.data_directory_offset();
+    sectionAlignment = reader.section_alignment();
+    fileAlignment = reader.file_alignment();
+    sizeOfImage = reader.size_of_image();
+    sizeOfHeaders = reader.size_of_headers();
+    sizeOfInitializedData = pe::read<uint32_t>(image.data() + optionalHeaderOffset + pe::OPTIONAL_SIZE_OF_INITIALIZED_DATA);
+    sections = reader.sections();
+    for (uint32_t i = 0; i < pe::NUMBER_OF_DIRECTORIES; ++i)
+    {
+        directories[i] = reader.directory(i);
+    }
+
+    const pe::data_directory& importDirectory = directories[pe::DIRECTORY_IMPORT];
+    if (importDirectory.VirtualAddress != 0)
+    {
+        int64_t tableOffset = reader.offset_from_rva(importDirectory.VirtualAddress);
+        if (tableOffset < 0) return fail("import directory isn't backed by file data");
+        importTableOffset = static_cast<uint32_t>(tableOffset);
+
+        for (uint64_t offset = importTableOffset; offset + sizeof(pe::import_descriptor) <= image.size(); offset += sizeof(pe::import_descriptor))
+        {
+            auto raw = pe::read<pe::import_descriptor>(image.data() + offset);
+            if (raw.Name == 0 && raw.FirstThunk == 0 && raw.OriginalFirstThunk == 0) break;
+            existing.push_back({ raw, std::string(reader.string_at(raw.Name)), {} });
+        }
+        importTableCount = static_cast<uint32_t>(existing.size());
+
+        for (const auto& import : reader.imports())
+        {
+            if (!import.isOrdinal && import.nameRva != 0) existingNames.emplace(import.function, std::make_pair(import.nameRva, import.hint));
+        }
+    }
+
+    const pe::data_directory& delayDirectory = directories[pe::DIRECTORY_DELAY_IMPORT];
+    if (delayDirectory.VirtualAddress != 0)
+    {
+        int64_t tableOffset = reader.offset_from_rva(delayDirectory.VirtualAddress);
+        if (tableOffset < 0) return fail("delay import directory isn't backed by file data");
+        // the reader hands them out converted to RVAs, in table order
+        std::vector<pe::delayload_descriptor> converted = reader.delay_descriptors();
+        for (size_t i = 0; i < converted.size(); ++i)
+        {
+            auto raw = pe::read<pe::delayload_descriptor>(image.data() + tableOffset + i * sizeof(pe::delayload_descriptor));
+            uint64_t nameBias = (raw.Attributes & pe::DELAY_ATTRIBUTE_RVA) != 0 ? 0 : imageBase;
+            existingDelay.push_back({ raw, std::string(reader.string_at(converted[i].DllNameRVA)),
+                read_thunk_names(converted[i].ImportNameTableRVA, nameBias), {} });
+        }
+    }
+    return true;
+}
+
+void import_patcher::add_import(const std::string& module, const std::string& function, uint16_t hint)
+{
+    auto it = std::ranges::find_if(additions, [&module](const pending_module& pending) { return util::equals_ignore_case(pending.module, module); });
+    if (it == additions.end())
+    {
+        additions.push_back({ module, { function }, { hint } });
+        return;
+    }
+    if (std::ranges::find(it->functions, function) != it->functions.end()) return;
+    it->functions.push_back(function);
+    it->hints.push_back(hint);
+}
+
+bool import_patcher::remove_import(const std::string& module, const std::string& function)
+{
+    for (auto& descriptor : existing)
+    {
+        if (!util::equals_ignore_case(descriptor.module, module)) continue;
+        uint32_t thunkRva = pe_reader::name_table(descriptor.raw);
+        if (thunkRva == 0) return fail("the functions of " + descriptor.module + " can't be read, it's bound and has no import lookup table");
+        std::vector<std::string> names = read_thunk_names(thunkRva, 0);
+        if (std::ranges::find(names, function) == names.end()) continue;
+        if (std::ranges::find(descriptor.removedFunctions, function) == descriptor.removedFunctions.end())
+        {
+            descriptor.removedFunctions.push_back(function);
+        }
+        // only whole descriptors can go, build() rejects the ones that end up partially removed
+        descriptor.removed = descriptor.removedFunctions.size() == names.size();
+        return true;
+    }
+    return fail("import not found: " + module + "::" + function);
+}
+
+void import_patcher::add_delay_import(const std::string& module, const std::string& function, uint16_t hint)
+{
+    auto it = std::ranges::find_if(delayAdditions, [&module](const pending_module& pending) { return util::equals_ignore_case(pending.module, module); });
+    if (it == delayAdditions.end())
+    {
+        delayAdditions.push_back({ module, { function }, { hint } });
+        return;
+    }
+    if (std::ranges::find(it->functions, function) != it->functions.end()) return;
+    it->functions.push_back(function);
+    it->hints.push_back(hint);
+}
+
+bool import_patcher::remove_delay_import(const std::string& module, const std::string& function)
+{
+    for (auto& descriptor : existingDelay)
+    {
+        if (!util::equals_ignore_case(descriptor.module, module)) continue;
+        if (std::ranges::find(descriptor.functions, function) == descriptor.functions.end()) continue;
+        if (std::ranges::find(descriptor.removedFunctions, function) == descriptor.removedFunctions.end())
+        {
+            descriptor.removedFunctions.push_back(function);
+        }
+        descriptor.removed = descriptor.removedFunctions.size() == descriptor.functions.size();
+        return true;
+    }
+    return fail("delay import not found: " + module + "::" + function);
+}
+
+void import_patcher::update_hint(uint32_t nameRva, uint16_t hint)
+{
+    hintUpdates.emplace_back(nameRva, hint);
+}
+
+bool import_patcher::build()
+{
+    filePatches.clear();
+    outputSize = image.size();
+    outputSizeOfImage = sizeOfImage;
+    report = {};
+
+    // a malformed "#" would end up as a name entry, or as an ordinal cut down to 16 bits
+    for (const auto* pending : { &additions, &delayAdditions })
+    {
+        for (const auto& module : *pending)
+        {
+            for (const auto& function : module.functions)
+            {
+                uint16_t ordinal = 0;
+                if (function.size() > 1 && function.front() == '#' && !parse_ordinal(function, ordinal)) return fail("invalid ordinal: " + module.module + "::" + function);
+            }
+        }
+    }
+
+    // two bytes each, they never overlap anything the descriptor edits below touch
+    for (const auto& [nameRva, hint] : hintUpdates)
+    {
+        int64_t offset = reader.offset_from_rva(nameRva);
+        if (offset < 0 || static_cast<uint64_t>(offset) + sizeof(uint16_t) > image.size()) return fail("hint/name entry isn't backed by file data");
+        patch_u16(static_cast<uint64_t>(offset), hint);
+    }
+
+    std::vector<pe::import_descriptor> descriptors;
+    for (const auto& descriptor : existing)
+    {
+        if (!descriptor.removed && !descriptor.removedFunctions.empty())
+        {
+            return fail("removing one of several functions from " + descriptor.module + " would move IAT slots");
+        }
+        if (!descriptor.removed) descriptors.push_back(descriptor.raw);
+    }
+
+    std::vector<pe::delayload_descriptor> delayDescriptors;
+    for (const auto& descriptor : existingDelay)
+    {
+        if (!descriptor.removed && !descriptor.removedFunctions.empty())
+        {
+            return fail("removing one of several delay-loaded functions from " + descriptor.module + " would move IAT slots");
+        }
+        if (!descriptor.removed) delayDescriptors.push_back(descriptor.raw);
+    }
+
+    if (!delayAdditions.empty())
+    {
+        if (reader.directory_count() <= pe::DIRECTORY_DELAY_IMPORT) return fail("image has no delay import directory entry");
+        if (machine != (pe32Plus ? pe::MACHINE_AMD64 : pe::MACHINE_I386)) return fail("delay-load stubs can only be generated for x86 and x64 images");
+        // the resolvers call through these, import them the regular way if the target doesn't already
+        uint32_t loadLibrary = 0;
+        uint32_t getProcAddress = 0;
+        if (!find_loader_slots(loadLibrary, getProcAddress))
+        {
+            add_import("KERNEL32.dll", "LoadLibraryA");
+            add_import("KERNEL32.dll", "GetProcAddress");
+        }
+    }
+
+    // the old delay table can't be rewritten in place, the linker's thunks point into it
+    bool delayChanged = !delayAdditions.empty() || delayDescriptors.size() != existingDelay.size();
+    if (additions.empty() && !delayChanged)
+    {
+        if (descriptors.size() == existing.size()) return hintUpdates.empty() ? fail("nothing to change") : true;
+        return build_in_place(descriptors);
+    }
+    // delay additions bring code and relocations along, those always get the new section
+    if (!delayChanged && build_in_slack(descriptors)) return true;
+    return build_new_section(descriptors, delayDescriptors);
+}
+
+bool import_patcher::build_in_place(const std::vector<pe::import_descriptor>& descriptors)
+{
+    // the table only shrank, rewrite it where it is and zero the leftover tail including the old terminator
+    std::vector<uint8_t> table((importTableCount + 1) * sizeof(pe::import_descriptor), 0);
+    for (size_t i = 0; i < descriptors.size(); ++i)
+    {
+        pe::write(table.data() + i * sizeof(pe::import_descriptor), descriptors[i]);
+    }
+    filePatches.push_back({ importTableOffset, std::move(table) });
+    patch_directory(pe::DIRECTORY_IMPORT, descriptors.empty() ? 0 : directories[pe::DIRECTORY_IMPORT].VirtualAddress,
+        static_cast<uint32_t>((descriptors.size() + 1) * sizeof(pe::import_descriptor)));
+    return true;
+}
+
+bool import_patcher::build_in_slack(const std::vector<pe::import_descriptor>& descriptors)
+{
+    // a section header still has to fit behind the section table for the next edit that needs one
+    layout_planner planner(reader, image);
+    planner.measure(sizeof(pe::section_header));
+    uint32_t width = pe32Plus ? 8 : 4;
+    size_t newCount = descriptors.size() + additions.size();
+
+    // everything is placed before anything is patched, biggest first so the small entries fill the gaps
+    std::vector<std::pair<uint32_t, std::vector<uint8_t>>> placed;
+    auto place_bytes = [&planner, &placed](std::vector<uint8_t> bytes, uint32_t alignment) -> uint32_t
+    {
+        std::optional<uint32_t> rva = planner.place(static_cast<uint32_t>(bytes.size()), alignment, false, true);
+        if (!rva) return 0;
+        placed.emplace_back(*rva, std::move(bytes));
+        return *rva;
+    };
+    auto slot_bytes = [width](const std::vector<uint64_t>& thunks)
+    {
+        std::vector<uint8_t> bytes((thunks.size() + 1) * width, 0);
+        for (size_t i = 0; i < thunks.size(); ++i)
+        {
+            if (width == 8) pe::write<uint64_t>(bytes.data() + i * width, thunks[i]);
+            else pe::write<uint32_t>(bytes.data() + i * width, static_cast<uint32_t>(thunks[i]));
+        }
+        return bytes;
+    };
+
+    std::optional<uint32_t> table = planner.place(static_cast<uint32_t>((newCount + 1) * sizeof(pe::import_descriptor)), 4, false, true);
+    if (!table) return false;
+
+    std::vector<uint8_t> tableBytes((newCount + 1) * sizeof(pe::import_descriptor), 0);
+    for (size_t i = 0; i < descriptors.size(); ++i)
+    {
+        pe::write(tableBytes.data() + i * sizeof(pe::import_descriptor), descriptors[i]);
+    }
+
+    std::unordered_map<std::string, uint32_t> written; // hint and name -> entry placed by this build
+    for (size_t m = 0; m < additions.size(); ++m)
+    {
+        const pending_module& module = additions[m];
+        size_t slotsSize = (module.functions.size() + 1) * width;
+        std::optional<uint32_t> ilt = planner.place(static_cast<uint32_t>(slotsSize), width, false, true);
+        // the loader takes the names from the ILT, so the IAT may sit in memory the file doesn't back
+        std::optional<uint32_t> iat = planner.place(static_cast<uint32_t>(slotsSize), width, true, false);
+        if (!ilt || !iat) return false;
+
+        pe::import_descriptor descriptor {};
+        descriptor.OriginalFirstThunk = *ilt;
+        descriptor.FirstThunk = *iat;
+        descriptor.Name = existing_module_name(module.module);
+        if (descriptor.Name == 0)
+        {
+            std::vector<uint8_t> name(module.module.begin(), module.module.end());
+            name.push_back(0);
+            if ((descriptor.Name = place_bytes(std::move(name), 1)) == 0) return false;
+        }
+
+        std::vector<uint64_t> thunks;
+        for (size_t f = 0; f < module.functions.size(); ++f)
+        {
+            const std::string& function = module.functions[f];
+            uint16_t ordinal = 0;
+            if (parse_ordinal(function, ordinal))
+            {
+                thunks.push_back(ordinal | (pe32Plus ? pe::ORDINAL_FLAG64 : pe::ORDINAL_FLAG32));
+                continue;
+            }
+            uint16_t hint = module.hints[f];
+            uint32_t entry = existing_name(function, hint);
+            std::string key = std::to_string(hint) + ":" + function;
+            if (entry == 0 && written.contains(key)) entry = written[key];
+            if (entry == 0)
+            {
+                std::vector<uint8_t> bytes { static_cast<uint8_t>(hint), static_cast<uint8_t>(hint >> 8) };
+                bytes.insert(bytes.end(), function.begin(), function.end());
+                bytes.push_back(0);
+                if ((entry = place_bytes(std::move(bytes), 2)) == 0) return false;
+                written.emplace(key, entry);
+            }
+            thunks.push_back(entry);
+        }
+        placed.emplace_back(*ilt, slot_bytes(thunks));
+        if (planner.file_offset(*iat) >= 0) placed.emplace_back(*iat, slot_bytes(thunks));
+        pe::write(tableBytes.data() + (descriptors.size() + m) * sizeof(pe::import_descriptor), descriptor);
+    }
+    placed.emplace_back(*table, std::move(tableBytes));
+
+    for (auto& [rva, bytes] : placed)
+    {
+        filePatches.push_back({ static_cast<uint64_t>(planner.file_offset(rva)), std::move(bytes) });
+    }
+
+    // sections grow over the slack they gave up, never past the page they already end in
+    std::unordered_map<int32_t, uint32_t> grownSizes;
+    for (const auto& region : planner.regions())
+    {
+        if (region.used == 0) continue;
+        report.regions.push_back(region.name + ": " + std::to_string(region.used) + " bytes");
+        if (region.section < 0) continue;
+        const pe::section_header& section = sections[region.section];
+        uint32_t end = region.rva + region.used - section.VirtualAddress;
+        uint32_t& grown = grownSizes.try_emplace(region.section, section.VirtualSize).first->second;
+        grown = std::max(grown, end);
+    }
+    for (const auto& [index, virtualSize] : grownSizes)
+    {
+        if (virtualSize == sections[index].VirtualSize) continue;
+        patch_u32(sectionTableOffset + index * sizeof(pe::section_header) + offsetof(pe::section_header, VirtualSize), virtualSize);
+    }
+    patch_directory(pe::DIRECTORY_IMPORT, *table, static_cast<uint32_t>((newCount + 1) * sizeof(pe::import_descriptor)));
+    report.slackBytes = planner.used();
+    return true;
+}
+
+bool import_patcher::build_new_section(const std::vector<pe::import_descriptor>& descriptors, const std::vector<pe::delayload_descriptor>& delayDescriptors)
+{
+    if (sectionAlignment == 0 || fileAlignment == 0) return fail("image has no section/file alignment");
+
+    // room for one more section header between the section table and the first section's data
+    uint64_t headerEnd = sectionTableOffset + sections.size() * sizeof(pe::section_header);
+    uint64_t firstRawData = sizeOfHeaders;
+    for (const auto& section : sections)
+    {
+        if (section.SizeOfRawData != 0 && section.PointerToRawData != 0) firstRawData = std::min<uint64_t>(firstRawData, section.PointerToRawData);
+    }
+    if (headerEnd + sizeof(pe::section_header) > firstRawData) return fail("no room for another section header");
+
+    // bound imports usually live right behind the section table, they're only a load-time hint so drop them if we'd overwrite them
+    const pe::data_directory& bound = directories[pe::DIRECTORY_BOUND_IMPORT];
+    bool overlapsBound = bound.VirtualAddress != 0 && bound.VirtualAddress < headerEnd + sizeof(pe::section_header) && bound.VirtualAddress + bound.Size > headerEnd;
+    if (!overlapsBound)
+    {
+        for (uint64_t i = headerEnd; i < headerEnd + sizeof(pe::section_header); ++i)
+        {
+            if (image[i] != 0) return fail("the space after the section table is in use");
+        }
+    }
+
+    uint32_t width = pe32Plus ? 8 : 4;
+    bool rewriteImports = !additions.empty() || descriptors.size() != existing.size();
+    bool rewriteDelay = !delayAdditions.empty() || delayDescriptors.size() != existingDelay.size();
+    size_t newCount = descriptors.size() + additions.size();
+    size_t delayCount = delayDescriptors.size() + delayAdditions.size();
+
+    // layout: descriptor tables, ILTs, IATs, delay INTs/IATs/module handles, hint/name entries, module names,
+    // base relocations, then the delay resolvers and thunks
+    std::vector<uint8_t> content;
+    auto align_content = [&content](size_t alignment) { content.resize(pe::align_up(content.size(), alignment), 0); };
+    size_t importTable = content.size();
+    if (rewriteImports) content.resize((newCount + 1) * sizeof(pe::import_descriptor), 0);
+    align_content(4);
+    size_t delayTable = content.size();
+    if (rewriteDelay) content.resize(content.size() + (delayCount + 1) * sizeof(pe::delayload_descriptor), 0);
+
+    uint64_t virtualEnd = 0;
+    for (const auto& section : sections)
+    {
+        virtualEnd = std::max<uint64_t>(virtualEnd, section.VirtualAddress + std::max(section.VirtualSize, section.SizeOfRawData));
+    }
+    uint64_t sectionRva = pe::align_up(std::max<uint64_t>(virtualEnd, sizeOfImage), sectionAlignment);
+    if (sectionRva > UINT32_MAX) return fail("image is too large for another section");
+    auto rva = [sectionRva](size_t offset) { return static_cast<uint32_t>(sectionRva + offset); };
+    auto write_slot = [&content, this](size_t offset, uint64_t value)
+    {
+        if (pe32Plus) pe::write<uint64_t>(content.data() + offset, value);
+        else pe::write<uint32_t>(content.data() + offset, static_cast<uint32_t>(value));
+    };
+
+    align_content(8);
+    std::vector<size_t> iltOffsets;
+    for (const auto& module : additions)
+    {
+        iltOffsets.push_back(content.size());
+        content.resize(content.size() + (module.functions.size() + 1) * width, 0);
+    }
+    std::vector<size_t> iatOffsets;
+    for (const auto& module : additions)
+    {
+        iatOffsets.push_back(content.size());
+        content.resize(content.size() + (module.functions.size() + 1) * width, 0);
+    }
+    std::vector<size_t> delayIntOffsets;
+    std::vector<size_t> delayIatOffsets;
+    std::vector<size_t> delayHandleOffsets;
+    for (const auto& module : delayAdditions)
+    {
+        delayIntOffsets.push_back(content.size());
+        content.resize(content.size() + (module.functions.size() + 1) * width, 0);
+        delayIatOffsets.push_back(content.size());
+        content.resize(content.size() + (module.functions.size() + 1) * width, 0);
+        delayHandleOffsets.push_back(content.size());
+        content.resize(content.size() + width, 0);
+    }
+
+    // an ordinal, or the rva of a hint/name entry, shared with the image or an earlier one where they read the same
+    std::unordered_map<std::string, uint32_t> written;
+    auto add_name = [&](const std::string& function, uint16_t hint) -> uint64_t
+    {
+        uint16_t ordinal = 0;
+        if (parse_ordinal(function, ordinal))
+        {
+            return ordinal | (pe32Plus ? pe::ORDINAL_FLAG64 : pe::ORDINAL_FLAG32);
+        }
+        if (uint32_t entry = existing_name(function, hint)) return entry;
+        std::string key = std::to_string(hint) + ":" + function;
+        if (auto it = written.find(key); it != written.end()) return it->second;
+        align_content(2);
+        uint32_t thunk = rva(content.size());
+        written.emplace(std::move(key), thunk);
+        content.push_back(static_cast<uint8_t>(hint)); // the loader checks this name table slot first
+        content.push_back(static_cast<uint8_t>(hint >> 8));
+        content.insert(content.end(), function.begin(), function.end());
+        content.push_back(0);
+        return thunk;
+    };
+    for (size_t m = 0; m < additions.size(); ++m)
+    {
+        for (size_t f = 0; f < additions[m].functions.size(); ++f)
+        {
+            uint64_t thunk = add_name(additions[m].functions[f], additions[m].hints[f]);
+            write_slot(iltOffsets[m] + f * width, thunk);
+            write_slot(iatOffsets[m] + f * width, thunk);
+        }
+    }
+    // the delay IAT entries are filled in once the thunks have their addresses
+    for (size_t m = 0; m < delayAdditions.size(); ++m)
+    {
+        for (size_t f = 0; f < delayAdditions[m].functions.size(); ++f)
+        {
+            write_slot(delayIntOffsets[m] + f * width, add_name(delayAdditions[m].functions[f], delayAdditions[m].hints[f]));
+        }
+    }
+
+    for (size_t i = 0; i < descriptors.size() && rewriteImports; ++i)
+    {
+        pe::import_descriptor descriptor = descriptors[i];
+        // without the bound directory a stale timestamp would make the loader trust the prebound IAT
+        if (overlapsBound) descriptor.TimeDateStamp = 0;
+        pe::write(content.data() + importTable + i * sizeof(pe::import_descriptor), descriptor);
+    }
+    for (size_t m = 0; m < additions.size(); ++m)
+    {
+        pe::import_descriptor descriptor {};
+        descriptor.OriginalFirstThunk = rva(iltOffsets[m]);
+        descriptor.FirstThunk = rva(iatOffsets[m]);
+        descriptor.Name = existing_module_name(additions[m].module);
+        if (descriptor.Name == 0)
+        {
+            descriptor.Name = rva(content.size());
+            content.insert(content.end(), additions[m].module.begin(), additions[m].module.end());
+            content.push_back(0);
+        }
+        pe::write(content.data() + importTable + (descriptors.size() + m) * sizeof(pe::import_descriptor), descriptor);
+    }
+
+    // kept delay descriptors are copied as they are, old format ones included
+    for (size_t i = 0; i < delayDescriptors.size(); ++i)
+    {
+        pe::write(content.data() + delayTable + i * sizeof(pe::delayload_descriptor), delayDescriptors[i]);
+    }
+    std::vector<pe::delayload_descriptor> newDelayDescriptors;
+    for (size_t m = 0; m < delayAdditions.size(); ++m)
+    {
+        pe::delayload_descriptor descriptor {};
+        descriptor.Attributes = pe::DELAY_ATTRIBUTE_RVA;
+        descriptor.ModuleHandleRVA = rva(delayHandleOffsets[m]);
+        descriptor.ImportAddressTableRVA = rva(delayIatOffsets[m]);
+        descriptor.ImportNameTableRVA = rva(delayIntOffsets[m]);
+        descriptor.DllNameRVA = rva(content.size());
+        content.insert(content.end(), delayAdditions[m].module.begin(), delayAdditions[m].module.end());
+        content.push_back(0);
+        pe::write(content.data() + delayTable + (delayDescriptors.size() + m) * sizeof(pe::delayload_descriptor), descriptor);
+        newDelayDescriptors.push_back(descriptor);
+    }
+
+    // the delay IAT slots hold absolute thunk addresses, a relocated image needs fixups for them
+    // the existing blocks are copied over and the new ones appended, images without relocations load at their base anyway
+    const pe::data_directory& relocations = directories[pe::DIRECTORY_BASERELOC];
+    bool rewriteRelocations = !delayAdditions.empty() && relocations.VirtualAddress != 0 && relocations.Size != 0;
+    size_t relocationTable = 0;
+    if (rewriteRelocations)
+    {
+        int64_t relocationOffset = reader.offset_from_rva(relocations.VirtualAddress);
+        if (relocationOffset < 0 || static_cast<uint64_t>(relocationOffset) + relocations.Size > image.size())
+            return fail("base relocation directory isn't backed by file data");
+        align_content(4);
+        relocationTable = content.size();
+        content.insert(content.end(), image.begin() + relocationOffset, image.begin() + relocationOffset + relocations.Size);
+        align_content(4);
+
+        std::vector<uint32_t> slots;
+        for (size_t m = 0; m < delayAdditions.size(); ++m)
+        {
+            for (size_t f = 0; f < delayAdditions[m].functions.size(); ++f)
+            {
+                slots.push_back(newDelayDescriptors[m].ImportAddressTableRVA + static_cast<uint32_t>(f * width));
+            }
+        }
+        uint16_t type = pe32Plus ? pe::REL_BASED_DIR64 : pe::REL_BASED_HIGHLOW;
+        for (size_t first = 0; first < slots.size();)
+        {
+            uint32_t page = slots[first] & ~0xFFFu;
+            size_t last = first;
+            while (last < slots.size() && (slots[last] & ~0xFFFu) == page) ++last;
+            // blocks stay 4 byte aligned, an odd entry count is padded with an ABSOLUTE entry
+            size_t entries = pe::align_up(last - first, 2);
+            size_t block = content.size();
+            content.resize(block + sizeof(pe::base_relocation_block) + entries * sizeof(uint16_t), 0);
+            pe::write(content.data() + block, pe::base_relocation_block { page, static_cast<uint32_t>(sizeof(pe::base_relocation_block) + entries * sizeof(uint16_t)) });
+            for (size_t i = first; i < last; ++i)
+            {
+                auto entry = static_cast<uint16_t>((type << 12) | (slots[i] & 0xFFF));
+                pe::write(content.data() + block + sizeof(pe::base_relocation_block) + (i - first) * sizeof(uint16_t), entry);
+            }
+            first = last;
+        }
+    }
+    size_t relocationSize = content.size() - relocationTable;
+
+    if (!delayAdditions.empty())
+    {
+        delay_stub_layout layout;
+        if (!find_loader_slots(layout.loadLibrary, layout.getProcAddress))
+        {
+            for (size_t m = 0; m < additions.size(); ++m)
+            {
+                if (!util::equals_ignore_case(additions[m].module, "KERNEL32.dll")) continue;
+                const auto& functions = additions[m].functions;
+                auto slot = [&](const char* name) { return rva(iatOffsets[m] + (std::ranges::find(functions, name) - functions.begin()) * width); };
+                layout.loadLibrary = slot("LoadLibraryA");
+                layout.getProcAddress = slot("GetProcAddress");
+            }
+        }
+
+        for (size_t m = 0; m < delayAdditions.size(); ++m)
+        {
+            layout.moduleName = newDelayDescriptors[m].DllNameRVA;
+            layout.moduleHandle = newDelayDescriptors[m].ModuleHandleRVA;
+            layout.iat = newDelayDescriptors[m].ImportAddressTableRVA;
+            layout.names = newDelayDescriptors[m].ImportNameTableRVA;
+
+            align_content(16);
+            uint32_t resolverRva = rva(content.size());
+            std::vector<uint8_t> resolver = delay_stub::resolver(pe32Plus, resolverRva, layout);
+            content.insert(content.end(), resolver.begin(), resolver.end());
+            for (size_t f = 0; f < delayAdditions[m].functions.size(); ++f)
+            {
+                uint32_t thunkRva = rva(content.size());
+                std::vector<uint8_t> thunk = delay_stub::thunk(pe32Plus, thunkRva, layout.iat + static_cast<uint32_t>(f * width), layout.iat, resolverRva);
+                content.insert(content.end(), thunk.begin(), thunk.end());
+                write_slot(delayIatOffsets[m] + f * width, imageBase + thunkRva);
+            }
+        }
+    }
+
+    // anything after the certificate table gets cut off, the signature doesn't survive this edit anyway
+    uint64_t dataEnd = image.size();
+    const pe::data_directory& security = directories[pe::DIRECTORY_SECURITY];
+    bool dropSignature = security.VirtualAddress != 0 && static_cast<uint64_t>(security.VirtualAddress) + security.Size >= image.size();
+    if (dropSignature) dataEnd = security.VirtualAddress;
+
+    pe::section_header header {};
+    std::memcpy(header.Name, ".sinj", 5);
+    header.VirtualSize = static_cast<uint32_t>(content.size());
+    header.VirtualAddress = static_cast<uint32_t>(sectionRva);
+    header.SizeOfRawData = static_cast<uint32_t>(pe::align_up(content.size(), fileAlignment));
+    header.PointerToRawData = static_cast<uint32_t>(pe::align_up(dataEnd, fileAlignment));
+    header.Characteristics = pe::SCN_CNT_INITIALIZED_DATA | pe::SCN_MEM_READ | pe::SCN_MEM_WRITE;
+    // the resolvers write the IAT and module handle next to them, so the section stays writable
+    if (!delayAdditions.empty()) header.Characteristics |= pe::SCN_CNT_CODE | pe::SCN_MEM_EXECUTE;
+    if (pe::align_up(dataEnd, fileAlignment) > UINT32_MAX) return fail("file is too large for another section");
+
+    std::vector<uint8_t> headerBytes(sizeof(pe::section_header));
+    pe::write(headerBytes.data(), header);
+    filePatches.push_back({ headerEnd, std::move(headerBytes) });
+
+    // raw data plus the alignment padding in front of and behind it
+    std::vector<uint8_t> raw(header.PointerToRawData - dataEnd, 0);
+    raw.insert(raw.end(), content.begin(), content.end());
+    raw.resize(header.PointerToRawData - dataEnd + header.SizeOfRawData, 0);
+    filePatches.push_back({ dataEnd, std::move(raw) });
+    outputSize = static_cast<uint64_t>(header.PointerToRawData) + header.SizeOfRawData;
+    report.sectionBytes = header.SizeOfRawData;
+
+    uint64_t fileHeaderOffset = optionalHeaderOffset - sizeof(pe::file_header);
+    patch_u16(fileHeaderOffset + offsetof(pe::file_header, NumberOfSections), static_cast<uint16_t>(sections.size() + 1));
+    outputSizeOfImage = static_cast<uint32_t>(pe::align_up(sectionRva + header.VirtualSize, sectionAlignment));
+    patch_u32(optionalHeaderOffset + pe::OPTIONAL_SIZE_OF_IMAGE, outputSizeOfImage);
+    patch_u32(optionalHeaderOffset + pe::OPTIONAL_SIZE_OF_INITIALIZED_DATA, sizeOfInitializedData + header.SizeOfRawData);
+    if (rewriteImports)
+    {
+        patch_directory(pe::DIRECTORY_IMPORT, newCount == 0 ? 0 : rva(importTable), static_cast<uint32_t>((newCount + 1) * sizeof(pe::import_descriptor)));
+    }
+    if (rewriteDelay)
+    {
+        patch_directory(pe::DIRECTORY_DELAY_IMPORT, delayCount == 0 ? 0 : rva(delayTable),
+            delayCount == 0 ? 0 : static_cast<uint32_t>((delayCount + 1) * sizeof(pe::delayload_descriptor)));
+    }
+    if (rewriteRelocations) patch_directory(pe::DIRECTORY_BASERELOC, rva(relocationTable), static_cast<uint32_t>(relocationSize));
+    if (dropSignature) patch_directory(pe::DIRECTORY_SECURITY, 0, 0);
+    if (overlapsBound) patch_directory(pe::DIRECTORY_BOUND_IMPORT, 0, 0);
+    return true;
+}
+
+bool import_patcher::write(const std::string& source, const std::string& destination)
+{
+    return write_patches(source, destination, image.size(), outputSize, filePatches, lastError);
+}
+
+bool import_patcher::write_patches(const std::string& source, const std::string& destination, uint64_t sourceSize, uint64_t outputSize,
+    const std::vector<file_patch>& patches, std::string& error)
+{
+    // the patched copy is built next to the destination and renamed over it, so a failure or a crash partway leaves
+    // the destination (the target itself for in-place saves, or whatever it's hard linked to) exactly as it was
+    return util::replace_file(destination, [&](const std::string& temporaryPath) {
+        std::error_code ec;
+        // lets the OS do the bulk copy (CopyFile / copy_file_range), we only write the delta afterwards
+        if (!std::filesystem::copy_file(source, temporaryPath, std::filesystem::copy_options::overwrite_existing, ec))
+        {
+            error = "failed to copy file: " + ec.message();
+            return false;
+        }
+
+        if (outputSize != sourceSize)
+        {
+            std::filesystem::resize_file(temporaryPath, outputSize, ec);
+            if (ec)
+            {
+                error = "failed to resize output file: " + ec.message();
+                return false;
+            }
+        }
+
+        {
+            std::fstream output(temporaryPath, std::ios::binary | std::ios::in | std::ios::out);
+            if (!output.is_open())
+            {
+                error = "failed to open output file";
+                return false;
+            }
+            for (const auto& patch : patches)
+            {
+                output.seekp(static_cast<std::streamoff>(patch.offset));
+                output.write(reinterpret_cast<const char*>(patch.bytes.data()), static_cast<std::streamsize>(patch.bytes.size()));
+            }
+            output.flush();
+            if (!output.good())
+            {
+                error = "failed to write output file";
+                return false;
+            }
+        }
+
+        // a stale checksum fails driver loads and /INTEGRITYCHECK images, images linked without one stay without
+        bool updated;
+        return pe_checksum::refresh(temporaryPath, false, updated, error);
+    }, error);
+}
+
+layout_report import_patcher::layout() const
+{
+    layout_report result = report;
+    auto pages = [](uint64_t size) { return static_cast<int64_t>(pe::align_up(size, pe::LOADER_PAGE_SIZE) / pe::LOADER_PAGE_SIZE); };
+    result.fileDelta = static_cast<int64_t>(outputSize) - static_cast<int64_t>(image.size());
+    result.pageDelta = pages(outputSizeOfImage) - pages(sizeOfImage);
+    return result;
+}
+
+uint64_t import_patcher::patched_bytes() const
+{
+    uint64_t total = 0;
+    for (const auto& patch : filePatches) total += patch.bytes.size();
+    return total;
+}
+
+bool import_patcher::fail(const std::string& message)
+{
+    lastError = message;
+    return false;
+}
+
+std::vector<std::string> import_patcher::read_thunk_names(uint32_t thunkRva, uint64_t nameBias) const
+{
+    std::vector<std::string> names;
+    int64_t offset = reader.offset_from_rva(thunkRva);
+    if (offset < 0) return names;
+
+    uint32_t width = pe32Plus ? 8 : 4;
+    for (uint64_t position = offset; position + width <= image.size(); position += width)
+    {
+        uint64_t thunk = pe32Plus ? pe::read<uint64_t>(image.data() + position) : pe::read<uint32_t>(image.data() + position);
+        if (thunk == 0) break;
+        bool byOrdinal = pe32Plus ? (thunk & pe::ORDINAL_FLAG64) != 0 : (thunk & pe::ORDINAL_FLAG32) != 0;
+        if (byOrdinal) names.push_back("#" + std::to_string(thunk & 0xFFFF));
+        else names.push_back(std::string(reader.string_at(static_cast<uint32_t>(thunk - nameBias) + 2)));
+    }
+    return names;
+}
+
+bool import_patcher::find_loader_slots(uint32_t& loadLibrary, uint32_t& getProcAddress) const
+{
+    loadLibrary = 0;
+    getProcAddress = 0;
+    uint32_t width = pe32Plus ? 8 : 4;
+    for (const auto& descriptor : existing)
+    {
+        if (descriptor.removed || !util::equals_ignore_case(descriptor.module, "KERNEL32.dll")) continue;
+        uint32_t thunkRva = pe_reader::name_table(descriptor.raw);
+        if (thunkRva == 0) continue;
+        std::vector<std::string> names = read_thunk_names(thunkRva, 0);
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            if (names[i] == "LoadLibraryA") loadLibrary = descriptor.raw.FirstThunk + static_cast<uint32_t>(i * width);
+            if (names[i] == "GetProcAddress") getProcAddress = descriptor.raw.FirstThunk + static_cast<uint32_t>(i * width);
+        }
+    }
+    return loadLibrary != 0 && getProcAddress != 0;
+}
+
+uint32_t import_patcher::existing_name(const std::string& function, uint16_t hint) const
+{
+    // a hint of 0 wasn't looked up, any entry with the name does
+    auto [first, last] = existingNames.equal_range(function);
+    for (auto it = first; it != last; ++it)
+    {
+        if (hint == 0 || it->second.second == hint) return it->second.first;
+    }
+    return 0;
+}
+
+uint32_t import_patcher::existing_module_name(const std::string& module) const
+{
+    // removed descriptors keep their strings, the bytes aren't cleared
+    for (const auto& descriptor : existing)
+    {
+        if (util::equals_ignore_case(descriptor.module, module)) return descriptor.raw.Name;
+    }
+    return 0;
+}
+
+void import_patcher::patch_u16(uint64_t offset, uint16_t value)
+{
+    std::vector<uint8_t> bytes(sizeof(value));
+    pe::write(bytes.data(), value);
+    filePatches.push_back({ offset, std::move(bytes) });
+}
+
+void import_patcher::patch_u32(uint64_t offset, uint32_t value)
+{
+    std::vector<uint8_t> bytes(sizeof(value));
+    pe::write(bytes.data(), value);
+    filePatches.push_back({ offset, std::move(bytes) });
+}
+
+void import_patcher::patch_directory(uint32_t index, uint32_t rva, uint32_t size)
+{
+    if (index >= reader.directory_count()) return;
+    uint64_t offset = dataDirectoryOffset + index * sizeof(pe::data_directory);
+    patch_u32(offset, rva);
+    patch_u32(offset + 4, size);
+}
+
+bool import_patcher::parse_ordinal(std::string_view function, uint16_t& ordinal)
+{
+    if (function.size() < 2 || function.front() != '#') return false;
+    auto [end, ec] = std::from_chars(function.data() + 1, function.data() + function.size(), ordinal);
+    return ec == std::errc() && end == function.data() + function.size();
+}
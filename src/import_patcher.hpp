@@ -0,0 +1,128 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include "layout_planner.hpp"
+#include "pe_reader.hpp"
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct file_patch {
+    uint64_t offset;
+    std::vector<uint8_t> bytes;
+};
+
+// edits the import directory of a PE image without rebuilding it
+// the original bytes are kept verbatim, new descriptors/ILT/IAT/hint-name entries go into the slack the image already has
+// (see layout_planner) and only into one appended section when they don't fit there
+// hint/name entries and module names already in the image are shared instead of written again
+// functions are added as a second descriptor for their module so existing IAT slots never move
+// delay-load imports get their own descriptor, INT/IAT and module handle plus a small resolver (see delay_stub),
+// the old delay descriptors stay where they are because the linker's thunks pass their address to the helper
+class import_patcher {
+public:
+    explicit import_patcher(std::span<const uint8_t> image) : image(image), reader(image) {}
+
+    [[nodiscard]] bool load();
+
+    // "#123" imports by ordinal, the hint is the function's index in the DLL's export name table
+    void add_import(const std::string& module, const std::string& function, uint16_t hint = 0);
+    // descriptors are only dropped as a whole so no IAT slot moves, build() fails if some of their functions are left
+    [[nodiscard]] bool remove_import(const std::string& module, const std::string& function);
+    // the same for the delay-load directory, added modules resolve through KERNEL32!LoadLibraryA/GetProcAddress
+    void add_delay_import(const std::string& module, const std::string& function, uint16_t hint = 0);
+    [[nodiscard]] bool remove_delay_import(const std::string& module, const std::string& function);
+    // rewrites the hint of an existing hint/name entry where it is, nameRva comes from pe_import
+    void update_hint(uint32_t nameRva, uint16_t hint);
+
+    [[nodiscard]] bool build();
+    // copies source to destination (unless they're the same file), applies the patches and refreshes the checksum
+    // the image span isn't used anymore at this point, so its mapping can be closed before calling this
+    [[nodiscard]] bool write(const std::string& source, const std::string& destination);
+    // the same for patches made elsewhere, sourceSize is what the file has before they're applied
+    [[nodiscard]] static bool write_patches(const std::string& source, const std::string& destination, uint64_t sourceSize, uint64_t outputSize,
+        const std::vector<file_patch>& patches, std::string& error);
+
+    // "#123" to 123, false for a name and for anything after the # that isn't a decimal number up to 65535
+    [[nodiscard]] static bool parse_ordinal(std::string_view function, uint16_t& ordinal);
+
+    [[nodiscard]] const std::string& error() const { return lastError; }
+    [[nodiscard]] const std::vector<file_patch>& patches() const { return filePatches; }
+    [[nodiscard]] uint64_t patched_bytes() const;
+    [[nodiscard]] uint64_t output_size() const { return outputSize; }
+    // byte and page cost of the last build()
+    [[nodiscard]] layout_report layout() const;
+
+private:
+    struct existing_descriptor {
+        pe::import_descriptor raw;
+        std::string module;
+        std::vector<std::string> removedFunctions;
+        bool removed = false; // every function of the descriptor is gone, so it can be dropped as a whole
+    };
+
+    struct existing_delay_descriptor {
+        pe::delayload_descriptor raw; // as stored, VAs in the old format
+        std::string module;
+        std::vector<std::string> functions;
+        std::vector<std::string> removedFunctions;
+        bool removed = false;
+    };
+
+    struct pending_module {
+        std::string module;
+        std::vector<std::string> functions;
+        std::vector<uint16_t> hints; // one per function
+    };
+
+    [[nodiscard]] bool fail(const std::string& message);
+    // nameBias is subtracted from hint/name pointers, the image base for old format delay tables
+    [[nodiscard]] std::vector<std::string> read_thunk_names(uint32_t thunkRva, uint64_t nameBias) const;
+    [[nodiscard]] bool find_loader_slots(uint32_t& loadLibrary, uint32_t& getProcAddress) const;
+    [[nodiscard]] bool build_in_place(const std::vector<pe::import_descriptor>& descriptors);
+    // false without touching the patches when something doesn't fit, regular imports only
+    [[nodiscard]] bool build_in_slack(const std::vector<pe::import_descriptor>& descriptors);
+    [[nodiscard]] bool build_new_section(const std::vector<pe::import_descriptor>& descriptors, const std::vector<pe::delayload_descriptor>& delayDescriptors);
+    // rva of a hint/name entry already in the image that reads the same, 0 when there's none
+    [[nodiscard]] uint32_t existing_name(const std::string& function, uint16_t hint) const;
+    [[nodiscard]] uint32_t existing_module_name(const std::string& module) const;
+    void patch_u16(uint64_t offset, uint16_t value);
+    void patch_u32(uint64_t offset, uint32_t value);
+    void patch_directory(uint32_t index, uint32_t rva, uint32_t size);
+
+    std::span<const uint8_t> image;
+    pe_reader reader;
+    std::string lastError;
+
+    bool pe32Plus = false;
+    uint16_t machine = 0;
+    uint64_t imageBase = 0;
+    uint32_t optionalHeaderOffset = 0;
+    uint32_t sectionTableOffset = 0;
+    uint32_t dataDirectoryOffset = 0;
+    uint32_t sectionAlignment = 0;
+    uint32_t fileAlignment = 0;
+    uint32_t sizeOfImage = 0;
+    uint32_t sizeOfHeaders = 0;
+    uint32_t sizeOfInitializedData = 0;
+    std::vector<pe::section_header> sections;
+    pe::data_directory directories[pe::NUMBER_OF_DIRECTORIES] {};
+
+    uint32_t importTableOffset = 0;
+    uint32_t importTableCount = 0;
+    std::vector<existing_descriptor> existing;
+    std::vector<pending_module> additions;
+    std::vector<existing_delay_descriptor> existingDelay;
+    std::vector<pending_module> delayAdditions;
+    std::vector<std::pair<uint32_t, uint16_t>> hintUpdates;
+    std::unordered_multimap<std::string_view, std::pair<uint32_t, uint16_t>> existingNames; // function -> hint/name rva and hint
+
+    std::vector<file_patch> filePatches;
+    uint64_t outputSize = 0;
+    uint32_t outputSizeOfImage = 0;
+    layout_report report;
+};
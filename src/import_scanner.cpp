@@ -0,0 +1,119 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "import_scanner.hpp"
+#include "pe_reader.hpp"
+#include "util.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+std::vector<scanned_file> import_scanner::scan(const scan_index* previous)
+{
+    work_stealing_pool pool(threadCount);
+    // every worker appends to its own list, nothing is shared until the pool is done
+    std::vector<std::vector<scanned_file>> perWorker(pool.size());
+
+    std::function<void(size_t, const std::filesystem::path&)> walk = [&](size_t worker, const std::filesystem::path& directory) {
+        ++counts.directories;
+        std::error_code ec;
+        std::filesystem::directory_iterator it(directory, std::filesystem::directory_options::skip_permission_denied, ec);
+        for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec))
+        {
+            const std::filesystem::directory_entry& entry = *it;
+            std::error_code entryError;
+            // linked directories are skipped, they can point back up the tree
+            if (entry.is_directory(entryError) && !entry.is_symlink(entryError))
+            {
+                pool.push(worker, [&walk, path = entry.path()](size_t self) { walk(self, path); });
+            } else if (entry.is_regular_file(entryError) && is_image_extension(entry.path().extension().string()))
+            {
+                // files are queued one by one so a single huge directory still spreads over every worker
+                pool.push(worker, [this, &perWorker, previous, entry](size_t self) { scan_file(entry, previous, perWorker[self]); });
+            }
+        }
+    };
+    pool.push(0, [&walk, this](size_t worker) { walk(worker, std::filesystem::path(root)); });
+    pool.run();
+
+    std::vector<scanned_file> files;
+    size_t total = 0;
+    for (const auto& results : perWorker) total += results.size();
+    files.reserve(total);
+    for (auto& results : perWorker)
+    {
+        std::ranges::move(results, std::back_inserter(files));
+    }
+    return files;
+}
+
+scan_stats import_scanner::stats() const
+{
+    return { counts.directories, counts.parsed, counts.unchanged, counts.skipped };
+}
+
+void import_scanner::scan_file(const std::filesystem::directory_entry& entry, const scan_index* previous, std::vector<scanned_file>& results)
+{
+    std::error_code ec;
+    scanned_file scanned;
+    scanned.path = entry.path().lexically_relative(root).generic_string();
+    scanned.size = entry.file_size(ec);
+    if (ec)
+    {
+        ++counts.skipped;
+        return;
+    }
+    scanned.modifiedTime = entry.last_write_time(ec).time_since_epoch().count();
+
+    if (previous)
+    {
+        std::optional<size_t> index = previous->find_file(scanned.path);
+        if (index)
+        {
+            scan_file_entry known = previous->file(*index);
+            if (known.size == scanned.size && known.modifiedTime == scanned.modifiedTime)
+            {
+                for (std::string_view key : previous->file_imports(*index)) scanned.imports.emplace_back(key);
+                for (std::string_view key : previous->file_exports(*index)) scanned.exports.emplace_back(key);
+                ++counts.unchanged;
+                results.push_back(std::move(scanned));
+                return;
+            }
+        }
+    }
+
+    mapped_file image;
+    if (!image.open(entry.path().string()) || !read_keys(image.bytes(), entry.path().filename().string(), scanned))
+    {
+        ++counts.skipped;
+        return;
+    }
+    ++counts.parsed;
+    results.push_back(std::move(scanned));
+}
+
+bool import_scanner::is_image_extension(const std::string& extension)
+{
+    static constexpr std::string_view EXTENSIONS[] = { ".exe", ".dll", ".sys", ".ocx", ".cpl", ".scr", ".drv", ".efi", ".mui", ".ax", ".tlb", ".winmd" };
+    return std::ranges::any_of(EXTENSIONS, [&extension](std::string_view known) { return util::equals_ignore_case(known, extension); });
+}
+
+bool import_scanner::read_keys(std::span<const uint8_t> image, const std::string& fileName, scanned_file& result)
+{
+    pe_reader reader(image);
+    if (!reader.parse()) return false;
+
+    for (const auto& import : reader.imports())
+    {
+        result.imports.push_back(scan_index::make_key(import.module, import.isOrdinal ? "#" + std::to_string(import.ordinal) : std::string(import.function)));
+    }
+
+    // exports are keyed by the file name, that is what importers resolve, the export directory's own name may be stale after a rename
+    for (const auto& exportEntry : reader.exports())
+    {
+        result.exports.push_back(scan_index::make_key(fileName, exportEntry.name.empty() ? "#" + std::to_string(exportEntry.ordinal) : std::string(exportEntry.name)));
+    }
+    return true;
+}
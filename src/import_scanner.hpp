@@ -0,0 +1,46 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include "scan_index.hpp"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+struct scan_stats {
+    size_t directories = 0;
+    size_t parsed = 0;    // read and walked this time
+    size_t unchanged = 0; // same size and mtime as in the previous index, carried over without reading
+    size_t skipped = 0;   // not a PE image or unreadable
+};
+
+// walks a directory tree on a work stealing pool and collects the imports and exports of every PE file in it
+// only the headers and the import/export directories are read, straight from a mapping of the file
+class import_scanner {
+public:
+    import_scanner(std::string root, size_t threadCount) : root(std::move(root)), threadCount(threadCount) {}
+
+    // files whose size and mtime match an entry of previous reuse its keys, pass nullptr for a full scan
+    [[nodiscard]] std::vector<scanned_file> scan(const scan_index* previous);
+    [[nodiscard]] scan_stats stats() const;
+
+    // .exe, .dll, .sys and the other extensions the loader maps as images
+    [[nodiscard]] static bool is_image_extension(const std::string& extension);
+    // false when the bytes aren't a PE image
+    [[nodiscard]] static bool read_keys(std::span<const uint8_t> image, const std::string& fileName, scanned_file& result);
+
+private:
+    struct counters {
+        std::atomic<size_t> directories = 0;
+        std::atomic<size_t> parsed = 0;
+        std::atomic<size_t> unchanged = 0;
+        std::atomic<size_t> skipped = 0;
+    };
+
+    void scan_file(const std::filesystem::directory_entry& entry, const scan_index* previous, std::vector<scanned_file>& results);
+
+    std::string root;
+    size_t threadCount;
+    counters counts;
+};
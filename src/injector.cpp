@@ -0,0 +1,1963 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "injector.hpp"
+#include "hash.hpp"
+#include "thread_pool.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <deque>
+
+job_result injector::run(const injection_job& job, spdlog::logger& log, bool interactive, target_cache* targets)
+{
+    auto start = std::chrono::steady_clock::now();
+    job_result result;
+    profiler profile;
+    try
+    {
+        bool cached = !job.resultCache.empty() && takes_symbols(job.action);
+        profiler* phases = job.profile ? &profile : nullptr;
+        result = cached ? execute_cached(job, log, interactive, phases, targets) : execute(job, log, interactive, phases, targets);
+    }
+    catch (const std::exception& e)
+    {
+        log.critical("Unhandled exception: {}", e.what());
+        result = { false, std::string("exception: ") + e.what() };
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (job.profile)
+    {
+        if (job.format == "text")
+        {
+            profile.print(log);
+        } else
+        {
+            // stdout may be carrying records, the profile goes to stderr as a single json line
+            output_writer out(4096);
+            out.attach(stderr);
+            profile.write_json(out);
+        }
+    }
+    return result;
+}
+
+job_result injector::execute_cached(const injection_job& job, spdlog::logger& log, bool interactive, profiler* profile, target_cache* targets)
+{
+    // anything execute() would reject is left to it, so it reports the problem
+    if (job.symbols.empty() || !util::file_exists(job.target)) return execute(job, log, interactive, profile, targets);
+    std::string saveTarget = job.save.empty() ? default_save_path(job.target) : job.save;
+
+    result_cache cache(job.resultCache, job.resultCacheBytes, job.resultCacheAge);
+    std::string key;
+    bool hit = false;
+    std::string method;
+    {
+        profiler::scope phase(profile, "cache lookup");
+        mapped_file image;
+        if (image.open(job.target)) key = result_cache::key(image.bytes(), describe_inputs(job));
+        // the mapping is gone before the fetch, which may replace the target itself
+        image.close();
+        hit = !key.empty() && cache.fetch(key, saveTarget, method);
+    }
+    if (hit)
+    {
+        log.info("Reused the cached output ({}), saved to: {}", method, saveTarget);
+        return { true, "reused cached output" };
+    }
+    if (cache.corrupted()) log.warn("Dropped a damaged result cache entry ({})", cache.error());
+    else if (!cache.error().empty()) log.warn("Couldn't reuse the cached output ({})", cache.error());
+
+    job_result result = execute(job, log, interactive, profile, targets);
+    if (result.success && !key.empty())
+    {
+        profiler::scope phase(profile, "cache store");
+        if (!cache.store(key, saveTarget)) log.warn("Couldn't store the output in the result cache ({})", cache.error());
+        cache.evict();
+    }
+    return result;
+}
+
+std::string injector::describe_inputs(const injection_job& job)
+{
+    std::string text = job.action + "\n";
+    text += fmt::format("force={} rebuild={} delay={} ordinal={} parse={}\n", job.force, job.rebuild, job.delayLoad, job.byOrdinal, job.parseProfile);
+    for (const auto& symbol : job.symbols)
+    {
+        text += symbol + "\n";
+        // the DLL's export names, ordinals and hints are what the patcher reads from it, not its code
+        std::string dllPath = util::split_string_once(symbol, "::").first;
+        mapped_file dll;
+        bool opened = dll.open(dllPath);
+        pe_reader reader(dll.bytes());
+        if (opened && reader.parse())
+        {
+            uint64_t exportHash = 0;
+            for (const auto& entry : reader.exports())
+            {
+                exportHash = hash::xxh64(entry.name.data(), entry.name.size(), exportHash);
+                uint32_t numbers[2] = { entry.ordinal, entry.hint };
+                exportHash = hash::xxh64(numbers, sizeof(numbers), exportHash);
+            }
+            text += "exports " + hash::to_hex(exportHash) + "\n";
+        } else
+        {
+            text += "unreadable\n";
+        }
+    }
+    return text;
+}
+
+bool injector::is_valid_action(const std::string& action)
+{
+    return action == "add" || action == "remove" || action == "list" || action == "rehint" || action == "bind" || action == "checksum" || action == "scan" || action == "query" || action == "deps" || action == "resolve" || action == "diff";
+}
+
+bool injector::takes_symbols(const std::string& action)
+{
+    return action == "add" || action == "remove";
+}
+
+bool injector::is_valid_format(const std::string& format)
+{
+    return format == "text" || format == "json" || format == "tsv";
+}
+
+bool injector::parse_thread_count(const std::string& text, size_t& threads)
+{
+    // from_chars alone would take the digits of "8x", stoul would wrap "-1" to SIZE_MAX
+    if (text.empty() || !std::ranges::all_of(text, [](unsigned char c) { return std::isdigit(c) != 0; })) return false;
+    uint64_t value = 0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec == std::errc::result_out_of_range) value = UINT64_MAX;
+    else if (ec != std::errc()) return false;
+    if (value == 0) return false;
+    threads = static_cast<size_t>(std::min<uint64_t>(value, 4 * thread_pool::default_thread_count()));
+    return true;
+}
+
+std::string injector::default_save_path(const std::string& target)
+{
+    // next to the target with the platform's separator, a name without an extension just gets the suffix
+    std::filesystem::path path(target);
+    return (path.parent_path() / (path.stem().string() + "_modified" + path.extension().string())).string();
+}
+
+job_result injector::execute(const injection_job& job, spdlog::logger& log, bool interactive, profiler* profile, target_cache* targets)
+{
+    const std::string& action = job.action;
+    if (!is_valid_action(action))
+    {
+        log.critical("Invalid action specified! Use 'add', 'remove', 'list', 'resolve', 'diff', 'rehint', 'bind', 'checksum', 'deps', 'scan' or 'query'.");
+        return { false, "invalid action" };
+    }
+
+    const std::string& target = job.target;
+    if (!util::file_exists(target))
+    {
+        log.critical("The target file you specified does not exist!");
+        return { false, "target does not exist" };
+    }
+
+    // these work on a whole directory tree, not on a single image
+    if (action == "scan" || action == "query") return scan_tree(job, log, profile);
+    // only reads the target and what it loads, no lock needed
+    if (action == "deps") return resolve_dependencies(job, log, profile);
+    if (action == "resolve") return resolve_slots(job, log, profile);
+    if (action == "diff") return diff_images(job, log, profile);
+
+    bool locked;
+    {
+        profiler::scope phase(profile, "lock check");
+        locked = util::is_file_locked(target);
+    }
+    if (locked)
+    {
+        log.critical("The target file is locked! Please close any applications that may be using it.");
+        return { false, "target is locked" };
+    }
+
+    std::string targetFilename = std::filesystem::path(target).filename().string();
+
+    // everything that only depends on the arguments is checked before any heavy work starts
+    std::string saveTarget;
+    std::vector<import_symbol> symbols;
+    if (action != "list")
+    {
+        if (takes_symbols(action) && job.symbols.empty())
+        {
+            log.error("No symbol specified! Use --symbol:DLL_PATH::FUNCTION_NAME to specify the DLL and function!!");
+            return { false, "no symbol specified" };
+        }
+
+        saveTarget = job.save;
+        if (saveTarget.empty())
+        {
+            saveTarget = default_save_path(target);
+            log.warn("No save path specified! Defaulting to: {}", saveTarget);
+        } else {
+            std::string saveFileDir = std::filesystem::path(saveTarget).parent_path().string();
+            if (!saveFileDir.empty() && !util::file_exists(saveFileDir))
+            {
+                log.error("The specified save directory does not exist!");
+                return { false, "save directory does not exist" };
+            }
+            log.info("Saving to: {}", saveTarget);
+        }
+
+        if (job.delayLoad && job.rebuild)
+        {
+            log.error("--delay-load can't be combined with --rebuild, LIEF doesn't write delay-load descriptors.");
+            return { false, "delay-load needs the in-place patcher" };
+        }
+
+        if (takes_symbols(action) && !parse_symbols(job.symbols, symbols, log))
+        {
+            log.error("Invalid DLL and function format! Use 'DLL_PATH::FUNCTION_NAME'.");
+            return { false, "invalid symbol format" };
+        }
+    }
+
+    bool showProgress = interactive;
+
+    if (showProgress)
+    {
+        util::clear_current_console_line();
+        util::write("Reading target file: " + targetFilename + "\r");
+    }
+
+    // the mapping stays alive for the whole job, the parser reads straight out of it
+    // a server's cached copy stands in for the mapping as long as the file didn't change
+    mapped_file image;
+    parsed_target* cached = nullptr;
+    bool opened;
+    {
+        profiler::scope phase(profile, "read");
+        cached = targets ? targets->acquire(target) : nullptr;
+        if (cached) image.borrow(cached->bytes);
+        opened = cached || image.open(target);
+    }
+    if (!opened)
+    {
+        if (showProgress) util::clear_current_console_line();
+        log.critical("Failed to read the target file! ({})", image.error());
+        return { false, "failed to read target: " + image.error() };
+    }
+
+    // the headers are all the signature check needs, it runs on the mapping before the full parse
+    pe_reader reader(image.bytes());
+    bool signedTarget;
+    {
+        profiler::scope phase(profile, "signature");
+        signedTarget = reader.parse() && authenticode::has_signature(reader);
+    }
+    if (signedTarget)
+    {
+        if (showProgress) util::clear_current_console_line();
+        if (action == "list")
+        {
+            log.info("The target file is signed.");
+        } else
+        {
+            log.warn("THE TARGET FILE IS SIGNED!");
+            log.warn("Signature present, and this edit will invalidate it.");
+            log.warn("We are NOT responsible for any issues that may arise from this.");
+            log.warn("\033[31mTHIS WILL MAKE THE FILE UNSIGNED OR FAIL TO LOAD.\033[0m");
+        }
+    }
+
+    // the DLL validation and the digest don't need the parsed target, they run next to the parse and join before the edit
+    // a failure on either side raises stop so the other side bails out at its next check
+    // the futures are declared after everything they reference, so an early return waits for them before tearing it down
+    std::atomic<bool> stop = false;
+    std::future<export_validation> validation;
+    if (action == "add" && !job.force)
+    {
+        validation = std::async(std::launch::async, [&job, &symbols, &stop, profile] { return validate_exports(job, symbols, stop, profile); });
+    }
+    std::future<signature_check> verification;
+    if (job.verifySignature)
+    {
+        verification = std::async(std::launch::async, [&reader, profile] {
+            profiler::scope phase(profile, "verify");
+            return authenticode::verify(reader);
+        });
+    }
+
+    // hints, bindings and the checksum are fixed in the mapped image, LIEF isn't needed
+    if (action == "rehint")
+    {
+        if (verification.valid()) report_signature(verification.get(), log);
+        return rehint_imports(job, reader, image, saveTarget, log, profile);
+    }
+    if (action == "bind")
+    {
+        if (verification.valid()) report_signature(verification.get(), log);
+        return bind_imports(job, image, saveTarget, log, profile);
+    }
+    if (action == "checksum")
+    {
+        if (verification.valid()) report_signature(verification.get(), log);
+        return checksum_image(job, reader, image, saveTarget, log, profile);
+    }
+
+    if (showProgress)
+    {
+        util::clear_current_console_line();
+        util::write("Parsing target file: " + targetFilename + "\r");
+    }
+
+    // LIEF can't be interrupted mid-parse, a failed validation only stops the work after it
+    // a cached parse is reused when it covers the profile, edits through LIEF reset it so it never carries one
+    std::unique_ptr<LIEF::PE::Binary> parsedBinary;
+    import_index parsedImports;
+    std::unique_ptr<LIEF::PE::Binary>& binary = cached ? cached->binary : parsedBinary;
+    import_index& imports = cached ? cached->imports : parsedImports;
+    LIEF::PE::ParserConfig parseConfig = parse_profile::resolve(job.parseProfile, action, job.rebuild);
+    bool reused = cached && cached->binary && parse_profile::covers(cached->config, parseConfig);
+    if (!reused)
+    {
+        profiler::scope phase(profile, "parse");
+        log.debug("Parsing {} of the target", parse_profile::describe(parseConfig));
+        binary = LIEF::PE::Parser::parse(std::make_unique<LIEF::SpanStream>(image.data(), static_cast<size_t>(image.size())), parseConfig);
+        if (cached) cached->config = parseConfig;
+    }
+    if (showProgress) util::clear_current_console_line();
+
+    if (!binary)
+    {
+        stop = true;
+        log.critical("Failed to parse the target file!");
+        return { false, "failed to parse target" };
+    }
+    // a rejected DLL fails the job before the target is ever looked at, the messages come out of add_imports
+    // a cached parse always gets its index, the next job may need it
+    if (!reused && (!stop || cached))
+    {
+        profiler::scope phase(profile, "index");
+        imports.build(*binary);
+    }
+
+    if (verification.valid()) report_signature(verification.get(), log);
+
+    if (action == "list")
+    {
+        profiler::scope phase(profile, "list");
+        // read straight from the mapping, LIEF's export objects aren't needed to print names
+        std::vector<pe_export> exports = reader.exports();
+        std::vector<pe_import> delayImports = reader.delay_imports();
+        for (std::string_view module : reader.unnamed_import_modules())
+        {
+            log.warn("The functions imported from {} aren't available, it's bound and has no import lookup table", module);
+        }
+        if (job.format != "text") return write_listing(job, imports, delayImports, exports, log);
+
+        log.info("Imported functions:");
+        for (const auto& record : imports.records())
+        {
+            if (!record.isOrdinal)
+            {
+                log.info("  Import - {}::{} ({:X})", record.module, record.function, record.slotRva);
+            }
+        }
+        log.info(" The hex value after the import name is the RVA (Relative Virtual Address) of the import in the IAT (Import Address Table)");
+
+        if (!delayImports.empty())
+        {
+            log.info("Delay-load imported functions:");
+            for (const auto& entry : delayImports)
+            {
+                if (entry.isOrdinal) log.info("  Delay import - {}::#{} ({:X})", entry.module, entry.ordinal, entry.slotRva);
+                else log.info("  Delay import - {}::{} ({:X})", entry.module, entry.function, entry.slotRva);
+            }
+            log.info(" The hex value after a delay import is the RVA of its slot in the delay IAT, filled in on the first call");
+        }
+
+        log.info("Exported functions:");
+        for (const auto& exportEntry : exports)
+        {
+            if (exportEntry.name.empty()) log.info("  Export - {}::#{} ({:X})", targetFilename, exportEntry.ordinal, exportEntry.rva);
+            else log.info("  Export - {}::{} ({:X})", targetFilename, exportEntry.name, exportEntry.rva);
+        }
+        if (exports.empty())
+        {
+            log.info("  No exported functions found!");
+        }
+
+        return { true, "listed" };
+    }
+
+    if (action == "remove" && job.delayLoad) return remove_delay_imports(job, symbols, image, saveTarget, log, profile);
+    if (action == "remove") return remove_imports(job, symbols, image, binary, imports, saveTarget, log, profile);
+    return add_imports(job, symbols, image, binary, imports, saveTarget, log, profile, validation, stop);
+}
+
+job_result injector::diff_images(const injection_job& job, spdlog::logger& log, profiler* profile)
+{
+    if (job.baseline.empty())
+    {
+        log.error("No baseline specified! Use --baseline:PATH with the build the target is compared against.");
+        return { false, "no baseline specified" };
+    }
+    diff_image baseline;
+    bool opened;
+    {
+        profiler::scope phase(profile, "read");
+        opened = baseline.open(job.baseline);
+    }
+    if (!opened)
+    {
+        log.critical("Failed to read the baseline! ({})", baseline.error());
+        return { false, "failed to read baseline: " + baseline.error() };
+    }
+
+    // a directory compares every image under it against the same baseline
+    std::vector<std::string> candidates;
+    bool directory = std::filesystem::is_directory(job.target);
+    if (directory)
+    {
+        profiler::scope phase(profile, "walk");
+        std::error_code ec;
+        std::filesystem::recursive_directory_iterator it(job.target, std::filesystem::directory_options::skip_permission_denied, ec);
+        for (; !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+        {
+            std::error_code entryError;
+            if (!it->is_regular_file(entryError) || !import_scanner::is_image_extension(it->path().extension().string())) continue;
+            if (std::filesystem::equivalent(it->path(), job.baseline, entryError)) continue;
+            candidates.push_back(it->path().string());
+        }
+        std::ranges::sort(candidates);
+    } else
+    {
+        candidates.push_back(job.target);
+    }
+
+    output_writer out;
+    if (!out.open(job.output))
+    {
+        log.critical("Failed to open the output! ({})", out.error());
+        return { false, "failed to open output" };
+    }
+
+    // one record per change: change, kind, module, function and the old and new ordinal, hint, rva and forwarder
+    // imports carry the rva of their IAT slot, exports the rva they point at, missing values are null in json and empty in tsv
+    bool json = job.format == "json";
+    bool tsv = job.format == "tsv";
+    if (json)
+    {
+        out.write("{\"baseline\":");
+        out.write_json_string(job.baseline);
+        out.write(",\"candidates\":[");
+    } else if (tsv)
+    {
+        out.write("target\tchange\tkind\tmodule\tfunction\told_ordinal\tnew_ordinal\told_hint\tnew_hint\told_rva\tnew_rva\told_forwarder\tnew_forwarder\n");
+    }
+
+    auto has_ordinal = [](const diff_entry* entry) { return entry && (entry->byOrdinal || entry->table == diff_table::exports); };
+    auto has_hint = [](const diff_entry* entry) { return entry && !entry->byOrdinal; };
+    auto has_forwarder = [](const diff_entry* entry) { return entry && !entry->forwarder.empty(); };
+    auto write_change = [&](const diff_change& change, bool first) {
+        const diff_entry& key = change.after ? *change.after : *change.before;
+        std::string_view kind = diff_image::table_name(key.table);
+        std::string_view type = diff_image::change_name(change.type);
+        if (json)
+        {
+            auto json_uint = [&out](bool present, uint64_t value) {
+                if (present) out.write_uint(value);
+                else out.write("null");
+            };
+            auto json_string = [&out](bool present, std::string_view value) {
+                if (present) out.write_json_string(value);
+                else out.write("null");
+            };
+            out.write(first ? "\n{\"change\":\"" : ",\n{\"change\":\"");
+            out.write(type);
+            out.write("\",\"kind\":\"");
+            out.write(kind);
+            out.write("\",\"module\":");
+            json_string(!key.module.empty(), key.module);
+            out.write(",\"function\":");
+            json_string(!key.byOrdinal, key.function);
+            out.write(",\"old_ordinal\":");
+            json_uint(has_ordinal(change.before), change.before ? change.before->ordinal : 0);
+            out.write(",\"new_ordinal\":");
+            json_uint(has_ordinal(change.after), change.after ? change.after->ordinal : 0);
+            out.write(",\"old_hint\":");
+            json_uint(has_hint(change.before), change.before ? change.before->hint : 0);
+            out.write(",\"new_hint\":");
+            json_uint(has_hint(change.after), change.after ? change.after->hint : 0);
+            out.write(",\"old_rva\":");
+            json_uint(change.before, change.before ? change.before->rva : 0);
+            out.write(",\"new_rva\":");
+            json_uint(change.after, change.after ? change.after->rva : 0);
+            out.write(",\"old_forwarder\":");
+            json_string(has_forwarder(change.before), change.before ? change.before->forwarder : std::string_view());
+            out.write(",\"new_forwarder\":");
+            json_string(has_forwarder(change.after), change.after ? change.after->forwarder : std::string_view());
+            out.write('}');
+        } else if (tsv)
+        {
+            auto tsv_uint = [&out](bool present, uint64_t value) {
+                out.write('\t');
+                if (present) out.write_uint(value);
+            };
+            out.write('\t');
+            out.write(type);
+            out.write('\t');
+            out.write(kind);
+            out.write('\t');
+            out.write_tsv_field(key.module);
+            out.write('\t');
+            out.write_tsv_field(key.function);
+            tsv_uint(has_ordinal(change.before), change.before ? change.before->ordinal : 0);
+            tsv_uint(has_ordinal(change.after), change.after ? change.after->ordinal : 0);
+            tsv_uint(has_hint(change.before), change.before ? change.before->hint : 0);
+            tsv_uint(has_hint(change.after), change.after ? change.after->hint : 0);
+            tsv_uint(change.before, change.before ? change.before->rva : 0);
+            tsv_uint(change.after, change.after ? change.after->rva : 0);
+            out.write('\t');
+            if (change.before) out.write_tsv_field(change.before->forwarder);
+            out.write('\t');
+            if (change.after) out.write_tsv_field(change.after->forwarder);
+            out.write('\n');
+        } else
+        {
+            std::string name = key.byOrdinal ? "#" + std::to_string(key.ordinal) : std::string(key.function);
+            std::string symbol = key.module.empty() ? name : std::string(key.module) + "::" + name;
+            std::string_view place = key.table == diff_table::exports ? "rva" : "slot";
+            if (change.type != diff_change_type::changed)
+            {
+                out.write(fmt::format("{} {} {} {} 0x{:X}\n", change.type == diff_change_type::added ? '+' : '-', kind, symbol, place, key.rva));
+                return;
+            }
+            const diff_entry& a = *change.before;
+            const diff_entry& b = *change.after;
+            std::string details;
+            auto detail = [&details](std::string_view field, const std::string& before, const std::string& after) {
+                if (before == after) return;
+                details += details.empty() ? "" : ", ";
+                details += fmt::format("{} {} -> {}", field, before, after);
+            };
+            detail(place, fmt::format("0x{:X}", a.rva), fmt::format("0x{:X}", b.rva));
+            if (has_ordinal(&a)) detail("ordinal", std::to_string(a.ordinal), std::to_string(b.ordinal));
+            if (has_hint(&a)) detail("hint", std::to_string(a.hint), std::to_string(b.hint));
+            detail("forwarder", a.forwarder.empty() ? "none" : std::string(a.forwarder), b.forwarder.empty() ? "none" : std::string(b.forwarder));
+            out.write(fmt::format("~ {} {} {}\n", kind, symbol, details));
+        }
+    };
+
+    // candidates are read and joined on the pool and written in order as they finish, the window keeps the number
+    // of open mappings bounded on a large tree
+    size_t threadCount = std::min(job.threads == 0 ? thread_pool::default_thread_count() : job.threads, std::max<size_t>(candidates.size(), 1));
+    if (directory) log.info("Comparing {} images under {} with {} on {} threads", candidates.size(), job.target, job.baseline, threadCount);
+    thread_pool pool(threadCount);
+    std::deque<std::future<diff_outcome>> pending;
+    size_t submitted = 0;
+    auto submit_next = [&]() {
+        std::string path = candidates[submitted++];
+        pending.push_back(pool.submit([&baseline, path = std::move(path)]() {
+            diff_outcome outcome;
+            outcome.path = path;
+            outcome.readable = outcome.image.open(path);
+            if (outcome.readable) outcome.changes = diff_image::compare(baseline, outcome.image);
+            return outcome;
+        }));
+    };
+
+    size_t changedCandidates = 0;
+    size_t unreadable = 0;
+    size_t totals[3] = {};
+    {
+        profiler::scope phase(profile, "diff");
+        while (submitted < candidates.size() && submitted < threadCount * 4) submit_next();
+        for (size_t index = 0; index < candidates.size(); ++index)
+        {
+            diff_outcome outcome = pending.front().get();
+            pending.pop_front();
+            if (submitted < candidates.size()) submit_next();
+
+            size_t counts[3] = {};
+            for (const auto& change : outcome.changes) ++counts[static_cast<size_t>(change.type)];
+            if (!outcome.readable)
+            {
+                ++unreadable;
+                log.warn("Failed to read {}! ({})", outcome.path, outcome.image.error());
+            } else if (!outcome.changes.empty())
+            {
+                ++changedCandidates;
+            }
+            for (size_t i = 0; i < 3; ++i) totals[i] += counts[i];
+
+            if (json)
+            {
+                out.write(index == 0 ? "\n{\"target\":" : ",\n{\"target\":");
+                out.write_json_string(outcome.path);
+                if (!outcome.readable)
+                {
+                    out.write(",\"error\":");
+                    out.write_json_string(outcome.image.error());
+                    out.write('}');
+                    continue;
+                }
+                out.write(fmt::format(",\"added\":{},\"removed\":{},\"changed\":{},\"records\":[", counts[0], counts[1], counts[2]));
+            } else if (!tsv)
+            {
+                if (!outcome.readable) continue;
+                out.write(fmt::format("{}: {} added, {} removed, {} changed\n", outcome.path, counts[0], counts[1], counts[2]));
+            }
+            for (size_t i = 0; i < outcome.changes.size(); ++i)
+            {
+                if (tsv) out.write_tsv_field(outcome.path);
+                write_change(outcome.changes[i], i == 0);
+            }
+            if (json) out.write(outcome.changes.empty() ? "]}" : "\n]}");
+        }
+    }
+
+    if (json) out.write(candidates.empty() ? "]}\n" : "\n]}\n");
+    if (!out.close())
+    {
+        log.critical("Failed to write the output! ({})", out.error());
+        return { false, "failed to write output" };
+    }
+
+    if (!directory)
+    {
+        if (unreadable != 0) return { false, "failed to read target" };
+        log.info("{} added, {} removed, {} changed", totals[0], totals[1], totals[2]);
+        return { true, fmt::format("{} added, {} removed, {} changed", totals[0], totals[1], totals[2]) };
+    }
+    log.info("Compared {} images: {} differ from the baseline, {} unreadable", candidates.size(), changedCandidates, unreadable);
+    return { true, fmt::format("compared {} images, {} differ", candidates.size(), changedCandidates) };
+}
+
+job_result injector::resolve_slots(const injection_job& job, spdlog::logger& log, profiler* profile)
+{
+    // one read and one index, every query after that is a hash lookup
+    session image;
+    bool opened;
+    {
+        profiler::scope phase(profile, "read");
+        opened = image.open(job.target);
+    }
+    if (!opened)
+    {
+        log.critical("Failed to read the target file! ({})", image.error());
+        return { false, "failed to read target: " + image.error() };
+    }
+
+    // --symbol values are answered first, then the query file or stdin
+    std::ifstream file;
+    std::istream* input = nullptr;
+    bool fromStdin = job.queries == "-" || (job.queries.empty() && job.symbols.empty());
+    if (fromStdin)
+    {
+        input = &std::cin;
+    } else if (!job.queries.empty())
+    {
+        file.open(job.queries);
+        if (!file.is_open())
+        {
+            log.critical("Failed to open the query file: {}", job.queries);
+            return { false, "failed to open queries" };
+        }
+        input = &file;
+    }
+
+    output_writer out;
+    if (!out.open(job.output))
+    {
+        log.critical("Failed to open the output! ({})", out.error());
+        return { false, "failed to open output" };
+    }
+
+    // one record per query: the slot's rva and width, the hint of a named import, the ordinal of one by ordinal
+    // imports are searched before delay imports, missing values are null in json and empty in tsv
+    bool json = job.format == "json";
+    bool tsv = job.format == "tsv";
+    if (json)
+    {
+        out.write("{\"target\":");
+        out.write_json_string(job.target);
+        out.write(",\"records\":[");
+    } else if (tsv)
+    {
+        out.write("query\tkind\trva\twidth\thint\tordinal\n");
+    }
+
+    uint32_t width = image.is_pe32_plus() ? 8 : 4;
+    size_t total = 0;
+    size_t found = 0;
+    auto resolve = [&](std::string_view query) {
+        auto [module, function] = util::split_string_once(std::string(query), "::");
+        const pe_import* entry = nullptr;
+        bool delay = false;
+        if (!module.empty() && !function.empty())
+        {
+            entry = image.find_import(module, function);
+            if (!entry)
+            {
+                entry = image.find_import(module, function, true);
+                delay = entry != nullptr;
+            }
+        }
+        std::string_view kind = !entry ? "not-found" : delay ? "delay-import" : "import";
+        if (json)
+        {
+            out.write(total == 0 ? "\n{\"query\":" : ",\n{\"query\":");
+            out.write_json_string(query);
+            out.write(",\"kind\":\"");
+            out.write(kind);
+            out.write('"');
+            if (entry)
+            {
+                out.write(",\"rva\":");
+                out.write_uint(entry->slotRva);
+                out.write(",\"width\":");
+                out.write_uint(width);
+                out.write(",\"hint\":");
+                if (entry->isOrdinal) out.write("null");
+                else out.write_uint(entry->hint);
+                out.write(",\"ordinal\":");
+                if (entry->isOrdinal) out.write_uint(entry->ordinal);
+                else out.write("null");
+            }
+            out.write('}');
+        } else if (tsv)
+        {
+            out.write_tsv_field(query);
+            out.write('\t');
+            out.write(kind);
+            out.write('\t');
+            if (entry)
+            {
+                out.write_uint(entry->slotRva);
+                out.write('\t');
+                out.write_uint(width);
+                out.write('\t');
+                if (!entry->isOrdinal) out.write_uint(entry->hint);
+                out.write('\t');
+                if (entry->isOrdinal) out.write_uint(entry->ordinal);
+            } else
+            {
+                out.write("\t\t\t");
+            }
+            out.write('\n');
+        } else if (entry)
+        {
+            out.write(fmt::format("{} {} 0x{:X} ({} bytes, {} {})\n", query, kind, entry->slotRva, width,
+                entry->isOrdinal ? "ordinal" : "hint", entry->isOrdinal ? entry->ordinal : entry->hint));
+        } else
+        {
+            out.write(query);
+            out.write(" not found\n");
+        }
+        ++total;
+        if (entry) ++found;
+    };
+
+    {
+        profiler::scope phase(profile, "resolve");
+        for (const auto& symbol : job.symbols) resolve(symbol);
+        if (input)
+        {
+            std::string line;
+            while (std::getline(*input, line))
+            {
+                line = util::trim_string(line);
+                if (line.empty() || line.front() == '#') continue;
+                resolve(line);
+                // a client on the other end of a pipe waits for each answer, a file is written in big chunks
+                if (fromStdin && !out.flush()) break;
+            }
+        }
+    }
+
+    if (json) out.write("\n]}\n");
+    if (!out.close())
+    {
+        log.critical("Failed to write the output! ({})", out.error());
+        return { false, "failed to write output" };
+    }
+    log.info("Resolved {} of {} queries", found, total);
+    return { true, "resolved " + std::to_string(found) + " of " + std::to_string(total) };
+}
+
+job_result injector::resolve_dependencies(const injection_job& job, spdlog::logger& log, profiler* profile)
+{
+    dependency_resolver resolver(job.searchPaths);
+    {
+        profiler::scope phase(profile, "resolve");
+        if (!resolver.resolve(job.target))
+        {
+            log.critical("Failed to read the target file! ({})", resolver.error());
+            return { false, "failed to read target" };
+        }
+    }
+
+    const std::vector<dependency_module>& modules = resolver.modules();
+    size_t missingModules = resolver.missing_module_count();
+    const std::vector<missing_export>& missingExports = resolver.missing_exports();
+    auto importers_of = [&modules](const dependency_module& module) {
+        std::string names;
+        for (size_t importer : module.importedBy)
+        {
+            if (!names.empty()) names += ", ";
+            names += modules[importer].name;
+        }
+        return names;
+    };
+
+    if (job.format == "text")
+    {
+        // grouped by depth, the target's direct imports first
+        std::vector<size_t> order(modules.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::ranges::stable_sort(order, {}, [&modules](size_t index) { return modules[index].depth; });
+
+        log.info("Dependencies of {}:", modules.front().name);
+        for (size_t index : order)
+        {
+            if (index == 0) continue;
+            const dependency_module& module = modules[index];
+            if (module.apiSet) log.info("  [{}] {} (api set)", module.depth, module.name);
+            else if (!module.path.empty()) log.info("  [{}] {} ({})", module.depth, module.name, module.path);
+        }
+        for (const auto& module : modules)
+        {
+            if (module.path.empty() && !module.apiSet) log.error("Missing module: {} (imported by {})", module.name, importers_of(module));
+        }
+        for (const auto& missing : missingExports)
+        {
+            log.error("Missing export: {}::{} (imported by {})", modules[missing.module].name, missing.function, modules[missing.importer].name);
+        }
+        log.info("{} modules, {} missing, {} missing exports", modules.size() - 1, missingModules, missingExports.size());
+        if (missingModules != 0)
+        {
+            log.info("TIP: Modules are searched in the target's directory, the --search-path directories and the system directories, in that order.");
+        }
+    } else
+    {
+        output_writer out;
+        if (!out.open(job.output))
+        {
+            log.critical("Failed to open the output! ({})", out.error());
+            return { false, "failed to open output" };
+        }
+
+        // one record per module and per missing export: kind, module, function, path, importer, depth
+        // kind is module, api-set, missing-module or missing-export
+        bool json = job.format == "json";
+        if (json)
+        {
+            out.write("{\"target\":");
+            out.write_json_string(job.target);
+            out.write(",\"records\":[");
+        } else
+        {
+            out.write("kind\tmodule\tfunction\tpath\timporter\tdepth\n");
+        }
+        bool first = true;
+        auto record = [&](std::string_view kind, const dependency_module& module, std::string_view function, std::string_view importer) {
+            if (json)
+            {
+                out.write(first ? "\n{\"kind\":\"" : ",\n{\"kind\":\"");
+                out.write(kind);
+                out.write("\",\"module\":");
+                out.write_json_string(module.name);
+                out.write(",\"function\":");
+                if (function.empty()) out.write("null");
+                else out.write_json_string(function);
+                out.write(",\"path\":");
+                if (module.path.empty()) out.write("null");
+                else out.write_json_string(module.path);
+                out.write(",\"importer\":");
+                out.write_json_string(importer);
+                out.write(",\"depth\":");
+                out.write_uint(module.depth);
+                out.write('}');
+            } else
+            {
+                out.write(kind);
+                out.write('\t');
+                out.write_tsv_field(module.name);
+                out.write('\t');
+                out.write_tsv_field(function);
+                out.write('\t');
+                out.write_tsv_field(module.path);
+                out.write('\t');
+                out.write_tsv_field(importer);
+                out.write('\t');
+                out.write_uint(module.depth);
+                out.write('\n');
+            }
+            first = false;
+        };
+
+        for (size_t i = 1; i < modules.size(); ++i)
+        {
+            const dependency_module& module = modules[i];
+            std::string_view kind = module.apiSet ? "api-set" : module.path.empty() ? "missing-module" : "module";
+            record(kind, module, {}, modules[module.importedBy.front()].name);
+        }
+        for (const auto& missing : missingExports)
+        {
+            record("missing-export", modules[missing.module], missing.function, modules[missing.importer].name);
+        }
+
+        if (json) out.write(first ? "]}\n" : "\n]}\n");
+        if (!out.close())
+        {
+            log.critical("Failed to write the dependencies! ({})", out.error());
+            return { false, "failed to write output" };
+        }
+    }
+
+    bool complete = missingModules == 0 && missingExports.empty();
+    return { complete, std::to_string(modules.size() - 1) + " modules, " + std::to_string(missingModules) + " missing, "
+        + std::to_string(missingExports.size()) + " missing exports" };
+}
+
+job_result injector::scan_tree(const injection_job& job, spdlog::logger& log, profiler* profile)
+{
+    if (!std::filesystem::is_directory(job.target))
+    {
+        log.critical("The target of --action:{} has to be a directory!", job.action);
+        return { false, "target is not a directory" };
+    }
+    std::error_code ec;
+    std::string root = std::filesystem::weakly_canonical(job.target, ec).string();
+    if (ec) root = std::filesystem::absolute(job.target).string();
+    std::string indexPath = job.index.empty() ? scan_index::default_path(root) : job.index;
+
+    if (job.action == "query") return query_index(job, indexPath, log, profile);
+
+    // the previous index stays mapped during the walk, files with the same size and mtime are copied out of it
+    scan_index previous;
+    bool incremental = false;
+    if (!job.force && util::file_exists(indexPath))
+    {
+        profiler::scope phase(profile, "read");
+        incremental = previous.open(indexPath) && previous.root() == root;
+        if (!incremental)
+        {
+            log.warn("Ignoring the existing index at {} ({}), doing a full scan", indexPath, previous.error().empty() ? "it belongs to another directory" : previous.error());
+        }
+    }
+
+    size_t threadCount = job.threads == 0 ? thread_pool::default_thread_count() : job.threads;
+    log.info("Scanning {} on {} threads{}", root, threadCount, incremental ? ", unchanged files are taken from the last scan" : "");
+    import_scanner scanner(root, threadCount);
+    std::vector<scanned_file> files;
+    {
+        profiler::scope phase(profile, "scan");
+        files = scanner.scan(incremental ? &previous : nullptr);
+    }
+    std::vector<uint8_t> data;
+    {
+        profiler::scope phase(profile, "index");
+        data = scan_index::serialize(root, std::move(files));
+    }
+    // windows won't replace a file that is still mapped
+    previous.close();
+
+    std::string error;
+    {
+        profiler::scope phase(profile, "write");
+        if (!scan_index::write(indexPath, data, error))
+        {
+            log.critical("Failed to write the index! ({})", error);
+            return { false, "failed to write index" };
+        }
+    }
+
+    scan_stats stats = scanner.stats();
+    log.info("Scanned {} directories: {} files parsed, {} unchanged, {} skipped", stats.directories, stats.parsed, stats.unchanged, stats.skipped);
+    log.info("Index written to {} ({} bytes)", indexPath, data.size());
+    log.info("Query it with --action:query --target:{} --symbol:MODULE::FUNCTION", job.target.contains(" ") ? "\"" + job.target + "\"" : job.target);
+    return { true, "indexed " + std::to_string(stats.parsed + stats.unchanged) + " files" };
+}
+
+job_result injector::query_index(const injection_job& job, const std::string& indexPath, spdlog::logger& log, profiler* profile)
+{
+    if (job.symbols.empty())
+    {
+        log.error("No symbol specified! Use --symbol:MODULE::FUNCTION, or --symbol:MODULE for everything imported from a module.");
+        return { false, "no symbol specified" };
+    }
+
+    scan_index index;
+    {
+        profiler::scope phase(profile, "read");
+        if (!index.open(indexPath))
+        {
+            log.critical("Failed to open the index at {}! ({})", indexPath, index.error());
+            log.info("TIP: Build it first with --action:scan --target:{}", job.target.contains(" ") ? "\"" + job.target + "\"" : job.target);
+            return { false, "failed to open index" };
+        }
+    }
+
+    profiler::scope phase(profile, "query");
+    bool text = job.format == "text";
+    bool json = job.format == "json";
+    output_writer out;
+    if (!text)
+    {
+        if (!out.open(job.output))
+        {
+            log.critical("Failed to open the output! ({})", out.error());
+            return { false, "failed to open output" };
+        }
+        // one record per key and file: query, kind, module, function, file (relative to the root)
+        if (json)
+        {
+            out.write("{\"root\":");
+            out.write_json_string(index.root());
+            out.write(",\"records\":[");
+        } else
+        {
+            out.write("query\tkind\tmodule\tfunction\tfile\n");
+        }
+    }
+
+    bool first = true;
+    auto record = [&](std::string_view query, std::string_view kind, std::string_view key, uint32_t fileIndex) {
+        auto [module, function] = util::split_string_once(std::string(key), "::");
+        std::string_view path = fileIndex < index.file_count() ? index.file(fileIndex).path : std::string_view {};
+        if (json)
+        {
+            out.write(first ? "\n{\"query\":" : ",\n{\"query\":");
+            out.write_json_string(query);
+            out.write(",\"kind\":\"");
+            out.write(kind);
+            out.write("\",\"module\":");
+            out.write_json_string(module);
+            out.write(",\"function\":");
+            out.write_json_string(function);
+            out.write(",\"file\":");
+            out.write_json_string(path);
+            out.write('}');
+        } else
+        {
+            out.write_tsv_field(query);
+            out.write('\t');
+            out.write(kind);
+            out.write('\t');
+            out.write_tsv_field(module);
+            out.write('\t');
+            out.write_tsv_field(function);
+            out.write('\t');
+            out.write_tsv_field(path);
+            out.write('\n');
+        }
+        first = false;
+    };
+
+    if (text) log.info("Index of {} ({} files, {} keys)", index.root(), index.file_count(), index.key_count());
+    size_t matches = 0;
+    for (const auto& symbol : job.symbols)
+    {
+        // same DLL_PATH::FUNCTION_NAME form as add/remove, only the file name of the module counts
+        auto [dllPath, function] = util::split_string_once(symbol, "::");
+        std::string module = std::filesystem::path(dllPath).filename().string();
+        auto [firstKey, lastKey] = index.find_keys(module, function);
+        if (firstKey == lastKey)
+        {
+            if (text) log.warn("Nothing in the index imports or exports {}", symbol);
+            continue;
+        }
+
+        if (!text)
+        {
+            for (size_t key = firstKey; key < lastKey; ++key)
+            {
+                for (uint32_t fileIndex : index.importers(key)) record(symbol, "import", index.key(key), fileIndex);
+                for (uint32_t fileIndex : index.exporters(key)) record(symbol, "export", index.key(key), fileIndex);
+                ++matches;
+            }
+            continue;
+        }
+
+        // a whole module can span hundreds of functions, the files are listed once instead of once per function
+        std::vector<uint32_t> importers;
+        std::vector<uint32_t> exporters;
+        for (size_t key = firstKey; key < lastKey; ++key)
+        {
+            std::ranges::copy(index.importers(key), std::back_inserter(importers));
+            std::ranges::copy(index.exporters(key), std::back_inserter(exporters));
+            ++matches;
+        }
+        for (auto* files : { &importers, &exporters })
+        {
+            std::ranges::sort(*files);
+            files->erase(std::unique(files->begin(), files->end()), files->end());
+        }
+
+        log.info("{} is imported by {} file(s):", symbol, importers.size());
+        for (uint32_t fileIndex : importers)
+        {
+            if (fileIndex < index.file_count()) log.info("  {}", index.file(fileIndex).path);
+        }
+        if (!exporters.empty())
+        {
+            log.info("{} is exported by:", symbol);
+            for (uint32_t fileIndex : exporters)
+            {
+                if (fileIndex < index.file_count()) log.info("  {}", index.file(fileIndex).path);
+            }
+        }
+    }
+
+    if (!text)
+    {
+        if (json) out.write(first ? "]}\n" : "\n]}\n");
+        if (!out.close())
+        {
+            log.critical("Failed to write the query results! ({})", out.error());
+            return { false, "failed to write output" };
+        }
+    }
+    return { true, "matched " + std::to_string(matches) + " keys" };
+}
+
+job_result injector::write_listing(const injection_job& job, const import_index& imports, const std::vector<pe_import>& delayImports,
+    const std::vector<pe_export>& exports, spdlog::logger& log)
+{
+    output_writer out;
+    if (!out.open(job.output))
+    {
+        log.critical("Failed to open the output! ({})", out.error());
+        return { false, "failed to open output" };
+    }
+
+    // one record per import/export: kind, module, function, ordinal, hint, rva
+    // imports carry the rva of their IAT slot, delay imports the one in the delay IAT, exports the rva of the code or data they point at
+    // missing values are null in json and empty in tsv
+    std::string targetFilename = std::filesystem::path(job.target).filename().string();
+    bool json = job.format == "json";
+    if (json)
+    {
+        out.write("{\"target\":");
+        out.write_json_string(job.target);
+        out.write(",\"records\":[");
+    } else
+    {
+        out.write("kind\tmodule\tfunction\tordinal\thint\trva\n");
+    }
+
+    bool first = true;
+    auto record = [&](std::string_view kind, std::string_view module, std::string_view function, bool hasOrdinal, uint16_t ordinal, bool hasHint, uint32_t hint, uint32_t rva) {
+        if (json)
+        {
+            out.write(first ? "\n{\"kind\":\"" : ",\n{\"kind\":\"");
+            out.write(kind);
+            out.write("\",\"module\":");
+            out.write_json_string(module);
+            out.write(",\"function\":");
+            if (function.empty()) out.write("null");
+            else out.write_json_string(function);
+            out.write(",\"ordinal\":");
+            if (hasOrdinal) out.write_uint(ordinal);
+            else out.write("null");
+            out.write(",\"hint\":");
+            if (hasHint) out.write_uint(hint);
+            else out.write("null");
+            out.write(",\"rva\":");
+            out.write_uint(rva);
+            out.write('}');
+        } else
+        {
+            out.write(kind);
+            out.write('\t');
+            out.write_tsv_field(module);
+            out.write('\t');
+            out.write_tsv_field(function);
+            out.write('\t');
+            if (hasOrdinal) out.write_uint(ordinal);
+            out.write('\t');
+            if (hasHint) out.write_uint(hint);
+            out.write('\t');
+            out.write_uint(rva);
+            out.write('\n');
+        }
+        first = false;
+    };
+
+    for (const auto& entry : imports.records())
+    {
+        record("import", entry.module, entry.function, entry.isOrdinal, entry.ordinal, !entry.isOrdinal, entry.hint, entry.slotRva);
+    }
+    for (const auto& entry : delayImports)
+    {
+        record("delay-import", entry.module, entry.function, entry.isOrdinal, entry.ordinal, !entry.isOrdinal, entry.hint, entry.slotRva);
+    }
+    for (const auto& entry : exports)
+    {
+        record("export", targetFilename, entry.name, true, entry.ordinal, !entry.name.empty(), entry.hint, entry.rva);
+    }
+
+    if (json) out.write(first ? "]}\n" : "\n]}\n");
+    if (!out.close())
+    {
+        log.critical("Failed to write the listing! ({})", out.error());
+        return { false, "failed to write output" };
+    }
+    return { true, "listed " + std::to_string(imports.records().size() + delayImports.size()) + " imports and " + std::to_string(exports.size()) + " exports" };
+}
+
+void injector::report_signature(const signature_check& check, spdlog::logger& log)
+{
+    switch (check.status)
+    {
+    case signature_status::unsigned_image:
+        log.info("Signature: the target file isn't signed");
+        break;
+    case signature_status::intact:
+        log.info("Signature: the {} authenticode digest matches the image", check.algorithm);
+        break;
+    case signature_status::modified:
+        log.warn("Signature: the {} authenticode digest does NOT match, the image was changed after signing", check.algorithm);
+        break;
+    case signature_status::unsupported:
+        log.warn("Signature: couldn't check the digest ({})", check.details);
+        break;
+    }
+}
+
+bool injector::read_symbols_file(const std::string& path, std::vector<std::string>& symbols)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        line = util::trim_string(line);
+        if (line.empty() || line.front() == '#') continue;
+        symbols.push_back(line);
+    }
+    return true;
+}
+
+bool injector::parse_symbols(const std::vector<std::string>& input, std::vector<import_symbol>& symbols, spdlog::logger& log)
+{
+    bool ok = true;
+    symbols.reserve(input.size());
+    for (const auto& symbol : input)
+    {
+        auto dllAndFunction = util::split_string_once(symbol, "::");
+        import_symbol parsed;
+        parsed.dllPath = dllAndFunction.first;
+        parsed.function = dllAndFunction.second;
+        if (parsed.dllPath.empty() || parsed.function.empty())
+        {
+            log.error("Invalid symbol: {}", symbol);
+            ok = false;
+            continue;
+        }
+        uint16_t ordinal = 0;
+        if (parsed.function.size() > 1 && parsed.function.front() == '#' && !import_patcher::parse_ordinal(parsed.function, ordinal))
+        {
+            log.error("Invalid ordinal in symbol: {} (use #0 to #65535)", symbol);
+            ok = false;
+            continue;
+        }
+        parsed.module = std::filesystem::path(parsed.dllPath).filename().string();
+
+        // the loader compares module names case-insensitively, so do the duplicate check the same way
+        bool duplicate = std::ranges::any_of(symbols, [&parsed](const import_symbol& other) {
+            return other.function == parsed.function && util::equals_ignore_case(other.module, parsed.module);
+        });
+        if (duplicate)
+        {
+            log.warn("{}::{} is listed more than once, ignoring the duplicate", parsed.module, parsed.function);
+            continue;
+        }
+        symbols.push_back(std::move(parsed));
+    }
+    return ok;
+}
+
+job_result injector::remove_imports(const injection_job& job, const std::vector<import_symbol>& symbols, mapped_file& image,
+    std::unique_ptr<LIEF::PE::Binary>& binary, import_index& imports, const std::string& saveTarget, spdlog::logger& log, profiler* profile)
+{
+    // existing check isn't required for remove
+    // bc we aren't really using the dll itself
+    if (!job.force)
+    {
+        log.warn("WARNING: The remove action will likely not work correctly.");
+        log.warn("I highly recommend to just restore the original file.");
+        log.warn("\033[31mIf you're absolutely sure you want to continue, append the --force flag to your args and run this again.\033[0m");
+        return { false, "remove requires --force" };
+    }
+
+    // resolve the whole set first so nothing is written unless every import exists
+    std::vector<const import_record*> records;
+    records.reserve(symbols.size());
+    size_t missing = 0;
+    for (const auto& symbol : symbols)
+    {
+        log.info("Attempting to remove import: {}::{}", symbol.module, symbol.function);
+        const import_record* record = imports.find(symbol.module, symbol.function);
+        if (!record)
+        {
+            log.error("Failed to remove import: {}::{}", symbol.module, symbol.function);
+            ++missing;
+            continue;
+        }
+        records.push_back(record);
+    }
+    if (missing != 0)
+    {
+        return { false, missing == 1 ? "import not found" : std::to_string(missing) + " imports not found" };
+    }
+    log.debug("Matching functions found!");
+
+    bool saveLocked;
+    {
+        profiler::scope phase(profile, "lock check");
+        saveLocked = util::is_file_locked(saveTarget);
+    }
+    if (saveLocked)
+    {
+        log.error("The file to save to is locked! Please close any applications that may be using it.");
+        log.critical("Failed to save the modified file.");
+        return { false, "save target is locked" };
+    }
+
+    const std::string& target = job.target;
+    if (!job.rebuild)
+    {
+        import_patcher patcher(image.bytes());
+        bool patched;
+        {
+            profiler::scope phase(profile, "patch");
+            patched = patcher.load();
+            for (size_t i = 0; patched && i < records.size(); ++i)
+            {
+                patched = patcher.remove_import(records[i]->module, symbols[i].function);
+            }
+            patched = patched && patcher.build();
+        }
+        if (patched)
+        {
+            profiler::scope phase(profile, "write");
+            if (!write_patched(patcher, image, target, saveTarget, log)) return { false, "failed to write output" };
+            log.info("Removed {} import(s) successfully!", records.size());
+            return { true, "removed " + describe(symbols) };
+        }
+        log.warn("Couldn't patch the import table in place ({}), falling back to a full rebuild", patcher.error());
+    }
+
+    if (!prepare_rebuild(job, image, binary, imports, log, profile)) return { false, "failed to parse target" };
+    // a second parse rebuilt the index, the records have to come from the new one
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        records[i] = imports.find(symbols[i].module, symbols[i].function);
+        if (!records[i]) return { false, "import not found" };
+    }
+    {
+        profiler::scope phase(profile, "modify");
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            log.info("Removing import: {}::{}", records[i]->module, symbols[i].function);
+            // an ordinal entry has no name to match, it goes by its ordinal
+            bool removed = records[i]->isOrdinal ? records[i]->descriptor->remove_entry(static_cast<uint32_t>(records[i]->ordinal))
+                                                 : records[i]->descriptor->remove_entry(symbols[i].function);
+            if (!removed)
+            {
+                log.critical("Failed to remove import: {}::{}", records[i]->module, symbols[i].function);
+                // earlier removals already went into the binary, a server's cache must not hand it out
+                binary.reset();
+                return { false, "failed to remove import" };
+            }
+        }
+    }
+    log.info("Removed {} import(s) successfully!", records.size());
+
+    // the parsed binary owns its data now, drop the mapping so saving over the target works on windows
+    image.close();
+    profiler::scope phase(profile, "write");
+    bool written = write_binary(*binary, saveTarget, log);
+    // the binary carries the edit now, a server's cache must not hand it to the next job
+    binary.reset();
+    if (!written) return { false, "failed to write output" };
+    return { true, "removed " + describe(symbols) };
+}
+
+job_result injector::remove_delay_imports(const injection_job& job, const std::vector<import_symbol>& symbols, mapped_file& image,
+    const std::string& saveTarget, spdlog::logger& log, profiler* profile)
+{
+    pe_reader reader(image.bytes());
+    std::vector<pe_import> delayImports;
+    if (reader.parse()) delayImports = reader.delay_imports();
+
+    size_t missing = 0;
+    for (const auto& symbol : symbols)
+    {
+        log.info("Attempting to remove delay-load import: {}::{}", symbol.module, symbol.function);
+        if (!find_delay_import(delayImports, symbol.module, symbol.function))
+        {
+            log.error("Failed to remove delay-load import: {}::{}", symbol.module, symbol.function);
+            ++missing;
+        }
+    }
+    if (missing != 0)
+    {
+        return { false, missing == 1 ? "delay import not found" : std::to_string(missing) + " delay imports not found" };
+    }
+
+    bool saveLocked;
+    {
+        profiler::scope phase(profile, "lock check");
+        saveLocked = util::file_exists(saveTarget) && util::is_file_locked(saveTarget);
+    }
+    if (saveLocked)
+    {
+        log.error("The file to save to is locked! Please close any applications that may be using it.");
+        log.critical("Failed to save the modified file.");
+        return { false, "save target is locked" };
+    }
+
+    import_patcher patcher(image.bytes());
+    bool patched;
+    {
+        profiler::scope phase(profile, "patch");
+        patched = patcher.load();
+        for (size_t i = 0; patched && i < symbols.size(); ++i)
+        {
+            patched = patcher.remove_delay_import(symbols[i].module, symbols[i].function);
+        }
+        patched = patched && patcher.build();
+    }
+    if (!patched)
+    {
+        log.critical("Failed to remove the delay-load imports! ({})", patcher.error());
+        return { false, "failed to patch delay imports: " + patcher.error() };
+    }
+
+    profiler::scope phase(profile, "write");
+    if (!write_patched(patcher, image, job.target, saveTarget, log)) return { false, "failed to write output" };
+    log.info("Removed {} delay-load import(s) successfully!", symbols.size());
+    return { true, "removed " + describe(symbols) };
+}
+
+job_result injector::rehint_imports(const injection_job& job, pe_reader& reader, mapped_file& image, const std::string& saveTarget,
+    spdlog::logger& log, profiler* profile)
+{
+    if (!reader.parse())
+    {
+        log.critical("Failed to parse the target file! ({})", reader.error());
+        return { false, "failed to parse target" };
+    }
+
+    // DLLs are looked up the way deps does for the first level, each export table is read once (and cached across runs)
+    dependency_resolver modules(job.searchPaths);
+    export_cache cache(job.exportCache);
+    std::unordered_map<std::string, std::unique_ptr<export_table>> tables; // lower-cased module, null when not found
+    auto table_for = [&](std::string_view module) -> const export_table* {
+        std::string key = util::to_lower(module);
+        auto it = tables.find(key);
+        if (it != tables.end()) return it->second.get();
+
+        std::unique_ptr<export_table> table;
+        std::string path = dependency_resolver::is_api_set(module) ? "" : modules.find_module(job.target, std::string(module), reader.is_pe32_plus());
+        if (path.empty())
+        {
+            log.warn("Couldn't find {}, its imports keep their hints", module);
+        } else
+        {
+            table = std::make_unique<export_table>();
+            if (!cache.load(path, *table))
+            {
+                log.warn("Failed to read the exports of {} ({})", path, cache.error());
+                table.reset();
+            }
+        }
+        return tables.emplace(std::move(key), std::move(table)).first->second.get();
+    };
+
+    import_patcher patcher(image.bytes());
+    size_t named = 0;
+    size_t updated = 0;
+    size_t unresolved = 0;
+    {
+        profiler::scope phase(profile, "rehint");
+        if (!patcher.load())
+        {
+            log.critical("Failed to read the import table! ({})", patcher.error());
+            return { false, "failed to read imports" };
+        }
+        for (const auto& import : reader.imports())
+        {
+            if (import.isOrdinal) continue;
+            ++named;
+            const export_table* table = table_for(import.module);
+            std::optional<export_symbol> found = table ? table->find(import.function) : std::nullopt;
+            if (!found)
+            {
+                if (table) log.warn("{} doesn't export {}", import.module, import.function);
+                ++unresolved;
+                continue;
+            }
+            uint16_t hint = found->hint <= UINT16_MAX ? static_cast<uint16_t>(found->hint) : 0;
+            if (hint == import.hint) continue;
+            log.debug("{}::{} hint {} -> {}", import.module, import.function, import.hint, hint);
+            patcher.update_hint(import.nameRva, hint);
+            ++updated;
+        }
+    }
+    log.info("{} of {} named imports had stale hints, {} couldn't be resolved", updated, named, unresolved);
+    if (updated == 0) return { true, "hints already up to date" };
+
+    bool saveLocked;
+    {
+        profiler::scope phase(profile, "lock check");
+        saveLocked = util::file_exists(saveTarget) && util::is_file_locked(saveTarget);
+    }
+    if (saveLocked)
+    {
+        log.error("The file to save to is locked! Please close any applications that may be using it.");
+        log.critical("Failed to save the modified file.");
+        return { false, "save target is locked" };
+    }
+
+    if (!patcher.build())
+    {
+        log.critical("Failed to patch the hints! ({})", patcher.error());
+        return { false, "failed to patch hints: " + patcher.error() };
+    }
+    profiler::scope phase(profile, "write");
+    if (!write_patched(patcher, image, job.target, saveTarget, log)) return { false, "failed to write output" };
+    return { true, "updated " + std::to_string(updated) + " hints" };
+}
+
+job_result injector::bind_imports(const injection_job& job, mapped_file& image, const std::string& saveTarget, spdlog::logger& log, profiler* profile)
+{
+    // injected descriptors are regular ones by now, they bind like the linker's own
+    import_binder binder(image.bytes(), job.target, job.searchPaths);
+    {
+        profiler::scope phase(profile, "bind");
+        if (!binder.bind(job.force))
+        {
+            log.critical("Failed to bind the imports! ({})", binder.error());
+            return { false, "failed to bind: " + binder.error() };
+        }
+    }
+    for (const auto& skipped : binder.skipped()) log.warn("Left unbound: {}", skipped);
+    for (const auto& module : binder.relocatable())
+    {
+        log.warn("{} has ASLR enabled, its bound addresses are only used when it loads at its preferred base", module);
+    }
+    log.info("Bound {} of {} import descriptors ({} slots)", binder.bound_count(), binder.descriptor_count(), binder.slot_count());
+
+    profiler::scope phase(profile, "write");
+    image.close();
+    if (util::file_exists(saveTarget) && util::is_file_locked(saveTarget))
+    {
+        log.error("The file to save to is locked! Please close any applications that may be using it.");
+        log.critical("Failed to save the modified file.");
+        return { false, "save target is locked" };
+    }
+    if (!binder.write(job.target, saveTarget))
+    {
+        log.critical("Failed to save the modified file! ({})", binder.error());
+        return { false, "failed to write output" };
+    }
+    log.info("Bound binary saved to: {} ({} bytes patched)", saveTarget, binder.patched_bytes());
+    return { true, "bound " + std::to_string(binder.bound_count()) + " of " + std::to_string(binder.descriptor_count()) + " descriptors" };
+}
+
+job_result injector::checksum_image(const injection_job& job, pe_reader& reader, mapped_file& image, const std::string& saveTarget,
+    spdlog::logger& log, profiler* profile)
+{
+    if (!reader.parse())
+    {
+        log.critical("Failed to parse the target file! ({})", reader.error());
+        return { false, "failed to parse target" };
+    }
+
+    uint64_t offset = reader.optional_header_offset() + pe::OPTIONAL_CHECKSUM;
+    uint32_t stored = pe::read<uint32_t>(image.data() + offset);
+    uint32_t computed;
+    {
+        profiler::scope phase(profile, "checksum");
+        computed = pe_checksum::compute(image.bytes(), offset);
+    }
+    log.info("CheckSum: stored {:08X}, computed {:08X} ({} bytes, {} kernel)", stored, computed, image.size(), pe_checksum::kernel());
+    if (stored == computed)
+    {
+        log.info("The checksum is correct.");
+        return { true, "checksum correct" };
+    }
+    if (stored == 0) log.warn("The image was linked without a checksum, writing one");
+    else log.warn("The checksum is stale, fixing it");
+
+    // the field is outside the authenticode digest, a signature stays valid
+    profiler::scope phase(profile, "write");
+    image.close();
+    if (util::file_exists(saveTarget) && util::is_file_locked(saveTarget))
+    {
+        log.error("The file to save to is locked! Please close any applications that may be using it.");
+        log.critical("Failed to save the modified file.");
+        return { false, "save target is locked" };
+    }
+    // a copy with the new value replaces the save path, in place or not the original survives a failed write
+    std::string error;
+    bool written = util::replace_file(saveTarget, [&](const std::string& temporaryPath) {
+        std::error_code ec;
+        if (!std::filesystem::copy_file(job.target, temporaryPath, std::filesystem::copy_options::overwrite_existing, ec))
+        {
+            error = "failed to copy file: " + ec.message();
+            return false;
+        }
+        return pe_checksum::store(temporaryPath, offset, computed, error);
+    }, error);
+    if (!written)
+    {
+        log.critical("Failed to save the modified file! ({})", error);
+        return { false, "failed to write output" };
+    }
+    log.info("Fixed binary saved to: {}", saveTarget);
+    return { true, "checksum fixed" };
+}
+
+bool injector::is_system_module(const import_symbol& symbol, bool pe32Plus)
+{
+    if (dependency_resolver::is_api_set(symbol.module)) return true;
+    // a known DLL is loaded from the system directory even when a copy sits next to the target
+    std::error_code ec;
+    std::filesystem::path dllDirectory = std::filesystem::absolute(std::filesystem::path(symbol.dllPath), ec).parent_path();
+    for (const auto& directory : dependency_resolver::system_directories(pe32Plus))
+    {
+        if (std::filesystem::equivalent(dllDirectory, directory, ec)) return true;
+        if (util::file_exists((std::filesystem::path(directory) / symbol.module).string())) return true;
+    }
+    return false;
+}
+
+const pe_import* injector::find_delay_import(const std::vector<pe_import>& delayImports, const std::string& module, const std::string& function)
+{
+    for (const auto& entry : delayImports)
+    {
+        if (!util::equals_ignore_case(entry.module, module)) continue;
+        if (entry.isOrdinal ? function == "#" + std::to_string(entry.ordinal) : entry.function == function) return &entry;
+    }
+    return nullptr;
+}
+
+export_validation injector::validate_exports(const injection_job& job, const std::vector<import_symbol>& symbols, std::atomic<bool>& stop, profiler* profile)
+{
+    profiler::scope phase(profile, "validate");
+    export_validation result;
+    result.hints.resize(symbols.size(), 0);
+    result.ordinals.resize(symbols.size(), 0);
+    auto reject = [&result](std::string message) {
+        result.messages.emplace_back(spdlog::level::err, std::move(message));
+        ++result.rejected;
+    };
+
+    // every DLL is loaded once no matter how many of its functions are in the set
+    std::vector<std::string> dllPaths;
+    for (const auto& symbol : symbols)
+    {
+        if (std::ranges::find(dllPaths, symbol.dllPath) == dllPaths.end()) dllPaths.push_back(symbol.dllPath);
+    }
+
+    export_cache cache(job.exportCache);
+    export_table dllExports;
+    for (const auto& dllPath : dllPaths)
+    {
+        if (stop) break;
+        if (!util::file_exists(dllPath))
+        {
+            reject(fmt::format("The specified DLL does not exist! ({})", dllPath));
+            continue;
+        }
+        if (!cache.load(dllPath, dllExports))
+        {
+            reject(fmt::format("Failed to parse the DLL file! ({}: {})", dllPath, cache.error()));
+            continue;
+        }
+
+        for (size_t i = 0; i < symbols.size(); ++i)
+        {
+            const import_symbol& symbol = symbols[i];
+            if (symbol.dllPath != dllPath) continue;
+            uint16_t ordinal;
+            bool byOrdinal = import_patcher::parse_ordinal(symbol.function, ordinal);
+            if (auto found = byOrdinal ? dllExports.find(ordinal) : dllExports.find(symbol.function))
+            {
+                // the hint field is 16 bits, a later index just makes the loader fall back to its search
+                result.hints[i] = found->hint <= UINT16_MAX ? static_cast<uint16_t>(found->hint) : 0;
+                result.ordinals[i] = found->ordinal;
+                continue;
+            }
+            reject(fmt::format("The specified function does not exist in the DLL! ({}::{})", symbol.module, symbol.function));
+            result.messages.emplace_back(spdlog::level::info, fmt::format("TIP: You can also list exports for this DLL by typing --action:list --target:{}",
+                dllPath.contains(" ") ? "\"" + dllPath + "\"" : dllPath));
+        }
+    }
+    // the job fails either way, the target doesn't need to be indexed
+    if (result.rejected != 0) stop = true;
+    return result;
+}
+
+job_result injector::add_imports(const injection_job& job, const std::vector<import_symbol>& symbols, mapped_file& image,
+    std::unique_ptr<LIEF::PE::Binary>& binary, import_index& imports, const std::string& saveTarget, spdlog::logger& log, profiler* profile,
+    std::future<export_validation>& validation, std::atomic<bool>& stop)
+{
+    // delay imports aren't in the LIEF index, they come straight from the mapping
+    std::vector<pe_import> delayImports;
+    if (job.delayLoad)
+    {
+        pe_reader reader(image.bytes());
+        if (reader.parse()) delayImports = reader.delay_imports();
+    }
+
+    size_t rejected = 0;
+    for (const auto& symbol : symbols)
+    {
+        if (stop) break;
+        log.info("Attempting to add import: {}::{}", symbol.module, symbol.function);
+        bool exists = job.delayLoad ? find_delay_import(delayImports, symbol.module, symbol.function) != nullptr
+                                    : imports.find(symbol.module, symbol.function) != nullptr;
+        if (exists)
+        {
+            log.error("Import already exists: {}::{}", symbol.module, symbol.function);
+            ++rejected;
+        }
+    }
+    if (rejected != 0)
+    {
+        stop = true;
+        return { false, rejected == 1 ? "import already exists" : std::to_string(rejected) + " imports already exist" };
+    }
+
+    const std::string& target = job.target;
+    // without the DLL check (--force) nothing is known about the exports, hints stay 0 and everything is imported by name
+    bool validated = validation.valid();
+    std::vector<uint16_t> hints(symbols.size(), 0);
+    std::vector<uint16_t> ordinals(symbols.size(), 0);
+    if (validated)
+    {
+        export_validation result = validation.get();
+        for (const auto& [level, message] : result.messages)
+        {
+            log.log(level, "{}", message);
+        }
+        if (result.rejected != 0)
+        {
+            log.warn("If you are sure the functions exist, append --force to override this check.");
+            return { false, result.rejected == 1 ? "DLL validation failed" : std::to_string(result.rejected) + " DLL validation failures" };
+        }
+        hints = std::move(result.hints);
+        ordinals = std::move(result.ordinals);
+    }
+
+    // what goes into the name table for each symbol, "#123" where it's imported by ordinal
+    std::vector<std::string> functions;
+    for (const auto& symbol : symbols) functions.push_back(symbol.function);
+    if (job.byOrdinal && !validated)
+    {
+        log.warn("--by-ordinal needs the DLL export check, importing by name since --force skips it.");
+    } else if (job.byOrdinal)
+    {
+        bool pe32Plus = binary->type() == LIEF::PE::PE_TYPE::PE32_PLUS;
+        for (size_t i = 0; i < symbols.size(); ++i)
+        {
+            // system DLL ordinals aren't stable across windows builds, only DLLs shipped next to the target are safe
+            if (is_system_module(symbols[i], pe32Plus))
+            {
+                log.warn("{} is a system DLL, importing {} by name.", symbols[i].module, symbols[i].function);
+                continue;
+            }
+            functions[i] = "#" + std::to_string(ordinals[i]);
+            log.info("Importing {}::{} by ordinal {}", symbols[i].module, symbols[i].function, ordinals[i]);
+        }
+    }
+
+    std::string prgDir = std::filesystem::path(target).parent_path().string();
+    std::vector<std::string> warnedDirectories;
+    for (const auto& symbol : symbols)
+    {
+        std::string dllDirectory = std::filesystem::path(symbol.dllPath).parent_path().string();
+        if (dllDirectory == prgDir || std::ranges::find(warnedDirectories, dllDirectory) != warnedDirectories.end()) continue;
+        warnedDirectories.push_back(dllDirectory);
+        log.warn("The DLL is not in the same directory as the target file! ({})", symbol.dllPath);
+        log.warn("If the program fails to launch, you MUST copy the DLL to the same directory as the target file!");
+    }
+
+    for (const auto& symbol : symbols)
+    {
+        if (job.delayLoad)
+        {
+            log.info("Adding new delay-load import: {}::{}", symbol.module, symbol.function);
+        } else if (imports.find_module(symbol.module))
+        {
+            log.warn("Library already exists, using existing module ({})", symbol.module);
+        } else
+        {
+            log.info("Adding new import: {}::{}", symbol.module, symbol.function);
+        }
+    }
+
+    if (!job.rebuild)
+    {
+        import_patcher patcher(image.bytes());
+        bool patched;
+        {
+            profiler::scope phase(profile, "patch");
+            patched = patcher.load();
+            if (patched)
+            {
+                for (size_t i = 0; i < symbols.size(); ++i)
+                {
+                    if (job.delayLoad) patcher.add_delay_import(symbols[i].module, functions[i], hints[i]);
+                    else patcher.add_import(symbols[i].module, functions[i], hints[i]);
+                }
+                patched = patcher.build();
+            }
+        }
+        if (patched)
+        {
+            profiler::scope phase(profile, "write");
+            if (!write_patched(patcher, image, target, saveTarget, log)) return { false, "failed to write output" };
+            log.info("Added {} import(s) successfully!", symbols.size());
+            return { true, "added " + describe(symbols) };
+        }
+        if (job.delayLoad)
+        {
+            log.critical("Failed to add the delay-load imports! ({})", patcher.error());
+            return { false, "failed to patch delay imports: " + patcher.error() };
+        }
+        log.warn("Couldn't patch the import table in place ({}), falling back to a full rebuild", patcher.error());
+    }
+
+    if (!prepare_rebuild(job, image, binary, imports, log, profile)) return { false, "failed to parse target" };
+    {
+        profiler::scope phase(profile, "modify");
+        // modules created for earlier symbols of the set are reused by the later ones
+        std::vector<std::pair<std::string, LIEF::PE::Import*>> created;
+        for (size_t i = 0; i < symbols.size(); ++i)
+        {
+            const import_symbol& symbol = symbols[i];
+            LIEF::PE::Import* library = imports.find_module(symbol.module);
+            if (!library)
+            {
+                auto it = std::ranges::find_if(created, [&symbol](const auto& entry) { return util::equals_ignore_case(entry.first, symbol.module); });
+                if (it != created.end()) library = it->second;
+                else library = created.emplace_back(symbol.module, &binary->add_import(symbol.module)).second;
+            }
+            uint16_t ordinal = 0;
+            if (import_patcher::parse_ordinal(functions[i], ordinal))
+            {
+                uint64_t flag = binary->type() == LIEF::PE::PE_TYPE::PE32_PLUS ? pe::ORDINAL_FLAG64 : pe::ORDINAL_FLAG32;
+                library->add_entry(LIEF::PE::ImportEntry(flag | ordinal, binary->type()));
+                continue;
+            }
+            LIEF::PE::ImportEntry entry(symbol.function);
+            entry.hint(hints[i]);
+            library->add_entry(entry);
+        }
+    }
+    log.info("Added {} import(s) successfully!", symbols.size());
+
+    image.close();
+    profiler::scope phase(profile, "write");
+    bool written = write_binary(*binary, saveTarget, log);
+    // the binary carries the edit now, a server's cache must not hand it to the next job
+    binary.reset();
+    if (!written) return { false, "failed to write output" };
+    return { true, "added " + describe(symbols) };
+}
+
+std::string injector::describe(const std::vector<import_symbol>& symbols)
+{
+    if (symbols.size() == 1) return symbols.front().module + "::" + symbols.front().function;
+    return std::to_string(symbols.size()) + " imports";
+}
+
+bool injector::write_patched(import_patcher& patcher, mapped_file& image, const std::string& target, const std::string& saveTarget, spdlog::logger& log)
+{
+    // the patches are self-contained, the mapping has to go before the target can be replaced
+    image.close();
+    if (util::file_exists(saveTarget) && util::is_file_locked(saveTarget))
+    {
+        log.error("The file to save to is locked! Please close any applications that may be using it.");
+        return false;
+    }
+    if (!patcher.write(target, saveTarget))
+    {
+        log.critical("Failed to save the modified file! ({})", patcher.error());
+        return false;
+    }
+    log.info("Modified binary saved to: {} ({} bytes patched)", saveTarget, patcher.patched_bytes());
+    layout_report layout = patcher.layout();
+    for (const auto& region : layout.regions) log.debug("Slack used in {}", region);
+    log.info("Layout: {} bytes placed in slack, {} bytes of new section, file {:+} bytes, image {:+} pages",
+        layout.slackBytes, layout.sectionBytes, layout.fileDelta, layout.pageDelta);
+    return true;
+}
+
+bool injector::prepare_rebuild(const injection_job& job, mapped_file& image, std::unique_ptr<LIEF::PE::Binary>& binary, import_index& imports,
+    spdlog::logger& log, profiler* profile)
+{
+    if (parse_profile::covers(parse_profile::resolve(job.parseProfile, job.action, job.rebuild), parse_profile::rebuild())) return true;
+    profiler::scope phase(profile, "reparse");
+    log.debug("Parsing the rest of the target for the rebuild");
+    binary = LIEF::PE::Parser::parse(std::make_unique<LIEF::SpanStream>(image.data(), static_cast<size_t>(image.size())), parse_profile::rebuild());
+    if (!binary)
+    {
+        log.critical("Failed to parse the target file!");
+        return false;
+    }
+    imports.build(*binary);
+    return true;
+}
+
+bool injector::write_binary(LIEF::PE::Binary& binary, const std::string& saveTarget, spdlog::logger& log)
+{
+    LIEF::PE::Builder::config_t builderConfig;
+    builderConfig.imports = true;
+    builderConfig.relocations = true;
+
+    // built next to the save path and renamed over it: the target (or a hard link to it) stays intact until the image is complete
+    bool updated = false;
+    std::string checksumError;
+    std::string error;
+    bool written = util::replace_file(saveTarget, [&](const std::string& temporaryPath) {
+        std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!output.is_open())
+        {
+            error = "failed to open " + temporaryPath;
+            return false;
+        }
+        try
+        {
+            binary.write(output, builderConfig);
+        }
+        catch (const std::exception& e)
+        {
+            error = std::string("failed to build the image: ") + e.what();
+            return false;
+        }
+        output.close();
+        if (!output.good()) return false;
+
+        // the builder copies the old value over, the rebuilt image needs its own
+        if (!pe_checksum::refresh(temporaryPath, false, updated, checksumError)) updated = false;
+        return true;
+    }, error);
+    if (!written)
+    {
+        log.critical("Failed to write the output file! ({})", error);
+        return false;
+    }
+    log.info("Modified binary saved to: {}", saveTarget);
+    if (!checksumError.empty()) log.warn("Couldn't update the checksum ({})", checksumError);
+    else if (updated) log.info("Updated the checksum");
+    return true;
+}
@@ -0,0 +1,125 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include "util.hpp"
+#include "authenticode.hpp"
+#include "dependency_resolver.hpp"
+#include "export_cache.hpp"
+#include "image_diff.hpp"
+#include "import_binder.hpp"
+#include "import_index.hpp"
+#include "import_patcher.hpp"
+#include "import_scanner.hpp"
+#include "mapped_file.hpp"
+#include "output_writer.hpp"
+#include "parse_profile.hpp"
+#include "pe_checksum.hpp"
+#include "profiler.hpp"
+#include "session.hpp"
+#include "result_cache.hpp"
+#include "target_cache.hpp"
+
+#include <atomic>
+#include <future>
+
+struct injection_job {
+    std::string target;
+    std::string action;
+    std::vector<std::string> symbols; // DLL_PATH::FUNCTION_NAME, applied together with one parse and one write
+    std::string save;
+    bool force = false;
+    bool rebuild = false; // let LIEF rebuild the whole image instead of patching the import table in place
+    bool delayLoad = false; // add/remove work on the delay-load directory, only through the patcher
+    bool byOrdinal = false; // add imports functions of DLLs shipped with the target by ordinal instead of by name
+    std::string exportCache; // directory for cached DLL export tables, empty keeps them in memory only
+    std::string resultCache; // add/remove: directory of finished outputs reused for identical inputs, empty turns it off
+    uint64_t resultCacheBytes = 1ull << 30;
+    int64_t resultCacheAge = 30 * 24 * 3600; // seconds since an entry was stored or last hit
+    std::string parseProfile = "auto"; // which parts of the target LIEF decodes, see parse_profile
+    std::string format = "text"; // list output: text goes through the logger, json and tsv through an output_writer
+    std::string output;          // file for json/tsv output, empty writes to stdout
+    bool profile = false;        // time every phase and report it when the job is done
+    bool verifySignature = false; // recompute the authenticode digest and compare it with the signed one
+    std::string index;            // scan/query: reverse index file, empty uses one per directory in the cache
+    size_t threads = 0;           // scan: worker threads, 0 uses every hardware thread
+    std::vector<std::string> searchPaths; // deps: searched after the target's directory, before the system directories
+    std::string queries;          // resolve: file with one MODULE::FUNCTION per line, "-" or empty (without --symbol) reads stdin
+    std::string baseline;         // diff: the image the target, or every image under the target directory, is compared against
+};
+
+struct import_symbol {
+    std::string dllPath;
+    std::string module; // file name of dllPath, which is what the import table refers to
+    std::string function;
+};
+
+// outcome of the DLL export check, the messages are logged by the job once the task has joined
+struct export_validation {
+    size_t rejected = 0;
+    std::vector<std::pair<spdlog::level::level_enum, std::string>> messages;
+    // per symbol, from the DLL's export table: index into its name table (the import hint) and ordinal
+    std::vector<uint16_t> hints;
+    std::vector<uint16_t> ordinals;
+};
+
+struct job_result {
+    bool success = false;
+    std::string message;
+    double seconds = 0.0;
+};
+
+class injector {
+public:
+    // interactive enables the single-line progress output, batch workers share the console so they run without it
+    // targets, when given, hands out the target's bytes and its parse from earlier jobs of a server
+    [[nodiscard]] static job_result run(const injection_job& job, spdlog::logger& log, bool interactive, target_cache* targets = nullptr);
+
+    [[nodiscard]] static bool is_valid_action(const std::string& action);
+    // add and remove need --symbol, every other single-image action works on the whole image
+    [[nodiscard]] static bool takes_symbols(const std::string& action);
+    [[nodiscard]] static bool is_valid_format(const std::string& format);
+    // --threads: a positive decimal, capped at four per hardware thread. false for anything else
+    [[nodiscard]] static bool parse_thread_count(const std::string& text, size_t& threads);
+    [[nodiscard]] static std::string default_save_path(const std::string& target);
+    // json/tsv listing for --action:list, also used by the benchmarks
+    [[nodiscard]] static job_result write_listing(const injection_job& job, const import_index& imports, const std::vector<pe_import>& delayImports,
+        const std::vector<pe_export>& exports, spdlog::logger& log);
+    // one symbol per line, blank lines and lines starting with # are skipped
+    [[nodiscard]] static bool read_symbols_file(const std::string& path, std::vector<std::string>& symbols);
+
+private:
+    [[nodiscard]] static job_result execute(const injection_job& job, spdlog::logger& log, bool interactive, profiler* profile, target_cache* targets);
+    // execute() behind the result cache, a hit materializes the stored output and skips the job
+    [[nodiscard]] static job_result execute_cached(const injection_job& job, spdlog::logger& log, bool interactive, profiler* profile, target_cache* targets);
+    // every input of an add/remove besides the target bytes, one line each, for result_cache::key
+    [[nodiscard]] static std::string describe_inputs(const injection_job& job);
+    static void report_signature(const signature_check& check, spdlog::logger& log);
+    [[nodiscard]] static job_result diff_images(const injection_job& job, spdlog::logger& log, profiler* profile);
+    [[nodiscard]] static job_result resolve_slots(const injection_job& job, spdlog::logger& log, profiler* profile);
+    [[nodiscard]] static job_result resolve_dependencies(const injection_job& job, spdlog::logger& log, profiler* profile);
+    [[nodiscard]] static job_result scan_tree(const injection_job& job, spdlog::logger& log, profiler* profile);
+    [[nodiscard]] static job_result query_index(const injection_job& job, const std::string& indexPath, spdlog::logger& log, profiler* profile);
+    [[nodiscard]] static bool parse_symbols(const std::vector<std::string>& input, std::vector<import_symbol>& symbols, spdlog::logger& log);
+    [[nodiscard]] static job_result remove_imports(const injection_job& job, const std::vector<import_symbol>& symbols, mapped_file& image,
+        std::unique_ptr<LIEF::PE::Binary>& binary, import_index& imports, const std::string& saveTarget, spdlog::logger& log, profiler* profile);
+    [[nodiscard]] static job_result remove_delay_imports(const injection_job& job, const std::vector<import_symbol>& symbols, mapped_file& image,
+        const std::string& saveTarget, spdlog::logger& log, profiler* profile);
+    [[nodiscard]] static job_result rehint_imports(const injection_job& job, pe_reader& reader, mapped_file& image, const std::string& saveTarget,
+        spdlog::logger& log, profiler* profile);
+    [[nodiscard]] static job_result bind_imports(const injection_job& job, mapped_file& image, const std::string& saveTarget, spdlog::logger& log, profiler* profile);
+    [[nodiscard]] static job_result checksum_image(const injection_job& job, pe_reader& reader, mapped_file& image, const std::string& saveTarget,
+        spdlog::logger& log, profiler* profile);
+    [[nodiscard]] static bool is_system_module(const import_symbol& symbol, bool pe32Plus);
+    [[nodiscard]] static const pe_import* find_delay_import(const std::vector<pe_import>& delayImports, const std::string& module, const std::string& function);
+    [[nodiscard]] static export_validation validate_exports(const injection_job& job, const std::vector<import_symbol>& symbols, std::atomic<bool>& stop, profiler* profile);
+    [[nodiscard]] static job_result add_imports(const injection_job& job, const std::vector<import_symbol>& symbols, mapped_file& image,
+        std::unique_ptr<LIEF::PE::Binary>& binary, import_index& imports, const std::string& saveTarget, spdlog::logger& log, profiler* profile,
+        std::future<export_validation>& validation, std::atomic<bool>& stop);
+    [[nodiscard]] static std::string describe(const std::vector<import_symbol>& symbols);
+    // a patch that fell back to LIEF needs the parts the builder writes back, parses the target again when the profile skipped them
+    [[nodiscard]] static bool prepare_rebuild(const injection_job& job, mapped_file& image, std::unique_ptr<LIEF::PE::Binary>& binary, import_index& imports,
+        spdlog::logger& log, profiler* profile);
+    [[nodiscard]] static bool write_patched(import_patcher& patcher, mapped_file& image, const std::string& target, const std::string& saveTarget, spdlog::logger& log);
+    [[nodiscard]] static bool write_binary(LIEF::PE::Binary& binary, const std::string& saveTarget, spdlog::logger& log);
+};
@@ -0,0 +1,147 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "layout_planner.hpp"
+
+#include <algorithm>
+
+void layout_planner::measure(uint32_t headerReserve)
+{
+    slack.clear();
+    const auto& sections = reader.sections();
+    uint64_t sectionAlignment = std::max<uint32_t>(reader.section_alignment(), 1);
+
+    std::vector<layout_region> readOnly;
+    std::vector<layout_region> writableFile;
+    std::vector<layout_region> writableMapped;
+    uint64_t firstRawData = reader.size_of_headers();
+    for (size_t i = 0; i < sections.size(); ++i)
+    {
+        const pe::section_header& section = sections[i];
+        if (section.SizeOfRawData != 0 && section.PointerToRawData != 0) firstRawData = std::min<uint64_t>(firstRawData, section.PointerToRawData);
+
+        // data next to code would turn up in every scanner, discardable ones may not stay mapped
+        uint32_t characteristics = section.Characteristics;
+        if (section.VirtualSize == 0 || (characteristics & pe::SCN_MEM_READ) == 0) continue;
+        if ((characteristics & (pe::SCN_CNT_CODE | pe::SCN_MEM_EXECUTE | pe::SCN_MEM_DISCARDABLE)) != 0) continue;
+        // resource editors and relinkers rewrite these wholesale, anything behind their data would be lost
+        bool rewritten = false;
+        for (uint32_t index : { pe::DIRECTORY_RESOURCE, pe::DIRECTORY_BASERELOC })
+        {
+            pe::data_directory directory = reader.directory(index);
+            const pe::section_header* holder = directory.VirtualAddress != 0 ? reader.section_from_rva(directory.VirtualAddress) : nullptr;
+            if (holder && holder->VirtualAddress == section.VirtualAddress) rewritten = true;
+        }
+        if (rewritten) continue;
+
+        // the section can grow up to its last page, or up to the next section if that starts earlier
+        uint64_t mappedEnd = pe::align_up(section.VirtualSize, sectionAlignment);
+        for (const auto& other : sections)
+        {
+            if (other.VirtualAddress > section.VirtualAddress) mappedEnd = std::min<uint64_t>(mappedEnd, other.VirtualAddress - section.VirtualAddress);
+        }
+        if (reader.size_of_image() > section.VirtualAddress) mappedEnd = std::min<uint64_t>(mappedEnd, reader.size_of_image() - section.VirtualAddress);
+
+        std::string name(reinterpret_cast<const char*>(section.Name), strnlen(reinterpret_cast<const char*>(section.Name), sizeof(section.Name)));
+        bool writable = (characteristics & pe::SCN_MEM_WRITE) != 0;
+
+        // raw data the linker padded to FileAlignment, past VirtualSize it's loaded as zeros until the section grows over it
+        uint64_t rawEnd = section.PointerToRawData != 0 ? std::min<uint64_t>(section.SizeOfRawData, mappedEnd) : 0;
+        if (rawEnd > section.VirtualSize && section.PointerToRawData < image.size())
+        {
+            uint64_t offset = static_cast<uint64_t>(section.PointerToRawData) + section.VirtualSize;
+            uint64_t size = zero_prefix(offset, rawEnd - section.VirtualSize);
+            layout_region region { name, static_cast<int32_t>(i), section.VirtualAddress + section.VirtualSize, static_cast<int64_t>(offset), static_cast<uint32_t>(size) };
+            region.writable = writable;
+            if (size != 0) (writable ? writableFile : readOnly).push_back(std::move(region));
+        }
+
+        // the rest of the last page has no file data, only worth it for what the loader writes anyway
+        uint64_t fileEnd = std::max<uint64_t>(section.VirtualSize, rawEnd);
+        if (writable && mappedEnd > fileEnd)
+        {
+            layout_region region { name, static_cast<int32_t>(i), static_cast<uint32_t>(section.VirtualAddress + fileEnd), -1, static_cast<uint32_t>(mappedEnd - fileEnd) };
+            region.writable = true;
+            writableMapped.push_back(std::move(region));
+        }
+    }
+
+    slack = std::move(readOnly);
+    slack.insert(slack.end(), writableFile.begin(), writableFile.end());
+    slack.insert(slack.end(), writableMapped.begin(), writableMapped.end());
+
+    // headers are mapped read-only with their file offset as rva, the bound import directory usually sits right here
+    uint64_t headerStart = reader.section_table_offset() + sections.size() * sizeof(pe::section_header) + headerReserve;
+    uint64_t headerEnd = std::min<uint64_t>({ firstRawData, reader.size_of_headers(), image.size() });
+    pe::data_directory bound = reader.directory(pe::DIRECTORY_BOUND_IMPORT);
+    if (bound.VirtualAddress != 0 && bound.VirtualAddress < headerEnd && static_cast<uint64_t>(bound.VirtualAddress) + bound.Size > headerStart)
+    {
+        headerStart = pe::align_up(static_cast<uint64_t>(bound.VirtualAddress) + bound.Size, 4);
+    }
+    if (headerEnd > headerStart)
+    {
+        uint64_t size = zero_prefix(headerStart, headerEnd - headerStart);
+        if (size != 0) slack.push_back({ "headers", -1, static_cast<uint32_t>(headerStart), static_cast<int64_t>(headerStart), static_cast<uint32_t>(size) });
+    }
+}
+
+std::optional<uint32_t> layout_planner::place(uint32_t size, uint32_t alignment, bool writable, bool fileBacked)
+{
+    // mapped-only space first for what doesn't need file bytes, it leaves the file-backed space for what does
+    if (!fileBacked)
+    {
+        for (auto& region : slack)
+        {
+            if (region.fileOffset >= 0 || (writable && !region.writable)) continue;
+            if (auto rva = place_in(region, size, alignment)) return rva;
+        }
+    }
+    for (auto& region : slack)
+    {
+        if (region.fileOffset < 0 || (writable && !region.writable)) continue;
+        if (auto rva = place_in(region, size, alignment)) return rva;
+    }
+    return std::nullopt;
+}
+
+int64_t layout_planner::file_offset(uint32_t rva) const
+{
+    for (const auto& region : slack)
+    {
+        if (rva < region.rva || rva - region.rva >= region.size) continue;
+        return region.fileOffset < 0 ? -1 : region.fileOffset + (rva - region.rva);
+    }
+    return -1;
+}
+
+uint64_t layout_planner::available() const
+{
+    uint64_t total = 0;
+    for (const auto& region : slack) total += region.size;
+    return total;
+}
+
+uint64_t layout_planner::used() const
+{
+    uint64_t total = 0;
+    for (const auto& region : slack) total += region.used;
+    return total;
+}
+
+uint64_t layout_planner::zero_prefix(uint64_t offset, uint64_t size) const
+{
+    if (offset >= image.size()) return 0;
+    size = std::min<uint64_t>(size, image.size() - offset);
+    auto begin = image.begin() + static_cast<std::ptrdiff_t>(offset);
+    auto it = std::find_if(begin, begin + static_cast<std::ptrdiff_t>(size), [](uint8_t byte) { return byte != 0; });
+    return static_cast<uint64_t>(it - begin);
+}
+
+std::optional<uint32_t> layout_planner::place_in(layout_region& region, uint32_t size, uint32_t alignment)
+{
+    uint64_t start = pe::align_up(static_cast<uint64_t>(region.rva) + region.used, alignment) - region.rva;
+    if (start + size > region.size) return std::nullopt;
+    region.used = static_cast<uint32_t>(start + size);
+    return static_cast<uint32_t>(region.rva + start);
+}
@@ -0,0 +1,61 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include "pe_reader.hpp"
+
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+// free space the image already pays for, the loader maps it whether it's used or not
+struct layout_region {
+    std::string name;        // section name, "headers" for the gap behind the section table
+    int32_t section = -1;    // index into the section table, -1 for the header gap
+    uint32_t rva = 0;
+    int64_t fileOffset = -1; // -1 when the space is only mapped, the loader hands it out zeroed
+    uint32_t size = 0;
+    uint32_t used = 0;
+    bool writable = false;
+};
+
+// what an edit cost, filled in by import_patcher::build()
+struct layout_report {
+    uint64_t slackBytes = 0;   // placed into existing regions, including alignment padding between entries
+    uint64_t sectionBytes = 0; // raw size of the appended section, 0 when everything fit
+    int64_t fileDelta = 0;
+    int64_t pageDelta = 0;     // loader pages of SizeOfImage
+    std::vector<std::string> regions; // ".rdata: 212 bytes" for every region that was used
+};
+
+// finds the slack of an image: the zero tail of each section's raw data up to the end of its last page,
+// the mapped but file-less tail of writable sections, and the zero gap between the section table and the first section
+// place() hands out space first fit, growing a section's VirtualSize never changes SizeOfImage or the file size
+// code, discardable, resource and relocation sections are left alone
+// the header gap comes last, it's where a later bind or another section header would go
+class layout_planner {
+public:
+    layout_planner(const pe_reader& reader, std::span<const uint8_t> image) : reader(reader), image(image) {}
+
+    // headerReserve keeps that many bytes behind the section table free (for another section header)
+    void measure(uint32_t headerReserve);
+
+    // fileBacked is needed for anything with initial contents, an IAT next to an ILT can live in zeroed memory
+    [[nodiscard]] std::optional<uint32_t> place(uint32_t size, uint32_t alignment, bool writable, bool fileBacked);
+    // -1 for mapped-only space
+    [[nodiscard]] int64_t file_offset(uint32_t rva) const;
+
+    [[nodiscard]] const std::vector<layout_region>& regions() const { return slack; }
+    [[nodiscard]] uint64_t available() const;
+    [[nodiscard]] uint64_t used() const;
+
+private:
+    // how many bytes from offset on are zero, at most size
+    [[nodiscard]] uint64_t zero_prefix(uint64_t offset, uint64_t size) const;
+    [[nodiscard]] std::optional<uint32_t> place_in(layout_region& region, uint32_t size, uint32_t alignment);
+
+    const pe_reader& reader;
+    std::span<const uint8_t> image;
+    std::vector<layout_region> slack; // read-only file space first, then writable space, then the header gap
+};
@@ -1,41 +1,126 @@
 #include "util.hpp"
+#ifdef _WIN32
 #include "psapi.h"
 #include <windows.h>
 #include <winnt.h>
 #include <imagehlp.h>
+#endif
 
 #include "arg_parser.hpp"
+#include "injector.hpp"
+#include "manifest.hpp"
+#include "server.hpp"
+#include "thread_pool.hpp"
 
-uint32_t get_import_address_offset(const std::vector<uint8_t>& buffer, const std::string& moduleName, const std::string& functionName) {
-    const auto binary= LIEF::PE::Parser::parse(buffer);
-    const auto imports = binary->imports();
+injection_job job_from_args(const arg_parser& parser)
+{
+    injection_job job;
+    job.target = parser.get_arg_value("target");
+    job.action = parser.get_arg_value("action");
+    job.symbols = parser.get_arg_values("symbol");
+    job.save = parser.get_arg_value("save");
+    job.force = parser.has_flag("force");
+    job.rebuild = parser.has_flag("rebuild");
+    job.delayLoad = parser.has_flag("delay-load");
+    job.byOrdinal = parser.has_flag("by-ordinal");
+    job.exportCache = parser.has_arg("export-cache") ? parser.get_arg_value("export-cache") : export_cache::default_directory();
+    if (job.exportCache == "off") job.exportCache.clear();
+    // opt-in, unlike the export cache: a hit skips the edit entirely
+    if (parser.has_arg("result-cache"))
+    {
+        job.resultCache = parser.get_arg_value("result-cache");
+        if (job.resultCache == "default") job.resultCache = result_cache::default_directory();
+    }
+    try
+    {
+        if (parser.has_arg("result-cache-size")) job.resultCacheBytes = std::stoull(parser.get_arg_value("result-cache-size")) << 20;
+        if (parser.has_arg("result-cache-age")) job.resultCacheAge = std::stoll(parser.get_arg_value("result-cache-age")) * 24 * 3600;
+    }
+    catch (const std::exception&)
+    {
+        spdlog::warn("Invalid result cache limit, using {} MiB and {} days", job.resultCacheBytes >> 20, job.resultCacheAge / (24 * 3600));
+    }
+    if (parser.has_arg("format")) job.format = parser.get_arg_value("format");
+    if (parser.has_arg("parse-profile")) job.parseProfile = parser.get_arg_value("parse-profile");
+    job.output = parser.get_arg_value("output");
+    job.profile = parser.has_flag("profile");
+    job.verifySignature = parser.has_flag("verify-signature");
+    job.index = parser.get_arg_value("index");
+    job.queries = parser.get_arg_value("queries");
+    job.baseline = parser.get_arg_value("baseline");
+    for (const auto& paths : parser.get_arg_values("search-path"))
+    {
+        for (const auto& path : util::split_string(paths, ";"))
+        {
+            if (!util::trim_string(path).empty()) job.searchPaths.push_back(util::trim_string(path));
+        }
+    }
+    // main and the server reject a bad value before a job is made from it
+    if (parser.has_arg("threads") && !injector::parse_thread_count(parser.get_arg_value("threads"), job.threads)) job.threads = 0;
+    return job;
+}
 
-    std::reverse(imports.begin(), imports.end());
+int run_batch(const arg_parser& parser, spdlog::logger& console)
+{
+    manifest jobs;
+    injection_job defaults = job_from_args(parser);
+    if (!jobs.load(parser.get_arg_value("manifest"), defaults))
+    {
+        spdlog::critical("The manifest couldn't be loaded! Please fix the lines above and try again.");
+        return 1;
+    }
+    if (jobs.jobs.empty())
+    {
+        spdlog::warn("The manifest doesn't contain any jobs.");
+        return 0;
+    }
 
-    for (const auto& import : imports) {
-        uint32_t iatRVA = import.import_address_table_rva();
-        if (import.name() == moduleName) {
-            int functionIndex = 0;
-            for (const auto& entry : import.entries()) {
-                if (entry.name() == functionName) {
-                    return iatRVA + (functionIndex * 8);
-                }
-                ++functionIndex;
-            }
+    size_t threadCount = defaults.threads == 0 ? thread_pool::default_thread_count() : defaults.threads;
+    threadCount = std::min(threadCount, jobs.jobs.size());
+
+    // every job logs through its own logger on the shared console sink so lines can be told apart
+    console.set_pattern("\033[90m[\033[33m%T\033[90m] [%n] %^[%l]%$\033[0m %v");
+    spdlog::info("Running {} jobs on {} threads", jobs.jobs.size(), threadCount);
+
+    std::vector<std::future<job_result>> futures;
+    futures.reserve(jobs.jobs.size());
+    auto start = std::chrono::steady_clock::now();
+    {
+        thread_pool pool(threadCount);
+        for (size_t i = 0; i < jobs.jobs.size(); ++i)
+        {
+            futures.push_back(pool.submit([&console, &job = jobs.jobs[i], i] {
+                spdlog::logger log("job #" + std::to_string(i + 1), console.sinks().begin(), console.sinks().end());
+                log.set_level(console.level());
+                return injector::run(job, log, false);
+            }));
         }
     }
-    return 0;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t failed = 0;
+    spdlog::info("Summary:");
+    for (size_t i = 0; i < futures.size(); ++i)
+    {
+        job_result result = futures[i].get();
+        const injection_job& job = jobs.jobs[i];
+        if (result.success)
+        {
+            spdlog::info("  #{:<4} OK   {:>8.3f}s  {} {} - {}", i + 1, result.seconds, job.action, job.target, result.message);
+        } else
+        {
+            ++failed;
+            spdlog::error("  #{:<4} FAIL {:>8.3f}s  {} {} - {}", i + 1, result.seconds, job.action, job.target, result.message);
+        }
+    }
+    spdlog::info("{} succeeded, {} failed, {:.3f}s total", futures.size() - failed, failed, elapsed);
+    return failed == 0 ? 0 : 1;
 }
 
 int main(int argc, char* argv[])
 {
     util::enable_virtual_terminal();
 
-    LIEF::PE::Builder::config_t builderConfig;
-    builderConfig.imports = true;
-    builderConfig.relocations = true;
-
-
     auto console = spdlog::stdout_color_mt("console");
     console->set_pattern("\033[90m[\033[33m%T\033[90m] %^[%l]%$\033[0m %v");
     spdlog::set_default_logger(console);
@@ -47,14 +132,91 @@ int main(int argc, char* argv[])
                            "Can be used to make a program load a DLL at runtime.\n";
     parser.set_description(description);
     parser.add_default_arg("help", "",  "Show help message", false, true);
-    parser.add_default_arg("target", "example app.exe", "Path to the target .exe file", true);
-    parser.add_default_arg("action", "add", "Action to perform (add, remove, list)", true);
+    parser.add_default_arg("target", "example app.exe", "Path to the target .exe file", false, false, "Required unless --manifest is used");
+    std::string actionDescription = "Required unless --manifest is used\n"
+        "scan indexes the imports and exports of every PE file under the --target directory\n"
+        "query looks up which of them import or export the given --symbol (MODULE::FUNCTION, or MODULE for all of it)\n"
+        "resolve prints the IAT slot rva, width, hint and ordinal of each MODULE::FUNCTION from --symbol, --queries or stdin\n"
+        "diff reports imports and exports added, removed or changed (ordinal, hint, slot or rva) since --baseline, the target can be a directory\n"
+        "deps resolves every module the target loads, directly or not, and reports missing modules and exports\n"
+        "rehint rewrites the hint of every named import to the function's index in the DLL's export name table\n"
+        "bind fills the IAT with the addresses exported by the DLLs on disk and writes a bound import directory\n"
+        "checksum verifies the optional header CheckSum and saves a copy with the correct one if it's wrong\n"
+        "Every action that writes the image updates its checksum, unless it was linked without one";
+    parser.add_default_arg("action", "add", "Action to perform (add, remove, list, resolve, diff, rehint, bind, checksum, deps, scan, query)", false, false, actionDescription);
     std::string symbolDescription = "The DLL and function to add/remove from the target's imports\n"
         "Format: DLL_PATH::FUNCTION_NAME\n"
-        "The DLL must be present in a directory that can be found by Windows when loading the target.";
+        "The DLL must be present in a directory that can be found by Windows when loading the target.\n"
+        "Can be repeated, every symbol is applied with a single parse and a single write.";
     parser.add_default_arg("symbol", "example lib.dll::exampleFunction", "The dll and function to add/remove from the target's imports", false, false, symbolDescription);
+    parser.add_default_arg("symbols-file", "symbols.txt", "File with one DLL_PATH::FUNCTION_NAME per line", false, false,
+        "Added to any --symbol arguments, lines starting with # are ignored\nNot used with --manifest, list the symbols in the SYMBOL column instead");
     parser.add_default_arg("save", "example app_infected.exe", "Path to save the modified file", false, false, "Defaults to the target file with \"_modified\" appended to the name");
-    parser.add_default_arg("force", "", "Attempts to force an operation", false, true, "Use with caution! This may cause unexpected behavior.");
+    parser.add_default_arg("force", "", "Attempts to force an operation", false, true, "Use with caution! This may cause unexpected behavior.\nAlso binds images linked with /ALLOWBIND:NO");
+    std::string manifestDescription = "Runs every job listed in the file instead of a single --target\n"
+        "One job per line: TARGET|ACTION|SYMBOL|SAVE|OPTIONS (SYMBOL, SAVE and OPTIONS are optional)\n"
+        "SYMBOL can list several DLL_PATH::FUNCTION_NAME entries separated by ;\n"
+        "OPTIONS is a comma separated list of force, rebuild, delay-load and by-ordinal\n"
+        "Lines starting with # are ignored, --force, --rebuild, --delay-load and --by-ordinal apply to every job";
+    std::string rebuildDescription = "By default the import table is patched in place and the rest of the file is kept byte for byte.\n"
+        "This makes LIEF rebuild and re-emit the whole image instead.";
+    parser.add_default_arg("rebuild", "", "Rebuild the whole binary instead of patching it", false, true, rebuildDescription);
+    std::string delayLoadDescription = "add writes a delay-load descriptor with its own IAT, INT and module handle, the DLL is loaded on the first call\n"
+        "remove drops delay-load descriptors, list always shows them\n"
+        "Only x86 and x64 images, can't be combined with --rebuild";
+    parser.add_default_arg("delay-load", "", "Add/remove delay-load imports instead of regular ones", false, true, delayLoadDescription);
+    std::string byOrdinalDescription = "Uses the ordinal found by the DLL export check, so the loader skips the name lookup\n"
+        "Only for DLLs shipped with the target, system DLLs renumber their exports between windows builds and stay by name";
+    parser.add_default_arg("by-ordinal", "", "Import added functions by ordinal where that's safe", false, true, byOrdinalDescription);
+    std::string exportCacheDescription = "Exports of DLLs checked by add are cached here and reused until the DLL changes\n"
+        "Defaults to " + export_cache::default_directory() + ", use \"off\" to disable";
+    parser.add_default_arg("export-cache", "cache dir", "Directory for the DLL export cache", false, false, exportCacheDescription);
+    std::string resultCacheDescription = "add/remove outputs are stored here, keyed by the target's bytes, the action, its options and the exports of the DLLs\n"
+        "A rerun with the same inputs reflinks, hard links or copies the stored file to the save path instead of patching again\n"
+        "Every hit is checked against the stored size and hash, a damaged entry is dropped and the job runs normally\n"
+        "Use \"default\" for " + result_cache::default_directory() + ", off unless given";
+    parser.add_default_arg("result-cache", "cache dir", "Reuse outputs of identical add/remove jobs", false, false, resultCacheDescription);
+    parser.add_default_arg("result-cache-size", "1024", "Size limit of the result cache in MiB", false, false,
+        "The least recently used entries are evicted after a store until the rest fits, defaults to 1024");
+    parser.add_default_arg("result-cache-age", "30", "Days a result cache entry is kept without being used", false, false, "Defaults to 30");
+    std::string parseProfileDescription = "auto parses only the import table for list, add and remove, everything LIEF reads when it rebuilds the image\n"
+        "default and full are LIEF's default and everything it can parse, or list parts separated by commas:\n"
+        "imports, exports, resources, relocations, signature, exceptions, arm64x\n"
+        "A patch that falls back to a rebuild parses the target again when the profile skipped what the rebuild writes back";
+    parser.add_default_arg("parse-profile", "imports,resources", "Which parts of the target LIEF parses", false, false, parseProfileDescription);
+    std::string formatDescription = "text logs the listing, json and tsv write one record per import/export\n"
+        "Records hold kind, module, function, ordinal, hint and rva, logs go to stderr instead";
+    parser.add_default_arg("format", "json", "Output format for --action:list, resolve, diff, deps and query (text, json, tsv)", false, false, formatDescription);
+    parser.add_default_arg("output", "imports.json", "File to write json/tsv output to", false, false, "Defaults to stdout");
+    std::string verifyDescription = "Recomputes the authenticode digest of a signed target and compares it with the one in the signature\n"
+        "Tells whether the file was changed after signing, the certificate chain isn't checked";
+    parser.add_default_arg("verify-signature", "", "Check the target's signature digest", false, true, verifyDescription);
+    std::string profileDescription = "Prints wall time, calls and memory high-water marks for each phase when the job is done\n"
+        "With --format:json or tsv the profile is written to stderr as one json line";
+    parser.add_default_arg("profile", "", "Time every phase of the job", false, true, profileDescription);
+    std::string serveDescription = "Reads one json request per line from stdin and writes one json reply per line to stdout\n"
+        "A request uses the argument names: {\"id\": 1, \"target\": \"app.exe\", \"action\": \"add\", \"symbol\": [\"lib.dll::fn\"], \"force\": true}\n"
+        "Arguments given with --serve apply to every request, a request's own fields replace them and false clears a flag\n"
+        "Replies carry id, success, message, seconds and the job's log lines, {\"action\": \"shutdown\"} or the end of stdin stops the server\n"
+        "Targets stay in memory with their parse until the file changes on disk";
+    parser.add_default_arg("serve", "", "Serve requests from stdin, keeping targets parsed between them", false, true, serveDescription);
+    parser.add_default_arg("serve-cache", "16", "Number of targets --serve keeps in memory", false, false, "The least recently used target is dropped first, defaults to 16");
+    parser.add_default_arg("manifest", "jobs.txt", "Batch mode, apply the jobs listed in a manifest file", false, false, manifestDescription);
+    std::string searchPathDescription = "Directories --action:deps, rehint and bind search after the target's own directory and before the system ones\n"
+        "Can be repeated or separated by ;";
+    parser.add_default_arg("search-path", "C:\\Program Files\\App\\bin", "Extra directories to resolve dependencies from", false, false, searchPathDescription);
+    std::string indexDescription = "Where --action:scan writes the reverse import index and --action:query reads it\n"
+        "Defaults to one file per directory in " + util::cache_directory("scans") + "\n"
+        "A rescan only reads files whose size or modification time changed, --force rereads everything";
+    parser.add_default_arg("index", "imports.sxi", "Reverse import index file for scan/query", false, false, indexDescription);
+    std::string queriesDescription = "One MODULE::FUNCTION per line, MODULE::#123 for an import by ordinal, lines starting with # are ignored\n"
+        "\"-\" reads stdin and answers each line as it comes, which is also the default without --symbol\n"
+        "Functions that aren't imported get a not-found record instead of failing the job";
+    parser.add_default_arg("queries", "slots.txt", "Queries for --action:resolve", false, false, queriesDescription);
+    std::string baselineDescription = "The target is compared against it, only the import, delay import and export directories are read\n"
+        "With a directory as --target every image under it is compared on --threads workers and reported in path order";
+    parser.add_default_arg("baseline", "old app.exe", "Image --action:diff compares the target against", false, false, baselineDescription);
+    parser.add_default_arg("threads", "8", "Number of worker threads for --manifest, --action:scan and diff", false, false, "Defaults to the number of hardware threads");
 
     if (!parser.parse_args(argc, argv))
     {
@@ -75,314 +237,77 @@ int main(int argc, char* argv[])
         return 1;
     }
 
-    std::string action = parser.get_arg_value("action");
-
-    if (action != "add" && action != "remove" && action != "list")
+    std::string format = parser.has_arg("format") ? parser.get_arg_value("format") : "text";
+    if (!injector::is_valid_format(format))
     {
-        spdlog::critical("Invalid action specified! Use 'add', 'remove', or 'list'.");
+        spdlog::error(":: Unknown format \"{}\"! Use text, json or tsv.", format);
         return 1;
     }
 
-    std::string target = parser.get_arg_value("target");
-    if (!util::file_exists(target))
+    if (parser.has_arg("parse-profile") && !parse_profile::is_valid(parser.get_arg_value("parse-profile")))
     {
-        spdlog::critical("The target file you specified does not exist!");
+        spdlog::error(":: Unknown parse profile \"{}\"! Use auto, default, full or a list of parts.", parser.get_arg_value("parse-profile"));
         return 1;
     }
 
-    if (util::is_file_locked(target))
+    size_t threads;
+    if (parser.has_arg("threads") && !injector::parse_thread_count(parser.get_arg_value("threads"), threads))
     {
-        spdlog::critical("The target file is locked! Please close any applications that may be using it.");
+        spdlog::error(":: Invalid thread count \"{}\"! Use a positive number.", parser.get_arg_value("threads"));
         return 1;
     }
 
-    HANDLE hFile = CreateFileA(target.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
-    if (hFile == INVALID_HANDLE_VALUE)
+    if (parser.has_flag("serve"))
     {
-        spdlog::critical("Failed to open the target file!");
-        return 1;
-    }
-
-    DWORD fileSize = GetFileSize(hFile, nullptr);
-    if (fileSize == INVALID_FILE_SIZE)
-    {
-        CloseHandle(hFile);
-        spdlog::critical("Failed to get file size!");
-        return 1;
-    }
-
-    std::string targetFilename = std::filesystem::path(target).filename().string();
-
-    bool signedTarget = util::has_code_signature(target);
-    if (signedTarget)
-    {
-        spdlog::warn("THE TARGET FILE IS SIGNED!");
-        spdlog::warn("Modifying a signed file may cause the signature to be invalidated.");
-        spdlog::warn("We are NOT responsible for any issues that may arise from this.");
-        spdlog::warn("\033[31mTHIS MAY MAKE THE FILE UNSIGNED OR FAIL TO LOAD.\033[0m");
-    }
-
-    std::vector<uint8_t> buffer(fileSize);
-    DWORD bytesRead = 0;
-
-    if (!signedTarget)
-    {
-        util::clear_current_console_line();
-        util::write("Reading target file: " + targetFilename + "\r");
-    }
-
-    ReadFile(hFile, buffer.data(), fileSize, &bytesRead, nullptr);
-    CloseHandle(hFile);
-
-    if (bytesRead != fileSize)
-    {
-        spdlog::critical("Failed to read the entire file!");
-        return 1;
-    }
-
-    if (!signedTarget)
-    {
-        util::clear_current_console_line();
-        util::write("Parsing target file: " + targetFilename + "\r");
-    }
-
-    auto binary = LIEF::PE::Parser::parse(buffer);
-    if (!signedTarget) util::clear_current_console_line();
-
-    auto imports = binary->imports();
-
-    if (action == "list")
-    {
-        spdlog::info("Imported functions:");
-        for (const auto& import : imports)
+        // stdout carries the replies
+        console->sinks() = { std::make_shared<spdlog::sinks::stderr_color_sink_mt>() };
+        size_t cachedTargets = 16;
+        if (parser.has_arg("serve-cache"))
         {
-            int i = 0;
-            for (const auto& entry : import.entries())
+            try
             {
-                if (!entry.is_ordinal())
-                {
-                    //spdlog::info("  Function: {} ({:X})", entry.name(), entry.iat_value());
-                    spdlog::info("  Import - {}::{} ({:X})", import.name(), entry.name(), (import.import_address_table_rva() + (i * 8)));
-                }
-                i += 1;
+                cachedTargets = std::stoul(parser.get_arg_value("serve-cache"));
+            }
+            catch (const std::exception&)
+            {
+                spdlog::critical("Invalid target count: {}", parser.get_arg_value("serve-cache"));
+                return 1;
             }
         }
-        spdlog::info(" The hex value after the import name is the RVA (Relative Virtual Address) of the import in the IAT (Import Address Table)");
-
-        spdlog::info("Exported functions:");
-        for (const auto& exportEntry : binary->exported_functions())
-        {
-            spdlog::info("  Export - {}::{} ({:X})", targetFilename, exportEntry.name(), exportEntry.address());
-        }
-        if (binary->exported_functions().empty())
-        {
-            spdlog::info("  No exported functions found!");
-        }
-
-        return 0;
+        server requests(parser, job_from_args, cachedTargets);
+        return requests.run(std::cin, stdout);
     }
 
-    if (!parser.has_arg("symbol"))
+    if (parser.has_arg("manifest"))
     {
-        spdlog::error("No symbol specified! Use --symbol:DLL_PATH::FUNCTION_NAME to specify the DLL and function!!");
-        return 1;
-    }
-
-    if (!parser.has_arg("save")) {
-        std::string saveFileName = std::filesystem::path(target).filename().string();
-        std::string extension = saveFileName.substr(saveFileName.find_last_of("."));
-        saveFileName = saveFileName.substr(0, saveFileName.find_last_of("."));
-
-        std::string saveFileDir = std::filesystem::path(target).parent_path().string();
-        if (!saveFileDir.empty() && saveFileDir.back() != '\\')
+        if (format != "text")
         {
-            saveFileDir += "\\";
-        }
-        std::string saveFilePath = saveFileDir + saveFileName + "_modified" + extension;
-        parser.add_arg("save", saveFilePath);
-        spdlog::warn("No save path specified! Defaulting to: {}", saveFilePath);
-    } else {
-        std::string saveFileName = std::filesystem::path(parser.get_arg_value("save")).filename().string();
-        std::string saveFileDir = std::filesystem::path(parser.get_arg_value("save")).parent_path().string();
-        if (!util::file_exists(saveFileDir))
-        {
-            spdlog::error("The specified save directory does not exist!");
+            spdlog::error(":: --format can't be combined with --manifest, the jobs would interleave their output");
             return 1;
         }
-        spdlog::info("Saving to: {}", parser.get_arg_value("save"));
+        return run_batch(parser, *console);
     }
 
-    std::string saveTarget = parser.get_arg_value("save");
-    std::string dllToLoad = parser.get_arg_value("symbol");
-    auto dllAndFunction = util::split_string_once(dllToLoad, "::");
-    std::string dllPath = dllAndFunction.first;
-    std::string functionName = dllAndFunction.second;
-
-    if (dllPath.empty() || functionName.empty())
+    if (!parser.has_arg("target") || !parser.has_arg("action"))
     {
-        spdlog::error("Invalid DLL and function format! Use 'DLL_PATH::FUNCTION_NAME'.");
+        spdlog::error(":: Required argument \"{}\" is missing!", parser.has_arg("target") ? "action" : "target");
+        parser.print_help();
         return 1;
     }
 
-    if (action == "remove")
+    injection_job job = job_from_args(parser);
+    if (parser.has_arg("symbols-file") && !injector::read_symbols_file(parser.get_arg_value("symbols-file"), job.symbols))
     {
-        // existing check isn't required for remove
-        // bc we aren't really using the dll itself
-        if (!parser.has_flag("force"))
-        {
-            spdlog::warn("WARNING: The remove action will likely not work correctly.");
-            spdlog::warn("I highly recommend to just restore the original file.");
-            spdlog::warn("\033[31mIf you're absolutely sure you want to continue, append the --force flag to your args and run this again.\033[0m");
-            return 1;
-        }
-        spdlog::info("Attempting to remove import: {}::{}", dllPath, functionName);
-
-        bool found = false;
-        for (auto& import : imports)
-        {
-            if (import.name() == dllPath)
-            {
-                spdlog::debug("Matching DLL found!");
-                auto entries = import.entries();
-                if (entries.empty())
-                {
-                    spdlog::critical("No entries found for DLL: {}", dllPath);
-                    found = false;
-                    break;
-                }
-
-                for (auto& entry : entries)
-                {
-                    if (entry.name() == functionName)
-                    {
-                        spdlog::debug("Matching function found!");
-                        found = true;
-                        break;
-                    }
-                }
-
-                if (found)
-                {
-                    spdlog::info("Removing import: {}::{}", dllPath, functionName);
-                    import.remove_entry(functionName);
-                    spdlog::info("Import removed successfully!");
-                    break;
-                }
-            }
-        }
-
-        if (!found)
-        {
-            spdlog::error("Failed to remove import: {}::{}", dllPath, functionName);
-            return 1;
-        }
-
-        if (util::is_file_locked(saveTarget))
-        {
-            spdlog::error("The file to save to is locked! Please close any applications that may be using it.");
-            spdlog::critical("Failed to save the modified file.");
-            return 1;
-        }
-
-        std::ofstream output(saveTarget, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
-        if (!output.is_open())
-        {
-            spdlog::critical("Failed to open output file!");
-            return 1;
-        }
-        binary->write(output, builderConfig);
-        output.close();
-        spdlog::info("Modified binary saved to: {}", saveTarget);
-        return 0;
+        spdlog::critical("Failed to read the symbols file: {}", parser.get_arg_value("symbols-file"));
+        return 1;
     }
-
-    if (action == "add")
+    bool machineReadable = job.format != "text";
+    if (machineReadable)
     {
-        spdlog::info("Attempting to add import: {}::{}", dllPath, functionName);
-
-        std::string moduleName = std::filesystem::path(dllPath).filename().string();
-
-        for (const auto& import : imports)
-        {
-            if (import.name() == moduleName)
-            {
-                for (const auto& entry : import.entries())
-                {
-                    if (entry.name() == functionName)
-                    {
-                        spdlog::error("Import already exists: {}::{}", moduleName, functionName);
-                        return 1;
-                    }
-                }
-            }
-        }
-
-        if (!parser.has_arg("force"))
-        {
-            if (!util::file_exists(dllPath))
-            {
-                spdlog::error("The specified DLL does not exist!");
-                return 1;
-            }
-            auto dllBinary = LIEF::PE::Parser::parse(dllPath);
-            if (!dllBinary)
-            {
-                spdlog::error("Failed to parse the DLL file!");
-                return 1;
-            }
-            auto dllExports = dllBinary->exported_functions();
-
-            bool found = false;
-            for (const auto& exportEntry : dllExports)
-            {
-                if (exportEntry.name() == functionName)
-                {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found)
-            {
-                spdlog::error("The specified function does not exist in the DLL!");
-                spdlog::info("TIP: You can also list exports for this DLL by typing --action:list --target:" + dllPath.contains(" ") ? "\"" + dllPath + "\"" : dllPath);
-                spdlog::warn("If you are sure the function exists, append --force to override this check.");
-                return 1;
-            }
-        }
-
-        std::string dllDirectory = std::filesystem::path(dllPath).parent_path().string();
-        std::string prgDir = std::filesystem::path(target).parent_path().string();
-        if (dllDirectory != prgDir)
-        {
-            spdlog::warn("The DLL is not in the same directory as the target file!");
-            spdlog::warn("If the program fails to launch, you MUST copy the DLL to the same directory as the target file!");
-        }
-
-        if (binary->has_import(moduleName))
-        {
-            spdlog::warn("Library already exists, using existing module");
-            auto lib = binary->get_import(moduleName);
-            lib->add_entry(LIEF::PE::ImportEntry(functionName));
-            spdlog::info("Import added successfully!");
-        } else
-        {
-            spdlog::info("Adding new import: {}::{}", moduleName, functionName);
-            auto& lib = binary->add_import(moduleName);
-            lib.add_entry(LIEF::PE::ImportEntry(functionName));
-            spdlog::info("Import added successfully!");
-        }
-
-        std::ofstream output(saveTarget, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
-        if (!output.is_open())
-        {
-            spdlog::critical("Failed to open output file!");
-            return 1;
-        }
-        binary->write(output, builderConfig);
-        output.close();
-        spdlog::info("Modified binary saved to: {}", saveTarget);
+        // keep stdout clean for the records
+        console->sinks() = { std::make_shared<spdlog::sinks::stderr_color_sink_mt>() };
+        console->set_pattern("\033[90m[\033[33m%T\033[90m] %^[%l]%$\033[0m %v");
     }
-
-
-    return 0;
+    job_result result = injector::run(job, *console, !machineReadable);
+    return result.success ? 0 : 1;
 }
@@ -0,0 +1,93 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "manifest.hpp"
+
+bool manifest::load(const std::string& path, const injection_job& defaults)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        spdlog::error("Failed to open manifest: {}", path);
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    bool ok = true;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+        line = util::trim_string(line);
+        if (line.empty() || line.front() == '#') continue;
+
+        injection_job job;
+        std::string error;
+        if (!parse_line(line, defaults, job, error))
+        {
+            spdlog::error(":: Manifest line {}: {}", lineNumber, error);
+            ok = false;
+            continue;
+        }
+        jobs.push_back(std::move(job));
+    }
+    return ok;
+}
+
+bool manifest::parse_line(const std::string& line, const injection_job& defaults, injection_job& job, std::string& error)
+{
+    std::vector<std::string> columns = util::split_string(line, "|");
+    for (auto& column : columns)
+    {
+        column = util::trim_string(column);
+    }
+
+    if (columns.size() < 2 || columns.size() > 5)
+    {
+        error = "expected TARGET|ACTION|SYMBOL|SAVE|OPTIONS";
+        return false;
+    }
+
+    job = defaults;
+    job.target = columns[0];
+    job.action = columns[1];
+    job.symbols.clear();
+    if (columns.size() > 2 && !columns[2].empty())
+    {
+        for (const auto& symbol : util::split_string(columns[2], ";"))
+        {
+            std::string trimmed = util::trim_string(symbol);
+            if (!trimmed.empty()) job.symbols.push_back(trimmed);
+        }
+    }
+    job.save = columns.size() > 3 ? columns[3] : "";
+    if (columns.size() > 4 && !columns[4].empty())
+    {
+        for (const auto& option : util::split_string(columns[4], ","))
+        {
+            std::string name = util::trim_string(option);
+            if (name == "force") job.force = true;
+            else if (name == "rebuild") job.rebuild = true;
+            else if (name == "delay-load") job.delayLoad = true;
+            else if (name == "by-ordinal") job.byOrdinal = true;
+            else
+            {
+                error = "unknown option \"" + name + "\"";
+                return false;
+            }
+        }
+    }
+
+    if (job.target.empty())
+    {
+        error = "missing target";
+        return false;
+    }
+    if (!injector::is_valid_action(job.action))
+    {
+        error = "invalid action \"" + job.action + "\"";
+        return false;
+    }
+    return true;
+}
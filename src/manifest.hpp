@@ -0,0 +1,18 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include "injector.hpp"
+
+// one job per line: TARGET|ACTION|SYMBOL|SAVE|OPTIONS
+// SYMBOL may hold several DLL::FUNCTION entries separated by ;, they're applied as one transaction
+// OPTIONS is a comma separated list of force/rebuild
+// trailing columns are optional, blank lines and lines starting with # are skipped
+class manifest {
+public:
+    std::vector<injection_job> jobs;
+
+    // every job starts out as a copy of defaults, so flags given on the command line apply to all of them
+    [[nodiscard]] bool load(const std::string& path, const injection_job& defaults);
+    [[nodiscard]] static bool parse_line(const std::string& line, const injection_job& defaults, injection_job& job, std::string& error);
+};
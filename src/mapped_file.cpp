@@ -0,0 +1,172 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mapped_file::~mapped_file()
+{
+    close();
+}
+
+mapped_file::mapped_file(mapped_file&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        view = std::exchange(other.view, nullptr);
+        length = std::exchange(other.length, 0);
+        lastError = std::move(other.lastError);
+        borrowed = std::exchange(other.borrowed, false);
+#ifdef _WIN32
+        fileHandle = std::exchange(other.fileHandle, nullptr);
+        mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#else
+        fd = std::exchange(other.fd, -1);
+#endif
+    }
+    return *this;
+}
+
+void mapped_file::borrow(std::span<const uint8_t> bytes)
+{
+    close();
+    view = bytes.data();
+    length = bytes.size();
+    borrowed = true;
+}
+
+#ifdef _WIN32
+
+bool mapped_file::open(const std::string& path)
+{
+    close();
+
+    HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        lastError = "failed to open file";
+        return false;
+    }
+    fileHandle = hFile;
+
+    // GetFileSize caps out at 4 GB, the Ex variant doesn't
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize))
+    {
+        lastError = "failed to get file size";
+        close();
+        return false;
+    }
+    if (fileSize.QuadPart == 0)
+    {
+        lastError = "file is empty";
+        close();
+        return false;
+    }
+
+    HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (hMapping == nullptr)
+    {
+        lastError = "failed to create file mapping";
+        close();
+        return false;
+    }
+    mappingHandle = hMapping;
+
+    void* mapped = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    if (mapped == nullptr)
+    {
+        lastError = "failed to map view of file";
+        close();
+        return false;
+    }
+
+    view = static_cast<const uint8_t*>(mapped);
+    length = static_cast<uint64_t>(fileSize.QuadPart);
+    return true;
+}
+
+void mapped_file::close()
+{
+    if (borrowed) view = nullptr;
+    borrowed = false;
+    if (view) UnmapViewOfFile(view);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+    view = nullptr;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+    length = 0;
+}
+
+#else
+
+bool mapped_file::open(const std::string& path)
+{
+    close();
+
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        lastError = std::string("failed to open file: ") + std::strerror(errno);
+        return false;
+    }
+
+    struct stat info {};
+    if (fstat(fd, &info) != 0)
+    {
+        lastError = std::string("failed to get file size: ") + std::strerror(errno);
+        close();
+        return false;
+    }
+    if (info.st_size == 0)
+    {
+        lastError = "file is empty";
+        close();
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED)
+    {
+        lastError = std::string("failed to map file: ") + std::strerror(errno);
+        close();
+        return false;
+    }
+
+    view = static_cast<const uint8_t*>(mapped);
+    length = static_cast<uint64_t>(info.st_size);
+    return true;
+}
+
+void mapped_file::close()
+{
+    if (borrowed) view = nullptr;
+    borrowed = false;
+    if (view) munmap(const_cast<uint8_t*>(view), static_cast<size_t>(length));
+    if (fd >= 0) ::close(fd);
+    view = nullptr;
+    fd = -1;
+    length = 0;
+}
+
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include <cstdint>
+#include <span>
+#include <string>
+
+// read-only view of a whole file, backed by mmap on posix and a file mapping on windows
+// the view stays valid until the object is closed or destroyed, nothing is copied
+class mapped_file {
+public:
+    mapped_file() = default;
+    ~mapped_file();
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    mapped_file(mapped_file&& other) noexcept;
+    mapped_file& operator=(mapped_file&& other) noexcept;
+
+    [[nodiscard]] bool open(const std::string& path);
+    // views memory owned by someone else (a server's cached copy of the file), close() just lets go of it
+    void borrow(std::span<const uint8_t> bytes);
+    void close();
+
+    [[nodiscard]] bool is_open() const { return view != nullptr; }
+    [[nodiscard]] const uint8_t* data() const { return view; }
+    [[nodiscard]] uint64_t size() const { return length; }
+    [[nodiscard]] std::span<const uint8_t> bytes() const { return { view, static_cast<size_t>(length) }; }
+    [[nodiscard]] const std::string& error() const { return lastError; }
+
+private:
+    const uint8_t* view = nullptr;
+    uint64_t length = 0;
+    std::string lastError;
+    bool borrowed = false;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
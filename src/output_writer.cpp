@@ -0,0 +1,139 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "output_writer.hpp"
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+
+output_writer::output_writer(size_t capacity) : buffer(capacity)
+{
+}
+
+output_writer::~output_writer()
+{
+    (void)close();
+}
+
+bool output_writer::open(const std::string& path)
+{
+    (void)close();
+    if (path.empty())
+    {
+        file = stdout;
+        ownsFile = false;
+        return true;
+    }
+
+    file = std::fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        lastError = "failed to open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    ownsFile = true;
+    // we already buffer everything, a second copy in the C runtime doesn't help
+    std::setvbuf(file, nullptr, _IONBF, 0);
+    return true;
+}
+
+void output_writer::attach(std::FILE* stream)
+{
+    (void)close();
+    file = stream;
+    ownsFile = false;
+}
+
+bool output_writer::close()
+{
+    if (!file) return true;
+    bool ok = flush();
+    if (ownsFile && std::fclose(file) != 0 && ok)
+    {
+        lastError = "failed to close the output file";
+        ok = false;
+    }
+    file = nullptr;
+    ownsFile = false;
+    return ok;
+}
+
+bool output_writer::flush()
+{
+    if (!file || used == 0) return lastError.empty();
+    size_t written = std::fwrite(buffer.data(), 1, used, file);
+    bool ok = written == used;
+    used = 0;
+    if (!ok && lastError.empty()) lastError = "failed to write the output";
+    if (!ownsFile) std::fflush(file);
+    return ok && lastError.empty();
+}
+
+void output_writer::reserve(size_t size)
+{
+    if (used + size <= buffer.size()) return;
+    (void)flush();
+    // a single piece bigger than the whole buffer, let it grow rather than splitting it
+    if (size > buffer.size()) buffer.resize(size);
+}
+
+void output_writer::write(std::string_view text)
+{
+    reserve(text.size());
+    std::memcpy(buffer.data() + used, text.data(), text.size());
+    used += text.size();
+}
+
+void output_writer::write(char c)
+{
+    reserve(1);
+    buffer[used++] = c;
+}
+
+void output_writer::write_uint(uint64_t value)
+{
+    reserve(20);
+    auto [end, ec] = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value);
+    used = static_cast<size_t>(end - buffer.data());
+}
+
+void output_writer::write_json_string(std::string_view text)
+{
+    write('"');
+    size_t start = 0;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        auto c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        // copy the plain run in one go, then the escape
+        write(text.substr(start, i - start));
+        start = i + 1;
+        switch (c)
+        {
+        case '"': write("\\\""); break;
+        case '\\': write("\\\\"); break;
+        case '\n': write("\\n"); break;
+        case '\r': write("\\r"); break;
+        case '\t': write("\\t"); break;
+        default:
+            {
+                char escape[7] = { '\\', 'u', '0', '0', "0123456789abcdef"[c >> 4], "0123456789abcdef"[c & 0xF], 0 };
+                write(std::string_view(escape, 6));
+            }
+        }
+    }
+    write(text.substr(start));
+    write('"');
+}
+
+void output_writer::write_tsv_field(std::string_view text)
+{
+    reserve(text.size());
+    for (char c : text)
+    {
+        buffer[used++] = c == '\t' || c == '\n' || c == '\r' ? ' ' : c;
+    }
+}
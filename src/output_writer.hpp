@@ -0,0 +1,46 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// large buffered sink for machine-readable output, stdout or a file
+// everything is formatted into one buffer and handed to the OS in big chunks, nothing goes through the logger
+class output_writer {
+public:
+    explicit output_writer(size_t capacity = 1 << 20);
+    ~output_writer();
+
+    output_writer(const output_writer&) = delete;
+    output_writer& operator=(const output_writer&) = delete;
+
+    // an empty path writes to stdout
+    [[nodiscard]] bool open(const std::string& path);
+    // writes to an already open stream like stderr, which is flushed but never closed
+    void attach(std::FILE* stream);
+    [[nodiscard]] bool close();
+    [[nodiscard]] bool flush();
+
+    void write(std::string_view text);
+    void write(char c);
+    void write_uint(uint64_t value);
+    // quoted and escaped
+    void write_json_string(std::string_view text);
+    // tabs and line breaks would split the row, they're replaced by spaces
+    void write_tsv_field(std::string_view text);
+
+    [[nodiscard]] const std::string& error() const { return lastError; }
+
+private:
+    void reserve(size_t size);
+
+    std::vector<char> buffer;
+    size_t used = 0;
+    std::FILE* file = nullptr;
+    bool ownsFile = false;
+    std::string lastError;
+};
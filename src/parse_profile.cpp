@@ -0,0 +1,83 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "parse_profile.hpp"
+
+struct parse_part {
+    const char* name;
+    bool LIEF::PE::ParserConfig::* flag;
+};
+
+constexpr parse_part PARSE_PARTS[] = {
+    { "imports", &LIEF::PE::ParserConfig::parse_imports },
+    { "exports", &LIEF::PE::ParserConfig::parse_exports },
+    { "resources", &LIEF::PE::ParserConfig::parse_rsrc },
+    { "relocations", &LIEF::PE::ParserConfig::parse_reloc },
+    { "signature", &LIEF::PE::ParserConfig::parse_signature },
+    { "exceptions", &LIEF::PE::ParserConfig::parse_exceptions },
+    { "arm64x", &LIEF::PE::ParserConfig::parse_arm64x_binary },
+};
+
+bool parse_profile::is_valid(const std::string& name)
+{
+    LIEF::PE::ParserConfig config;
+    return name == "auto" || name == "default" || name == "full" || parse_parts(name, config);
+}
+
+LIEF::PE::ParserConfig parse_profile::resolve(const std::string& name, const std::string& action, bool rebuild)
+{
+    if (name == "default") return LIEF::PE::ParserConfig::default_conf();
+    if (name == "full") return LIEF::PE::ParserConfig::all();
+    LIEF::PE::ParserConfig config;
+    if (name != "auto" && parse_parts(name, config)) return config;
+
+    // list reads exports straight from the mapping and add/remove patch the raw image,
+    // the parsed binary only backs the import index unless LIEF writes the output
+    if (rebuild) return parse_profile::rebuild();
+    config = none();
+    if (action == "list" || action == "add" || action == "remove") config.parse_imports = true;
+    return config;
+}
+
+LIEF::PE::ParserConfig parse_profile::rebuild()
+{
+    return LIEF::PE::ParserConfig::default_conf();
+}
+
+bool parse_profile::covers(const LIEF::PE::ParserConfig& config, const LIEF::PE::ParserConfig& needed)
+{
+    return std::ranges::all_of(PARSE_PARTS, [&](const parse_part& part) { return config.*part.flag || !(needed.*part.flag); });
+}
+
+std::string parse_profile::describe(const LIEF::PE::ParserConfig& config)
+{
+    std::string text;
+    for (const auto& part : PARSE_PARTS)
+    {
+        if (!(config.*part.flag)) continue;
+        if (!text.empty()) text += ", ";
+        text += part.name;
+    }
+    return text.empty() ? "headers only" : text;
+}
+
+bool parse_profile::parse_parts(const std::string& list, LIEF::PE::ParserConfig& config)
+{
+    config = none();
+    for (const auto& item : util::split_string(list, ","))
+    {
+        std::string name = util::trim_string(item);
+        auto part = std::ranges::find_if(PARSE_PARTS, [&name](const parse_part& entry) { return name == entry.name; });
+        if (part == std::end(PARSE_PARTS)) return false;
+        config.*part->flag = true;
+    }
+    return true;
+}
+
+LIEF::PE::ParserConfig parse_profile::none()
+{
+    LIEF::PE::ParserConfig config;
+    for (const auto& part : PARSE_PARTS) config.*part.flag = false;
+    return config;
+}
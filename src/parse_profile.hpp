@@ -0,0 +1,25 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include "util.hpp"
+
+// which parts of an image LIEF decodes, resources, relocations, the certificate and the exception table cost most of a
+// parse and only a full rebuild needs them back
+// "auto" picks per action, the other names are fixed profiles, anything else is a comma separated list of parts:
+// imports, exports, resources, relocations, signature, exceptions, arm64x
+class parse_profile {
+public:
+    [[nodiscard]] static bool is_valid(const std::string& name);
+    [[nodiscard]] static LIEF::PE::ParserConfig resolve(const std::string& name, const std::string& action, bool rebuild);
+    // what a LIEF rebuild has to start from so it writes back everything it found, LIEF's own default
+    [[nodiscard]] static LIEF::PE::ParserConfig rebuild();
+    // config parses at least the parts of needed
+    [[nodiscard]] static bool covers(const LIEF::PE::ParserConfig& config, const LIEF::PE::ParserConfig& needed);
+    // "imports, exports" for logs
+    [[nodiscard]] static std::string describe(const LIEF::PE::ParserConfig& config);
+
+private:
+    [[nodiscard]] static bool parse_parts(const std::string& list, LIEF::PE::ParserConfig& config);
+    [[nodiscard]] static LIEF::PE::ParserConfig none();
+};
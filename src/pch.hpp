@@ -9,7 +9,9 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <magic_enum.hpp>
 #include <filesystem>
 #include <fstream>
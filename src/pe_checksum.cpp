@@ -0,0 +1,314 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "pe_checksum.hpp"
+#include "mapped_file.hpp"
+#include "pe_reader.hpp"
+
+#include <fstream>
+#include <spdlog/fmt/fmt.h>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#define PE_CHECKSUM_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define PE_CHECKSUM_AVX2_TARGET
+#else
+#define PE_CHECKSUM_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PE_CHECKSUM_SSE2
+#endif
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define PE_CHECKSUM_NEON
+#include <arm_neon.h>
+#endif
+
+#ifdef PE_CHECKSUM_X86
+// avx2 needs the cpu and the os (ymm state saved on context switches)
+static bool checksum_has_avx2()
+{
+#ifdef _MSC_VER
+    int registers[4];
+    __cpuid(registers, 0);
+    if (registers[0] < 7) return false;
+    __cpuid(registers, 1);
+    if ((registers[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(registers, 7, 0);
+    return (registers[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+// the dwords are widened into 64-bit lanes, nothing can overflow below 2^32 dwords
+PE_CHECKSUM_AVX2_TARGET static uint64_t checksum_sum_avx2(const uint8_t* data, size_t size, size_t& done)
+{
+    __m256i zero = _mm256_setzero_si256();
+    __m256i first = zero;
+    __m256i second = zero;
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64)
+    {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+        first = _mm256_add_epi64(first, _mm256_unpacklo_epi32(a, zero));
+        second = _mm256_add_epi64(second, _mm256_unpackhi_epi32(a, zero));
+        first = _mm256_add_epi64(first, _mm256_unpacklo_epi32(b, zero));
+        second = _mm256_add_epi64(second, _mm256_unpackhi_epi32(b, zero));
+    }
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(first, second));
+    done = i;
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+#endif
+
+#ifdef PE_CHECKSUM_SSE2
+static uint64_t checksum_sum_sse2(const uint8_t* data, size_t size, size_t& done)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i first = zero;
+    __m128i second = zero;
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16));
+        first = _mm_add_epi64(first, _mm_unpacklo_epi32(a, zero));
+        second = _mm_add_epi64(second, _mm_unpackhi_epi32(a, zero));
+        first = _mm_add_epi64(first, _mm_unpacklo_epi32(b, zero));
+        second = _mm_add_epi64(second, _mm_unpackhi_epi32(b, zero));
+    }
+    alignas(16) uint64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_add_epi64(first, second));
+    done = i;
+    return lanes[0] + lanes[1];
+}
+#endif
+
+#ifdef PE_CHECKSUM_NEON
+static uint64_t checksum_sum_neon(const uint8_t* data, size_t size, size_t& done)
+{
+    // pairwise add-accumulate of the dwords straight into 64-bit lanes
+    uint64x2_t first = vdupq_n_u64(0);
+    uint64x2_t second = vdupq_n_u64(0);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        first = vpadalq_u32(first, vreinterpretq_u32_u8(vld1q_u8(data + i)));
+        second = vpadalq_u32(second, vreinterpretq_u32_u8(vld1q_u8(data + i + 16)));
+    }
+    done = i;
+    return vaddvq_u64(vaddq_u64(first, second));
+}
+#endif
+
+uint32_t pe_checksum::compute(std::span<const uint8_t> file, uint64_t checksumOffset)
+{
+    uint64_t sum = sum_words(file.data(), file.size());
+    // the field counts as zero, its bytes come back out of the unfolded sum exactly as sum_words added them:
+    // shifted by their place in the dword, except an odd last byte which was added on its own
+    for (uint64_t offset = checksumOffset; offset < checksumOffset + 4 && offset < file.size(); ++offset)
+    {
+        bool oddLastByte = file.size() % 2 != 0 && offset == file.size() - 1;
+        sum -= static_cast<uint64_t>(file[offset]) << (oddLastByte ? 0 : 8 * (offset % 4));
+    }
+    return fold(sum) + static_cast<uint32_t>(file.size());
+}
+
+const char* pe_checksum::kernel()
+{
+#ifdef PE_CHECKSUM_X86
+    static const bool avx2 = checksum_has_avx2();
+    if (avx2) return "avx2";
+#endif
+#if defined(PE_CHECKSUM_SSE2)
+    return "sse2";
+#elif defined(PE_CHECKSUM_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+// imagehlp's loop: one 16-bit word at a time with the carry folded straight back in, the field read as zero
+static uint32_t checksum_reference(const uint8_t* data, size_t size, uint64_t checksumOffset)
+{
+    auto byte = [&](size_t at) -> uint32_t {
+        return at >= size || (at >= checksumOffset && at < checksumOffset + 4) ? 0 : data[at];
+    };
+    uint32_t sum = 0;
+    for (size_t i = 0; i < size; i += 2)
+    {
+        sum += byte(i) | (byte(i + 1) << 8);
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return sum + static_cast<uint32_t>(size);
+}
+
+bool pe_checksum::self_check(std::string& error)
+{
+    using kernel_function = uint64_t (*)(const uint8_t*, size_t, size_t&);
+    std::vector<std::pair<const char*, kernel_function>> kernels;
+#ifdef PE_CHECKSUM_X86
+    if (checksum_has_avx2()) kernels.emplace_back("avx2", checksum_sum_avx2);
+#endif
+#ifdef PE_CHECKSUM_SSE2
+    kernels.emplace_back("sse2", checksum_sum_sse2);
+#endif
+#ifdef PE_CHECKSUM_NEON
+    kernels.emplace_back("neon", checksum_sum_neon);
+#endif
+
+    // every length around the block sizes, a few big ones, all of them also one byte off alignment
+    std::vector<size_t> sizes;
+    for (size_t size = 0; size <= 260; ++size) sizes.push_back(size);
+    for (size_t size : { 4093, 4094, 4095, 4096, 4097, 4098, 4099, 65535, 65536, 65537, (1 << 20) + 3 }) sizes.push_back(size);
+
+    std::vector<uint8_t> buffer(sizes.back() + 1);
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (bool saturated : { false, true })
+    {
+        // all ones carries on every add, random bytes cover everything else
+        for (auto& value : buffer)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            value = saturated ? 0xFF : static_cast<uint8_t>(state);
+        }
+        for (size_t shift : { 0, 1 })
+        {
+            for (size_t size : sizes)
+            {
+                const uint8_t* data = buffer.data() + shift;
+                uint64_t expected = sum_scalar(data, size);
+                for (const auto& [name, kernel] : kernels)
+                {
+                    size_t done = 0;
+                    uint64_t sum = kernel(data, size, done);
+                    if (done % 4 != 0 || done > size || sum + sum_scalar(data + done, size - done) != expected)
+                    {
+                        error = fmt::format("the {} kernel disagrees with the scalar sum on {} bytes at alignment {}", name, size, shift);
+                        return false;
+                    }
+                }
+
+                for (uint64_t offset : { uint64_t(0), uint64_t(1), uint64_t(2), uint64_t(3), uint64_t(size / 2), uint64_t(size - 4), uint64_t(size - 3),
+                         uint64_t(size - 2), uint64_t(size - 1) })
+                {
+                    if (offset >= size) continue;
+                    uint32_t value = compute({ data, size }, offset);
+                    uint32_t reference = checksum_reference(data, size, offset);
+                    if (value != reference)
+                    {
+                        error = fmt::format("compute() gives 0x{:08X} instead of 0x{:08X} on {} bytes at alignment {} with the field at {}", value, reference, size, shift,
+                            offset);
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool pe_checksum::refresh(const std::string& path, bool force, bool& updated, std::string& error)
+{
+    updated = false;
+    mapped_file file;
+    if (!file.open(path))
+    {
+        error = file.error();
+        return false;
+    }
+    pe_reader reader(file.bytes());
+    if (!reader.parse())
+    {
+        error = reader.error();
+        return false;
+    }
+    uint64_t offset = reader.optional_header_offset() + pe::OPTIONAL_CHECKSUM;
+    uint32_t stored = pe::read<uint32_t>(file.data() + offset);
+    if (stored == 0 && !force) return true;
+    uint32_t value = compute(file.bytes(), offset);
+    // the mapping has to go before the file can be written on windows
+    file.close();
+    if (value == stored) return true;
+    updated = true;
+    return store(path, offset, value, error);
+}
+
+bool pe_checksum::store(const std::string& path, uint64_t checksumOffset, uint32_t value, std::string& error)
+{
+    std::fstream output(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (!output.is_open())
+    {
+        error = "failed to open " + path + " to store the checksum";
+        return false;
+    }
+    uint8_t bytes[sizeof(value)];
+    pe::write(bytes, value);
+    output.seekp(static_cast<std::streamoff>(checksumOffset));
+    output.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+    output.flush();
+    if (!output.good())
+    {
+        error = "failed to store the checksum in " + path;
+        return false;
+    }
+    return true;
+}
+
+uint64_t pe_checksum::sum_words(const uint8_t* data, size_t size)
+{
+    // the kernels stop at their block size, the scalar loop takes the rest (a multiple of 4 in, so its words stay aligned)
+    size_t done = 0;
+    uint64_t sum = 0;
+#ifdef PE_CHECKSUM_X86
+    static const bool avx2 = checksum_has_avx2();
+    if (avx2) sum = checksum_sum_avx2(data, size, done);
+#ifdef PE_CHECKSUM_SSE2
+    else sum = checksum_sum_sse2(data, size, done);
+#endif
+#elif defined(PE_CHECKSUM_NEON)
+    sum = checksum_sum_neon(data, size, done);
+#endif
+    return sum + sum_scalar(data + done, size - done);
+}
+
+uint64_t pe_checksum::sum_scalar(const uint8_t* data, size_t size)
+{
+    uint64_t first = 0;
+    uint64_t second = 0;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        first += pe::read<uint32_t>(data + i);
+        second += pe::read<uint32_t>(data + i + 4);
+    }
+    uint64_t sum = first + second;
+    if (i + 4 <= size)
+    {
+        sum += pe::read<uint32_t>(data + i);
+        i += 4;
+    }
+    if (i + 2 <= size)
+    {
+        sum += pe::read<uint16_t>(data + i);
+        i += 2;
+    }
+    // an odd last byte is a word with a zero high byte
+    if (i < size) sum += data[i];
+    return sum;
+}
+
+uint32_t pe_checksum::fold(uint64_t sum)
+{
+    while (sum >> 16) sum = (sum & 0xFFFF) + (sum >> 16);
+    return static_cast<uint32_t>(sum);
+}
@@ -0,0 +1,32 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include <cstdint>
+#include <span>
+#include <string>
+
+// the optional header CheckSum the way imagehlp's CheckSumMappedFile computes it: the 16-bit ones' complement sum
+// of the whole file with the field itself read as zero, folded to 16 bits, plus the file size
+// 2^16 is 1 mod 0xFFFF, so the words can be added 32 bits at a time into wide lanes and folded once at the end,
+// which is what the vector kernels do (avx2 picked at runtime, sse2/neon where they're baseline, scalar otherwise)
+class pe_checksum {
+public:
+    // checksumOffset is the file offset of the CheckSum field
+    [[nodiscard]] static uint32_t compute(std::span<const uint8_t> file, uint64_t checksumOffset);
+    // the kernel compute() uses on this machine: "avx2", "sse2", "neon" or "scalar"
+    [[nodiscard]] static const char* kernel();
+    // every kernel this machine can run against the scalar sum, and compute() against a word by word reference,
+    // over odd and unaligned lengths and a field up to the very end of the file; false with the first mismatch
+    [[nodiscard]] static bool self_check(std::string& error);
+
+    // rewrites the checksum of a written image, one linked without one (CheckSum 0) keeps it unless force is set
+    // updated is set when the stored value changed
+    [[nodiscard]] static bool refresh(const std::string& path, bool force, bool& updated, std::string& error);
+    [[nodiscard]] static bool store(const std::string& path, uint64_t checksumOffset, uint32_t value, std::string& error);
+
+private:
+    [[nodiscard]] static uint64_t sum_words(const uint8_t* data, size_t size);
+    [[nodiscard]] static uint64_t sum_scalar(const uint8_t* data, size_t size);
+    [[nodiscard]] static uint32_t fold(uint64_t sum);
+};
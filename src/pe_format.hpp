@@ -0,0 +1,269 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include <cstdint>
+#include <cstring>
+
+#define RVA_OFFSET(header) \
+(header->VirtualAddress - header->PointerToRawData)
+
+// portable copies of the on-disk PE structures so the raw readers/writers don't need winnt.h
+// field names follow winnt.h so RVA_OFFSET and friends work on either
+namespace pe {
+    constexpr uint16_t DOS_MAGIC = 0x5A4D;        // MZ
+    constexpr uint32_t NT_SIGNATURE = 0x00004550; // PE\0\0
+    constexpr uint16_t PE32_MAGIC = 0x10B;
+    constexpr uint16_t PE32_PLUS_MAGIC = 0x20B;
+
+    constexpr uint32_t DIRECTORY_EXPORT = 0;
+    constexpr uint32_t DIRECTORY_IMPORT = 1;
+    constexpr uint32_t DIRECTORY_RESOURCE = 2;
+    constexpr uint32_t DIRECTORY_SECURITY = 4;
+    constexpr uint32_t DIRECTORY_BASERELOC = 5;
+    constexpr uint32_t DIRECTORY_BOUND_IMPORT = 11;
+    constexpr uint32_t DIRECTORY_IAT = 12;
+    constexpr uint32_t DIRECTORY_DELAY_IMPORT = 13;
+    constexpr uint32_t NUMBER_OF_DIRECTORIES = 16;
+
+    constexpr uint32_t SCN_CNT_CODE = 0x00000020;
+    constexpr uint32_t SCN_CNT_INITIALIZED_DATA = 0x00000040;
+    constexpr uint32_t SCN_MEM_DISCARDABLE = 0x02000000;
+    constexpr uint32_t SCN_MEM_EXECUTE = 0x20000000;
+    constexpr uint32_t SCN_MEM_READ = 0x40000000;
+    constexpr uint32_t SCN_MEM_WRITE = 0x80000000;
+
+    // what the loader maps and commits in, independent of SectionAlignment
+    constexpr uint32_t LOADER_PAGE_SIZE = 0x1000;
+
+    constexpr uint16_t FILE_RELOCS_STRIPPED = 0x0001;
+    constexpr uint16_t MACHINE_I386 = 0x014C;
+    constexpr uint16_t MACHINE_AMD64 = 0x8664;
+
+    constexpr uint16_t DLLCHARACTERISTICS_DYNAMIC_BASE = 0x0040;
+    constexpr uint16_t DLLCHARACTERISTICS_NO_BIND = 0x0800;
+
+    // TimeDateStamp of an import descriptor bound through the bound import directory
+    constexpr uint32_t BOUND_IMPORT_NEW_STYLE = 0xFFFFFFFF;
+
+    constexpr uint16_t REL_BASED_ABSOLUTE = 0;
+    constexpr uint16_t REL_BASED_HIGHLOW = 3;
+    constexpr uint16_t REL_BASED_DIR64 = 10;
+
+    // delay descriptors hold RVAs when set, VAs in the old VC6 format
+    constexpr uint32_t DELAY_ATTRIBUTE_RVA = 0x1;
+
+    constexpr uint32_t ORDINAL_FLAG32 = 0x80000000;
+    constexpr uint64_t ORDINAL_FLAG64 = 0x8000000000000000ull;
+
+    struct dos_header {
+        uint16_t e_magic;
+        uint16_t e_cblp;
+        uint16_t e_cp;
+        uint16_t e_crlc;
+        uint16_t e_cparhdr;
+        uint16_t e_minalloc;
+        uint16_t e_maxalloc;
+        uint16_t e_ss;
+        uint16_t e_sp;
+        uint16_t e_csum;
+        uint16_t e_ip;
+        uint16_t e_cs;
+        uint16_t e_lfarlc;
+        uint16_t e_ovno;
+        uint16_t e_res[4];
+        uint16_t e_oemid;
+        uint16_t e_oeminfo;
+        uint16_t e_res2[10];
+        uint32_t e_lfanew;
+    };
+
+    struct file_header {
+        uint16_t Machine;
+        uint16_t NumberOfSections;
+        uint32_t TimeDateStamp;
+        uint32_t PointerToSymbolTable;
+        uint32_t NumberOfSymbols;
+        uint16_t SizeOfOptionalHeader;
+        uint16_t Characteristics;
+    };
+
+    struct data_directory {
+        uint32_t VirtualAddress;
+        uint32_t Size;
+    };
+
+    struct optional_header32 {
+        uint16_t Magic;
+        uint8_t MajorLinkerVersion;
+        uint8_t MinorLinkerVersion;
+        uint32_t SizeOfCode;
+        uint32_t SizeOfInitializedData;
+        uint32_t SizeOfUninitializedData;
+        uint32_t AddressOfEntryPoint;
+        uint32_t BaseOfCode;
+        uint32_t BaseOfData;
+        uint32_t ImageBase;
+        uint32_t SectionAlignment;
+        uint32_t FileAlignment;
+        uint16_t MajorOperatingSystemVersion;
+        uint16_t MinorOperatingSystemVersion;
+        uint16_t MajorImageVersion;
+        uint16_t MinorImageVersion;
+        uint16_t MajorSubsystemVersion;
+        uint16_t MinorSubsystemVersion;
+        uint32_t Win32VersionValue;
+        uint32_t SizeOfImage;
+        uint32_t SizeOfHeaders;
+        uint32_t CheckSum;
+        uint16_t Subsystem;
+        uint16_t DllCharacteristics;
+        uint32_t SizeOfStackReserve;
+        uint32_t SizeOfStackCommit;
+        uint32_t SizeOfHeapReserve;
+        uint32_t SizeOfHeapCommit;
+        uint32_t LoaderFlags;
+        uint32_t NumberOfRvaAndSizes;
+        data_directory DataDirectory[NUMBER_OF_DIRECTORIES];
+    };
+
+    struct optional_header64 {
+        uint16_t Magic;
+        uint8_t MajorLinkerVersion;
+        uint8_t MinorLinkerVersion;
+        uint32_t SizeOfCode;
+        uint32_t SizeOfInitializedData;
+        uint32_t SizeOfUninitializedData;
+        uint32_t AddressOfEntryPoint;
+        uint32_t BaseOfCode;
+        uint64_t ImageBase;
+        uint32_t SectionAlignment;
+        uint32_t FileAlignment;
+        uint16_t MajorOperatingSystemVersion;
+        uint16_t MinorOperatingSystemVersion;
+        uint16_t MajorImageVersion;
+        uint16_t MinorImageVersion;
+        uint16_t MajorSubsystemVersion;
+        uint16_t MinorSubsystemVersion;
+        uint32_t Win32VersionValue;
+        uint32_t SizeOfImage;
+        uint32_t SizeOfHeaders;
+        uint32_t CheckSum;
+        uint16_t Subsystem;
+        uint16_t DllCharacteristics;
+        uint64_t SizeOfStackReserve;
+        uint64_t SizeOfStackCommit;
+        uint64_t SizeOfHeapReserve;
+        uint64_t SizeOfHeapCommit;
+        uint32_t LoaderFlags;
+        uint32_t NumberOfRvaAndSizes;
+        data_directory DataDirectory[NUMBER_OF_DIRECTORIES];
+    };
+
+    struct section_header {
+        uint8_t Name[8];
+        uint32_t VirtualSize;
+        uint32_t VirtualAddress;
+        uint32_t SizeOfRawData;
+        uint32_t PointerToRawData;
+        uint32_t PointerToRelocations;
+        uint32_t PointerToLinenumbers;
+        uint16_t NumberOfRelocations;
+        uint16_t NumberOfLinenumbers;
+        uint32_t Characteristics;
+    };
+
+    struct import_descriptor {
+        uint32_t OriginalFirstThunk;
+        uint32_t TimeDateStamp;
+        uint32_t ForwarderChain;
+        uint32_t Name;
+        uint32_t FirstThunk;
+    };
+
+    struct delayload_descriptor {
+        uint32_t Attributes;
+        uint32_t DllNameRVA;
+        uint32_t ModuleHandleRVA;
+        uint32_t ImportAddressTableRVA;
+        uint32_t ImportNameTableRVA;
+        uint32_t BoundImportAddressTableRVA;
+        uint32_t UnloadInformationTableRVA;
+        uint32_t TimeDateStamp;
+    };
+
+    struct base_relocation_block {
+        uint32_t VirtualAddress;
+        uint32_t SizeOfBlock; // including this header and the 16-bit entries behind it
+    };
+
+    // OffsetModuleName is relative to the start of the bound import directory
+    struct bound_import_descriptor {
+        uint32_t TimeDateStamp;
+        uint16_t OffsetModuleName;
+        uint16_t NumberOfModuleForwarderRefs; // bound_forwarder_ref entries following this one
+    };
+
+    struct bound_forwarder_ref {
+        uint32_t TimeDateStamp;
+        uint16_t OffsetModuleName;
+        uint16_t Reserved;
+    };
+
+    struct export_directory {
+        uint32_t Characteristics;
+        uint32_t TimeDateStamp;
+        uint16_t MajorVersion;
+        uint16_t MinorVersion;
+        uint32_t Name;
+        uint32_t Base;
+        uint32_t NumberOfFunctions;
+        uint32_t NumberOfNames;
+        uint32_t AddressOfFunctions;
+        uint32_t AddressOfNames;
+        uint32_t AddressOfNameOrdinals;
+    };
+
+    static_assert(sizeof(dos_header) == 64);
+    static_assert(sizeof(file_header) == 20);
+    static_assert(sizeof(optional_header32) == 224);
+    static_assert(sizeof(optional_header64) == 240);
+    static_assert(sizeof(section_header) == 40);
+    static_assert(sizeof(import_descriptor) == 20);
+    static_assert(sizeof(delayload_descriptor) == 32);
+    static_assert(sizeof(base_relocation_block) == 8);
+    static_assert(sizeof(bound_import_descriptor) == 8);
+    static_assert(sizeof(bound_forwarder_ref) == 8);
+    static_assert(sizeof(export_directory) == 40);
+
+    // offsets shared by both optional header layouts
+    constexpr uint32_t OPTIONAL_SIZE_OF_INITIALIZED_DATA = 8;
+    constexpr uint32_t OPTIONAL_SECTION_ALIGNMENT = 32;
+    constexpr uint32_t OPTIONAL_FILE_ALIGNMENT = 36;
+    constexpr uint32_t OPTIONAL_SIZE_OF_IMAGE = 56;
+    constexpr uint32_t OPTIONAL_SIZE_OF_HEADERS = 60;
+    constexpr uint32_t OPTIONAL_CHECKSUM = 64;
+    constexpr uint32_t OPTIONAL_DLL_CHARACTERISTICS = 70;
+    constexpr uint32_t OPTIONAL_DATA_DIRECTORY32 = 96;
+    constexpr uint32_t OPTIONAL_DATA_DIRECTORY64 = 112;
+
+    // unaligned little-endian reads/writes straight from/into file bytes
+    template <typename T>
+    T read(const uint8_t* data)
+    {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void write(uint8_t* data, const T& value)
+    {
+        std::memcpy(data, &value, sizeof(T));
+    }
+
+    constexpr uint64_t align_up(uint64_t value, uint64_t alignment)
+    {
+        return alignment == 0 ? value : (value + alignment - 1) / alignment * alignment;
+    }
+}
@@ -0,0 +1,429 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include "pe_format.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct pe_export {
+    std::string_view name;      // empty for exports by ordinal only
+    uint16_t ordinal = 0;       // biased by the directory's Base, as imports refer to it
+    uint32_t rva = 0;
+    uint32_t hint = 0;          // index into the name pointer table
+    std::string_view forwarder; // "OTHER.Function" for forwarded exports
+};
+
+struct pe_import {
+    std::string_view module;
+    std::string_view function; // empty for imports by ordinal
+    bool isOrdinal = false;
+    uint16_t ordinal = 0;
+    uint16_t hint = 0;
+    uint32_t slotRva = 0;      // rva of this entry's slot in the IAT
+    uint32_t nameRva = 0;      // rva of the hint/name entry, 0 for imports by ordinal
+};
+
+// minimal read-only PE view straight over mapped bytes, no copies and no LIEF object
+// only the headers and section table are decoded up front, directories are walked on demand
+class pe_reader {
+public:
+    explicit pe_reader(std::span<const uint8_t> image) : image(image) {}
+
+    [[nodiscard]] bool parse()
+    {
+        if (image.size() < sizeof(pe::dos_header)) return fail("file is too small to be a PE image");
+        auto dos = pe::read<pe::dos_header>(image.data());
+        if (dos.e_magic != pe::DOS_MAGIC) return fail("missing MZ signature");
+
+        uint64_t ntOffset = dos.e_lfanew;
+        if (ntOffset + 4 + sizeof(pe::file_header) + 2 > image.size()) return fail("NT headers are out of bounds");
+        if (pe::read<uint32_t>(image.data() + ntOffset) != pe::NT_SIGNATURE) return fail("missing PE signature");
+
+        fileHeader = pe::read<pe::file_header>(image.data() + ntOffset + 4);
+        optionalOffset = static_cast<uint32_t>(ntOffset + 4 + sizeof(pe::file_header));
+        sectionTableOffset = optionalOffset + fileHeader.SizeOfOptionalHeader;
+        if (sectionTableOffset + static_cast<uint64_t>(fileHeader.NumberOfSections) * sizeof(pe::section_header) > image.size())
+            return fail("section table is out of bounds");
+
+        uint16_t magic = pe::read<uint16_t>(image.data() + optionalOffset);
+        if (magic != pe::PE32_MAGIC && magic != pe::PE32_PLUS_MAGIC) return fail("unknown optional header magic");
+        pe32Plus = magic == pe::PE32_PLUS_MAGIC;
+
+        uint32_t directoryTable = pe32Plus ? pe::OPTIONAL_DATA_DIRECTORY64 : pe::OPTIONAL_DATA_DIRECTORY32;
+        if (fileHeader.SizeOfOptionalHeader < directoryTable) return fail("optional header is truncated");
+        const uint8_t* optional = image.data() + optionalOffset;
+        imageBase = pe32Plus ? pe::read<uint64_t>(optional + 24) : pe::read<uint32_t>(optional + 28);
+        sectionAlignment = pe::read<uint32_t>(optional + pe::OPTIONAL_SECTION_ALIGNMENT);
+        fileAlignment = pe::read<uint32_t>(optional + pe::OPTIONAL_FILE_ALIGNMENT);
+        sizeOfImage = pe::read<uint32_t>(optional + pe::OPTIONAL_SIZE_OF_IMAGE);
+        sizeOfHeaders = pe::read<uint32_t>(optional + pe::OPTIONAL_SIZE_OF_HEADERS);
+
+        dataDirectoryOffset = optionalOffset + directoryTable;
+        uint32_t declared = pe::read<uint32_t>(optional + directoryTable - 4);
+        directoryCount = std::min<uint32_t>({ declared, pe::NUMBER_OF_DIRECTORIES,
+            static_cast<uint32_t>((fileHeader.SizeOfOptionalHeader - directoryTable) / sizeof(pe::data_directory)) });
+        for (uint32_t i = 0; i < directoryCount; ++i)
+        {
+            directories[i] = pe::read<pe::data_directory>(image.data() + dataDirectoryOffset + i * sizeof(pe::data_directory));
+        }
+
+        sectionHeaders.resize(fileHeader.NumberOfSections);
+        for (size_t i = 0; i < sectionHeaders.size(); ++i)
+        {
+            sectionHeaders[i] = pe::read<pe::section_header>(image.data() + sectionTableOffset + i * sizeof(pe::section_header));
+        }
+        // sections are laid out in ascending VA order by the linker, but don't trust that for the lookup table
+        sortedSections = sectionHeaders;
+        std::ranges::sort(sortedSections, {}, &pe::section_header::VirtualAddress);
+        return true;
+    }
+
+    [[nodiscard]] const std::string& error() const { return lastError; }
+    [[nodiscard]] std::span<const uint8_t> bytes() const { return image; }
+
+    [[nodiscard]] bool is_pe32_plus() const { return pe32Plus; }
+    [[nodiscard]] uint32_t slot_width() const { return pe32Plus ? 8 : 4; }
+    [[nodiscard]] const pe::file_header& file_header() const { return fileHeader; }
+    [[nodiscard]] uint64_t image_base() const { return imageBase; }
+    [[nodiscard]] uint32_t section_alignment() const { return sectionAlignment; }
+    [[nodiscard]] uint32_t file_alignment() const { return fileAlignment; }
+    [[nodiscard]] uint32_t size_of_image() const { return sizeOfImage; }
+    [[nodiscard]] uint32_t size_of_headers() const { return sizeOfHeaders; }
+    [[nodiscard]] uint32_t optional_header_offset() const { return optionalOffset; }
+    [[nodiscard]] uint32_t section_table_offset() const { return sectionTableOffset; }
+    [[nodiscard]] uint32_t data_directory_offset() const { return dataDirectoryOffset; }
+    [[nodiscard]] uint32_t directory_count() const { return directoryCount; }
+    [[nodiscard]] pe::data_directory directory(uint32_t index) const { return index < directoryCount ? directories[index] : pe::data_directory {}; }
+    // file order, as they appear in the section table
+    [[nodiscard]] const std::vector<pe::section_header>& sections() const { return sectionHeaders; }
+
+    [[nodiscard]] const pe::section_header* section_from_rva(uint32_t rva) const
+    {
+        // last section starting at or below the rva
+        auto it = std::ranges::upper_bound(sortedSections, rva, {}, &pe::section_header::VirtualAddress);
+        if (it == sortedSections.begin()) return nullptr;
+        const pe::section_header& section = *std::prev(it);
+        uint64_t end = static_cast<uint64_t>(section.VirtualAddress) + std::max(section.VirtualSize, section.SizeOfRawData);
+        return rva < end ? &section : nullptr;
+    }
+
+    // -1 when the rva isn't backed by file data
+    [[nodiscard]] int64_t offset_from_rva(uint32_t rva) const
+    {
+        if (rva < sizeOfHeaders) return rva < image.size() ? rva : -1;
+        const pe::section_header* section = section_from_rva(rva);
+        if (!section || rva - section->VirtualAddress >= section->SizeOfRawData) return -1;
+        uint32_t offset = rva - RVA_OFFSET(section);
+        return offset < image.size() ? static_cast<int64_t>(offset) : -1;
+    }
+
+    [[nodiscard]] const uint8_t* pointer_from_rva(uint32_t rva, size_t size) const
+    {
+        int64_t offset = offset_from_rva(rva);
+        if (offset < 0 || static_cast<uint64_t>(offset) + size > image.size()) return nullptr;
+        return image.data() + offset;
+    }
+
+    template <typename T>
+    [[nodiscard]] bool read_rva(uint32_t rva, T& value) const
+    {
+        const uint8_t* data = pointer_from_rva(rva, sizeof(T));
+        if (!data) return false;
+        value = pe::read<T>(data);
+        return true;
+    }
+
+    [[nodiscard]] std::string_view string_at(uint32_t rva) const
+    {
+        int64_t offset = offset_from_rva(rva);
+        if (offset < 0) return {};
+        auto begin = reinterpret_cast<const char*>(image.data() + offset);
+        size_t maxLength = image.size() - static_cast<size_t>(offset);
+        return { begin, strnlen(begin, maxLength) };
+    }
+
+    // the table a descriptor's functions are named from: its ILT, or the IAT of an unbound descriptor without one
+    // 0 when there is none, a bound IAT holds the resolved addresses instead of hint/name rvas
+    [[nodiscard]] static uint32_t name_table(const pe::import_descriptor& descriptor)
+    {
+        if (descriptor.OriginalFirstThunk != 0) return descriptor.OriginalFirstThunk;
+        return descriptor.TimeDateStamp == 0 ? descriptor.FirstThunk : 0;
+    }
+
+    // modules whose functions imports() leaves out because name_table() has nothing to read them from
+    [[nodiscard]] std::vector<std::string_view> unnamed_import_modules() const
+    {
+        std::vector<std::string_view> result;
+        for (const auto& descriptor : import_descriptors())
+        {
+            if (name_table(descriptor) == 0) result.push_back(string_at(descriptor.Name));
+        }
+        return result;
+    }
+
+    // every import in descriptor and thunk order, names are read from the ILT when there is one
+    [[nodiscard]] std::vector<pe_import> imports() const
+    {
+        std::vector<pe_import> result;
+        uint32_t width = slot_width();
+        for (const auto& descriptor : import_descriptors())
+        {
+            std::string_view module = string_at(descriptor.Name);
+            uint32_t thunks = name_table(descriptor);
+            if (thunks == 0) continue;
+            for (uint64_t index = 0; index < image.size() / width; ++index)
+            {
+                uint32_t thunkRva = static_cast<uint32_t>(thunks + index * width);
+                uint64_t thunk = 0;
+                if (!read_thunk(thunkRva, thunk) || thunk == 0) break;
+
+                pe_import import;
+                import.module = module;
+                import.slotRva = static_cast<uint32_t>(descriptor.FirstThunk + index * width);
+                if (!read_import_thunk(thunk, import)) break;
+                result.push_back(import);
+            }
+        }
+        return result;
+    }
+
+    // the import descriptor table up to its null terminator
+    [[nodiscard]] std::vector<pe::import_descriptor> import_descriptors() const
+    {
+        std::vector<pe::import_descriptor> result;
+        pe::data_directory entry = directory(pe::DIRECTORY_IMPORT);
+        if (entry.VirtualAddress == 0) return result;
+        // descriptor and thunk counts are bounded by the file size, a corrupt table can't spin forever
+        uint64_t limit = image.size() / sizeof(pe::import_descriptor);
+        for (uint64_t i = 0; i < limit; ++i)
+        {
+            pe::import_descriptor descriptor {};
+            if (!read_rva(static_cast<uint32_t>(entry.VirtualAddress + i * sizeof(pe::import_descriptor)), descriptor)) break;
+            if (descriptor.Name == 0 && descriptor.FirstThunk == 0 && descriptor.OriginalFirstThunk == 0) break;
+            result.push_back(descriptor);
+        }
+        return result;
+    }
+
+    // delay-load imports in descriptor order, slotRva is the entry in the delay IAT the thunks patch on first call
+    [[nodiscard]] std::vector<pe_import> delay_imports() const
+    {
+        std::vector<pe_import> result;
+        for (const auto& descriptor : delay_descriptors())
+        {
+            std::string_view module = string_at(descriptor.DllNameRVA);
+            for (uint64_t index = 0; index < image.size() / slot_width(); ++index)
+            {
+                uint64_t thunk = 0;
+                if (!read_thunk(static_cast<uint32_t>(descriptor.ImportNameTableRVA + index * slot_width()), thunk) || thunk == 0) break;
+                // the old format stores hint/name entries as VAs as well
+                bool byOrdinal = (thunk & (pe32Plus ? pe::ORDINAL_FLAG64 : pe::ORDINAL_FLAG32)) != 0;
+                if ((descriptor.Attributes & pe::DELAY_ATTRIBUTE_RVA) == 0 && !byOrdinal) thunk -= imageBase;
+                pe_import import;
+                import.module = module;
+                import.slotRva = static_cast<uint32_t>(descriptor.ImportAddressTableRVA + index * slot_width());
+                if (!read_import_thunk(thunk, import)) break;
+                result.push_back(import);
+            }
+        }
+        return result;
+    }
+
+    // the delay descriptor table, converted to RVAs when the image uses the old VA based format
+    [[nodiscard]] std::vector<pe::delayload_descriptor> delay_descriptors() const
+    {
+        std::vector<pe::delayload_descriptor> result;
+        pe::data_directory entry = directory(pe::DIRECTORY_DELAY_IMPORT);
+        if (entry.VirtualAddress == 0) return result;
+        for (uint64_t i = 0; i < image.size() / sizeof(pe::delayload_descriptor); ++i)
+        {
+            pe::delayload_descriptor descriptor {};
+            if (!read_rva(static_cast<uint32_t>(entry.VirtualAddress + i * sizeof(descriptor)), descriptor)) break;
+            if (descriptor.DllNameRVA == 0) break;
+            if ((descriptor.Attributes & pe::DELAY_ATTRIBUTE_RVA) == 0)
+            {
+                auto to_rva = [this](uint32_t& field) { if (field != 0) field = static_cast<uint32_t>(field - imageBase); };
+                to_rva(descriptor.DllNameRVA);
+                to_rva(descriptor.ModuleHandleRVA);
+                to_rva(descriptor.ImportAddressTableRVA);
+                to_rva(descriptor.ImportNameTableRVA);
+                to_rva(descriptor.BoundImportAddressTableRVA);
+                to_rva(descriptor.UnloadInformationTableRVA);
+            }
+            result.push_back(descriptor);
+        }
+        return result;
+    }
+
+    [[nodiscard]] bool has_exports() const
+    {
+        return read_export_directory(nullptr);
+    }
+
+    [[nodiscard]] std::string_view export_module_name() const
+    {
+        pe::export_directory directory {};
+        return read_export_directory(&directory) ? string_at(directory.Name) : std::string_view {};
+    }
+
+    // every export, named ones first in name pointer table order, ordinal-only ones after
+    [[nodiscard]] std::vector<pe_export> exports() const
+    {
+        std::vector<pe_export> result;
+        pe::export_directory directory {};
+        if (!read_export_directory(&directory)) return result;
+
+        std::vector<bool> named(directory.NumberOfFunctions, false);
+        result.reserve(directory.NumberOfFunctions);
+        for (uint32_t i = 0; i < directory.NumberOfNames; ++i)
+        {
+            pe_export entry;
+            if (!export_by_name_index(directory, i, entry)) continue;
+            uint32_t index = entry.ordinal - directory.Base;
+            if (index < named.size()) named[index] = true;
+            result.push_back(entry);
+        }
+        for (uint32_t index = 0; index < directory.NumberOfFunctions; ++index)
+        {
+            if (named[index]) continue;
+            pe_export entry;
+            if (!read_rva(directory.AddressOfFunctions + index * 4, entry.rva) || entry.rva == 0) continue;
+            entry.ordinal = static_cast<uint16_t>(directory.Base + index);
+            entry.forwarder = forwarder_of(entry.rva);
+            result.push_back(entry);
+        }
+        return result;
+    }
+
+    // binary search over the name pointer table, which the linker keeps sorted
+    [[nodiscard]] std::optional<pe_export> find_export(std::string_view name) const
+    {
+        pe::export_directory directory {};
+        if (!read_export_directory(&directory)) return std::nullopt;
+
+        uint32_t low = 0;
+        uint32_t high = directory.NumberOfNames;
+        while (low < high)
+        {
+            uint32_t middle = low + (high - low) / 2;
+            uint32_t nameRva = 0;
+            if (!read_rva(directory.AddressOfNames + middle * 4, nameRva)) return std::nullopt;
+            int order = string_at(nameRva).compare(name);
+            if (order == 0)
+            {
+                pe_export entry;
+                if (!export_by_name_index(directory, middle, entry)) return std::nullopt;
+                return entry;
+            }
+            if (order < 0) low = middle + 1;
+            else high = middle;
+        }
+        return std::nullopt;
+    }
+
+    [[nodiscard]] std::optional<pe_export> find_export(uint16_t ordinal) const
+    {
+        pe::export_directory directory {};
+        if (!read_export_directory(&directory) || ordinal < directory.Base) return std::nullopt;
+        uint32_t index = ordinal - directory.Base;
+        if (index >= directory.NumberOfFunctions) return std::nullopt;
+
+        pe_export entry;
+        entry.ordinal = ordinal;
+        if (!read_rva(directory.AddressOfFunctions + index * 4, entry.rva) || entry.rva == 0) return std::nullopt;
+        entry.forwarder = forwarder_of(entry.rva);
+        return entry;
+    }
+
+private:
+    [[nodiscard]] bool fail(const std::string& message)
+    {
+        lastError = message;
+        return false;
+    }
+
+    [[nodiscard]] bool read_export_directory(pe::export_directory* result) const
+    {
+        pe::data_directory entry = directory(pe::DIRECTORY_EXPORT);
+        if (entry.VirtualAddress == 0 || entry.Size == 0) return false;
+        pe::export_directory directory {};
+        if (!read_rva(entry.VirtualAddress, directory)) return false;
+        // counts are attacker controlled, the tables they describe have to fit in the file
+        if (directory.NumberOfFunctions > image.size() / 4 || directory.NumberOfNames > image.size() / 4) return false;
+        if (result) *result = directory;
+        return true;
+    }
+
+    [[nodiscard]] bool export_by_name_index(const pe::export_directory& directory, uint32_t nameIndex, pe_export& entry) const
+    {
+        uint32_t nameRva = 0;
+        uint16_t index = 0;
+        if (!read_rva(directory.AddressOfNames + nameIndex * 4, nameRva)) return false;
+        if (!read_rva(directory.AddressOfNameOrdinals + nameIndex * 2, index)) return false;
+        if (index >= directory.NumberOfFunctions) return false;
+
+        entry.name = string_at(nameRva);
+        entry.ordinal = static_cast<uint16_t>(directory.Base + index);
+        entry.hint = nameIndex;
+        if (!read_rva(directory.AddressOfFunctions + index * 4, entry.rva)) return false;
+        entry.forwarder = forwarder_of(entry.rva);
+        return true;
+    }
+
+    // an ILT/INT entry, either an ordinal or the rva of a hint/name entry
+    [[nodiscard]] bool read_import_thunk(uint64_t thunk, pe_import& import) const
+    {
+        if (thunk & (pe32Plus ? pe::ORDINAL_FLAG64 : pe::ORDINAL_FLAG32))
+        {
+            import.isOrdinal = true;
+            import.ordinal = static_cast<uint16_t>(thunk & 0xFFFF);
+            return true;
+        }
+        uint32_t hintRva = static_cast<uint32_t>(thunk & 0x7FFFFFFF);
+        if (!read_rva(hintRva, import.hint)) return false;
+        import.nameRva = hintRva;
+        import.function = string_at(hintRva + 2);
+        return true;
+    }
+
+    [[nodiscard]] bool read_thunk(uint32_t rva, uint64_t& value) const
+    {
+        if (pe32Plus) return read_rva(rva, value);
+        uint32_t narrow = 0;
+        if (!read_rva(rva, narrow)) return false;
+        value = narrow;
+        return true;
+    }
+
+    // exports pointing back into the export directory are "DLL.Function" strings
+    [[nodiscard]] std::string_view forwarder_of(uint32_t rva) const
+    {
+        pe::data_directory entry = directory(pe::DIRECTORY_EXPORT);
+        if (rva < entry.VirtualAddress || rva >= entry.VirtualAddress + entry.Size) return {};
+        return string_at(rva);
+    }
+
+    std::span<const uint8_t> image;
+    std::string lastError;
+
+    pe::file_header fileHeader {};
+    bool pe32Plus = false;
+    uint64_t imageBase = 0;
+    uint32_t optionalOffset = 0;
+    uint32_t sectionTableOffset = 0;
+    uint32_t dataDirectoryOffset = 0;
+    uint32_t directoryCount = 0;
+    uint32_t sectionAlignment = 0;
+    uint32_t fileAlignment = 0;
+    uint32_t sizeOfImage = 0;
+    uint32_t sizeOfHeaders = 0;
+    pe::data_directory directories[pe::NUMBER_OF_DIRECTORIES] {};
+    std::vector<pe::section_header> sectionHeaders;
+    std::vector<pe::section_header> sortedSections;
+};
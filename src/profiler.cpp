@@ -0,0 +1,104 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "profiler.hpp"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+void profiler::record(const char* name, double milliseconds)
+{
+    memory_usage memory = sample_memory();
+    std::lock_guard lock(mutex);
+    auto it = std::ranges::find(entries, std::string_view(name), &profile_phase::name);
+    if (it == entries.end())
+    {
+        profile_phase phase;
+        phase.name = name;
+        entries.push_back(std::move(phase));
+        it = std::prev(entries.end());
+    }
+    it->milliseconds += milliseconds;
+    ++it->calls;
+    it->memory = memory;
+}
+
+void profiler::print(spdlog::logger& log) const
+{
+    double total = 0.0;
+    log.info("Profile:");
+    log.info("  {:<12} {:>10} {:>6} {:>10} {:>10}", "phase", "ms", "calls", "rss MiB", "peak MiB");
+    for (const auto& phase : entries)
+    {
+        total += phase.milliseconds;
+        log.info("  {:<12} {:>10.3f} {:>6} {:>10.1f} {:>10.1f}", phase.name, phase.milliseconds, phase.calls,
+            static_cast<double>(phase.memory.residentBytes) / (1 << 20), static_cast<double>(phase.memory.peakBytes) / (1 << 20));
+    }
+    log.info("  {:<12} {:>10.3f}", "total", total);
+}
+
+void profiler::write_json(output_writer& out) const
+{
+    out.write("{\"profile\":[");
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const profile_phase& phase = entries[i];
+        out.write(i == 0 ? "{\"phase\":" : ",{\"phase\":");
+        out.write_json_string(phase.name);
+        out.write(",\"microseconds\":");
+        out.write_uint(static_cast<uint64_t>(phase.milliseconds * 1000.0));
+        out.write(",\"calls\":");
+        out.write_uint(phase.calls);
+        out.write(",\"rss\":");
+        out.write_uint(phase.memory.residentBytes);
+        out.write(",\"peak\":");
+        out.write_uint(phase.memory.peakBytes);
+        out.write('}');
+    }
+    out.write("]}\n");
+}
+
+memory_usage profiler::sample_memory()
+{
+    memory_usage usage;
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters {};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        usage.residentBytes = counters.WorkingSetSize;
+        usage.peakBytes = counters.PeakWorkingSetSize;
+    }
+#else
+    rusage resources {};
+    if (getrusage(RUSAGE_SELF, &resources) == 0)
+    {
+#ifdef __APPLE__
+        usage.peakBytes = static_cast<uint64_t>(resources.ru_maxrss);
+#else
+        usage.peakBytes = static_cast<uint64_t>(resources.ru_maxrss) * 1024;
+#endif
+    }
+#ifdef __linux__
+    // second field of statm is the resident page count
+    if (std::FILE* statm = std::fopen("/proc/self/statm", "r"))
+    {
+        unsigned long long pages = 0;
+        unsigned long long resident = 0;
+        if (std::fscanf(statm, "%llu %llu", &pages, &resident) == 2)
+        {
+            usage.residentBytes = resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+        }
+        std::fclose(statm);
+    }
+#endif
+#endif
+    return usage;
+}
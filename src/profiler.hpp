@@ -0,0 +1,61 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include "output_writer.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct memory_usage {
+    uint64_t residentBytes = 0; // current working set / rss, 0 where the platform can't tell
+    uint64_t peakBytes = 0;     // process high-water mark so far
+};
+
+struct profile_phase {
+    std::string name;
+    double milliseconds = 0.0;
+    uint32_t calls = 0;
+    memory_usage memory; // sampled when the phase last ended
+};
+
+// per-phase wall time and memory high-water marks for --profile
+// everything goes through a nullable pointer, with profiling off a scope is a null check and nothing else
+class profiler {
+public:
+    class scope {
+    public:
+        scope(profiler* owner, const char* name) : owner(owner), name(name)
+        {
+            if (owner) start = std::chrono::steady_clock::now();
+        }
+        ~scope()
+        {
+            if (owner) owner->record(name, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+
+    private:
+        profiler* owner;
+        const char* name;
+        std::chrono::steady_clock::time_point start {};
+    };
+
+    // phases with the same name are summed, e.g. the lock check on the target and on the save path
+    // safe to call from the job's helper tasks, phases running next to each other both show up in full
+    void record(const char* name, double milliseconds);
+
+    [[nodiscard]] const std::vector<profile_phase>& phases() const { return entries; }
+    void print(spdlog::logger& log) const;
+    void write_json(output_writer& out) const;
+
+    [[nodiscard]] static memory_usage sample_memory();
+
+private:
+    std::mutex mutex;
+    std::vector<profile_phase> entries;
+};
@@ -0,0 +1,256 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "result_cache.hpp"
+#include "hash.hpp"
+#include "mapped_file.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <sys/clonefile.h>
+#endif
+
+struct result_cache_header {
+    char magic[4];
+    uint32_t version;
+    uint64_t outputSize;
+    uint64_t contentHash;
+};
+
+static_assert(sizeof(result_cache_header) == 24);
+
+constexpr char RESULT_CACHE_MAGIC[4] = { 'S', 'I', 'R', 'C' };
+// part of every key, bump it when the patcher's output for the same inputs changes
+constexpr uint32_t RESULT_CACHE_VERSION = 1;
+
+std::string result_cache::default_directory()
+{
+    return util::cache_directory("results");
+}
+
+std::string result_cache::key(std::span<const uint8_t> target, const std::string& description)
+{
+    std::string text = "v" + std::to_string(RESULT_CACHE_VERSION) + "\n" + hash::to_hex(hash::xxh64(target.data(), target.size())) + "\n" + description;
+    return hash::to_hex(hash::xxh64(text.data(), text.size(), 0)) + hash::to_hex(hash::xxh64(text.data(), text.size(), RESULT_CACHE_VERSION));
+}
+
+bool result_cache::fetch(const std::string& key, const std::string& destination, std::string& method)
+{
+    lastError.clear();
+    lastCorrupted = false;
+    if (!verify(key))
+    {
+        if (lastCorrupted) remove_entry(key);
+        return false;
+    }
+
+    std::string entry = entry_path(key, ".out");
+    // the destination may be the target itself or a link to another entry, it's only replaced once the new file is complete
+    bool fetched = util::replace_file(destination, [this, &entry, &method](const std::string& temporaryPath) {
+        std::error_code linkError;
+        if (clone_file(entry, temporaryPath))
+        {
+            method = "reflink";
+        } else if (std::filesystem::create_hard_link(entry, temporaryPath, linkError), !linkError)
+        {
+            method = "hard link";
+        } else if (std::filesystem::copy_file(entry, temporaryPath, std::filesystem::copy_options::overwrite_existing, linkError))
+        {
+            method = "copy";
+        } else
+        {
+            lastError = linkError.message();
+            return false;
+        }
+        return true;
+    }, lastError);
+    if (!fetched)
+    {
+        lastError = "failed to materialize the cached output: " + lastError;
+        return false;
+    }
+
+    // the meta file's time is the entry's last use, eviction goes by it
+    std::error_code ec;
+    std::filesystem::last_write_time(entry_path(key, ".meta"), std::filesystem::file_time_type::clock::now(), ec);
+    return true;
+}
+
+bool result_cache::store(const std::string& key, const std::string& output)
+{
+    lastError.clear();
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+
+    // both files are written next to the entry and renamed over it so concurrent jobs never see a half written one
+    // the output goes first, a record without its output is a miss while an output without its record would be hashed for nothing
+    result_cache_header header {};
+    std::memcpy(header.magic, RESULT_CACHE_MAGIC, 4);
+    header.version = RESULT_CACHE_VERSION;
+    bool stored = util::replace_file(entry_path(key, ".out"), [this, &output, &header](const std::string& temporaryEntry) {
+        std::error_code copyError;
+        if (!clone_file(output, temporaryEntry) &&
+            !std::filesystem::copy_file(output, temporaryEntry, std::filesystem::copy_options::overwrite_existing, copyError))
+        {
+            lastError = "failed to copy the output: " + copyError.message();
+            return false;
+        }
+        // the hash is taken from the copy, not the output, so the entry is checked against what actually landed in the cache
+        mapped_file copy;
+        if (!copy.open(temporaryEntry))
+        {
+            lastError = copy.error();
+            return false;
+        }
+        header.outputSize = copy.size();
+        header.contentHash = hash::xxh64(copy.data(), static_cast<size_t>(copy.size()));
+        return true;
+    }, lastError);
+    stored = stored && util::replace_file(entry_path(key, ".meta"), std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(&header), sizeof(header)), lastError);
+    if (!stored)
+    {
+        lastError = "failed to store the cache entry: " + lastError;
+        return false;
+    }
+    return true;
+}
+
+void result_cache::evict()
+{
+    struct cache_entry {
+        std::string key;
+        std::filesystem::file_time_type lastUse;
+        uint64_t size;
+    };
+
+    std::error_code ec;
+    auto now = std::filesystem::file_time_type::clock::now();
+    std::vector<cache_entry> entries;
+    for (const auto& file : std::filesystem::directory_iterator(directory, ec))
+    {
+        std::filesystem::path path = file.path();
+        std::error_code entryError;
+        auto modified = file.last_write_time(entryError);
+        if (entryError) continue;
+        int64_t age = std::chrono::duration_cast<std::chrono::seconds>(now - modified).count();
+
+        // leftovers of a crashed store, anything still in flight is far younger than an hour
+        if (path.extension() == ".tmp")
+        {
+            if (age > 3600) std::filesystem::remove(path, entryError);
+            continue;
+        }
+        if (path.extension() == ".out")
+        {
+            std::filesystem::path meta = path;
+            meta.replace_extension(".meta");
+            if (!std::filesystem::exists(meta, entryError) && age > 3600) std::filesystem::remove(path, entryError);
+            continue;
+        }
+        if (path.extension() != ".meta") continue;
+
+        std::string key = path.stem().string();
+        if (age > maxAge)
+        {
+            remove_entry(key);
+            continue;
+        }
+        uint64_t size = std::filesystem::file_size(entry_path(key, ".out"), entryError);
+        entries.push_back({ key, modified, entryError ? 0 : size });
+    }
+
+    uint64_t total = 0;
+    for (const auto& entry : entries) total += entry.size;
+    if (total <= maxBytes) return;
+
+    std::ranges::sort(entries, {}, &cache_entry::lastUse);
+    for (const auto& entry : entries)
+    {
+        if (total <= maxBytes) break;
+        remove_entry(entry.key);
+        total -= entry.size;
+    }
+}
+
+std::string result_cache::entry_path(const std::string& key, const char* extension) const
+{
+    return (std::filesystem::path(directory) / (key + extension)).string();
+}
+
+bool result_cache::verify(const std::string& key)
+{
+    std::ifstream meta(entry_path(key, ".meta"), std::ios::binary);
+    if (!meta.is_open()) return false;
+    result_cache_header header {};
+    meta.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (meta.gcount() != sizeof(header) || std::memcmp(header.magic, RESULT_CACHE_MAGIC, 4) != 0 || header.version != RESULT_CACHE_VERSION)
+    {
+        lastCorrupted = true;
+        lastError = "the cache record is damaged";
+        return false;
+    }
+
+    mapped_file entry;
+    if (!entry.open(entry_path(key, ".out")))
+    {
+        lastCorrupted = true;
+        lastError = "the cached output is missing";
+        return false;
+    }
+    if (entry.size() != header.outputSize)
+    {
+        lastCorrupted = true;
+        lastError = "the cached output has the wrong size";
+        return false;
+    }
+    // a full hash on every hit, a hard linked output written to outside the tool changes the entry with it
+    if (hash::xxh64(entry.data(), static_cast<size_t>(entry.size())) != header.contentHash)
+    {
+        lastCorrupted = true;
+        lastError = "the cached output doesn't match its hash";
+        return false;
+    }
+    return true;
+}
+
+void result_cache::remove_entry(const std::string& key)
+{
+    std::error_code ec;
+    // the record first, without it the output is never handed out
+    std::filesystem::remove(entry_path(key, ".meta"), ec);
+    std::filesystem::remove(entry_path(key, ".out"), ec);
+}
+
+bool result_cache::clone_file(const std::string& source, const std::string& destination)
+{
+#if defined(__linux__)
+    int input = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (input < 0) return false;
+    int output = ::open(destination.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (output < 0)
+    {
+        ::close(input);
+        return false;
+    }
+    bool cloned = ::ioctl(output, FICLONE, input) == 0;
+    ::close(input);
+    ::close(output);
+    // btrfs/xfs share the extents, everything else refuses and the caller falls back
+    if (!cloned) ::unlink(destination.c_str());
+    return cloned;
+#elif defined(__APPLE__)
+    return ::clonefile(source.c_str(), destination.c_str(), 0) == 0;
+#else
+    // ReFS block cloning needs FSCTL_DUPLICATE_EXTENTS_TO_FILE per cluster range, a hard link is as cheap for a hit
+    return false;
+#endif
+}
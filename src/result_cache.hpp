@@ -0,0 +1,49 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include <cstdint>
+#include <span>
+#include <string>
+
+// finished add/remove outputs keyed by everything that went into them: the target bytes, the action and its options,
+// the symbols and the DLLs they name, so a rerun on the same inputs reuses the file instead of patching again
+// every entry is an exact copy of the output (<key>.out) plus a small record (<key>.meta) with its size and xxh64,
+// a hit is checked against both before it's handed out and a damaged entry is dropped and treated as a miss
+class result_cache {
+public:
+    // maxAge in seconds, the age of an entry is the time since it was stored or last hit
+    result_cache(std::string directory, uint64_t maxBytes, int64_t maxAge)
+        : directory(std::move(directory)), maxBytes(maxBytes), maxAge(maxAge) {}
+
+    [[nodiscard]] static std::string default_directory();
+
+    // the entry name for these inputs, 128 bits of two seeded xxh64 runs over the target hash and the description
+    // description holds everything but the target bytes, one line per input
+    [[nodiscard]] static std::string key(std::span<const uint8_t> target, const std::string& description);
+
+    // materializes the entry as destination: a reflink where the file system can share extents, a hard link where it
+    // can't, a copy across volumes. method says which one it was
+    // the new file is renamed over destination, which stays as it was when all three fail
+    [[nodiscard]] bool fetch(const std::string& key, const std::string& destination, std::string& method);
+    [[nodiscard]] bool store(const std::string& key, const std::string& output);
+    // drops entries older than maxAge, then the least recently used ones until the rest fits in maxBytes
+    void evict();
+
+    [[nodiscard]] const std::string& error() const { return lastError; }
+    // set by fetch when the entry existed but failed the check
+    [[nodiscard]] bool corrupted() const { return lastCorrupted; }
+
+private:
+    [[nodiscard]] std::string entry_path(const std::string& key, const char* extension) const;
+    [[nodiscard]] bool verify(const std::string& key);
+    void remove_entry(const std::string& key);
+    // copy-on-write clone, false where the platform or file system doesn't support one
+    [[nodiscard]] static bool clone_file(const std::string& source, const std::string& destination);
+
+    std::string directory;
+    uint64_t maxBytes;
+    int64_t maxAge;
+    std::string lastError;
+    bool lastCorrupted = false;
+};
@@ -0,0 +1,353 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "scan_index.hpp"
+#include "hash.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+struct scan_index_header {
+    char magic[4];
+    uint32_t version;
+    uint32_t fileCount;
+    uint32_t keyCount;
+    uint32_t forwardCount;
+    uint32_t postingCount;
+    uint32_t stringsSize;
+    uint32_t rootOffset;
+    uint32_t rootLength;
+    uint32_t reserved;
+};
+
+struct scan_index_file {
+    uint32_t pathOffset;
+    uint32_t pathLength;
+    uint64_t size;
+    int64_t modifiedTime;
+    uint32_t firstImport; // into the forward table, imports and exports of a file are back to back
+    uint32_t importCount;
+    uint32_t firstExport;
+    uint32_t exportCount;
+};
+
+struct scan_index_key {
+    uint32_t keyOffset;
+    uint32_t keyLength;
+    uint32_t firstImporter; // into the postings table
+    uint32_t importerCount;
+    uint32_t firstExporter;
+    uint32_t exporterCount;
+};
+
+static_assert(sizeof(scan_index_header) == 40);
+static_assert(sizeof(scan_index_file) == 40);
+static_assert(sizeof(scan_index_key) == 24);
+
+constexpr char SCAN_INDEX_MAGIC[4] = { 'S', 'I', 'S', 'I' };
+constexpr uint32_t SCAN_INDEX_VERSION = 1;
+
+bool scan_index::open(const std::string& path)
+{
+    close();
+    if (!mapping.open(path))
+    {
+        lastError = mapping.error();
+        return false;
+    }
+    bytes = mapping.bytes();
+    if (!validate())
+    {
+        close();
+        lastError = "not a scan index or it is corrupt";
+        return false;
+    }
+    return true;
+}
+
+void scan_index::close()
+{
+    mapping.close();
+    bytes = {};
+    fileCount = keyCount = forwardCount = postingCount = 0;
+}
+
+bool scan_index::validate()
+{
+    if (bytes.size() < sizeof(scan_index_header)) return false;
+    scan_index_header header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, SCAN_INDEX_MAGIC, 4) != 0 || header.version != SCAN_INDEX_VERSION) return false;
+
+    filesOffset = sizeof(header);
+    keysOffset = filesOffset + static_cast<uint64_t>(header.fileCount) * sizeof(scan_index_file);
+    forwardOffset = keysOffset + static_cast<uint64_t>(header.keyCount) * sizeof(scan_index_key);
+    postingsOffset = forwardOffset + static_cast<uint64_t>(header.forwardCount) * 4;
+    stringsOffset = postingsOffset + static_cast<uint64_t>(header.postingCount) * 4;
+    if (stringsOffset + header.stringsSize != bytes.size()) return false;
+    if (static_cast<uint64_t>(header.rootOffset) + header.rootLength > header.stringsSize) return false;
+
+    fileCount = header.fileCount;
+    keyCount = header.keyCount;
+    forwardCount = header.forwardCount;
+    postingCount = header.postingCount;
+    return true;
+}
+
+std::string_view scan_index::string_at(uint32_t offset, uint32_t length) const
+{
+    // every record is checked on access, a truncated or tampered index reads as empty strings instead of crashing
+    uint64_t stringsSize = bytes.size() - stringsOffset;
+    if (static_cast<uint64_t>(offset) + length > stringsSize) return {};
+    return { reinterpret_cast<const char*>(bytes.data() + stringsOffset + offset), length };
+}
+
+std::vector<uint32_t> scan_index::read_u32s(uint64_t tableOffset, uint64_t tableCount, uint32_t first, uint32_t count) const
+{
+    std::vector<uint32_t> values;
+    if (static_cast<uint64_t>(first) + count > tableCount) return values;
+    values.resize(count);
+    if (count != 0) std::memcpy(values.data(), bytes.data() + tableOffset + static_cast<uint64_t>(first) * 4, static_cast<size_t>(count) * 4);
+    return values;
+}
+
+std::string_view scan_index::root() const
+{
+    if (bytes.empty()) return {};
+    scan_index_header header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    return string_at(header.rootOffset, header.rootLength);
+}
+
+scan_file_entry scan_index::file(size_t index) const
+{
+    scan_index_file record;
+    std::memcpy(&record, bytes.data() + filesOffset + index * sizeof(record), sizeof(record));
+    return { string_at(record.pathOffset, record.pathLength), record.size, record.modifiedTime };
+}
+
+std::optional<size_t> scan_index::find_file(std::string_view path) const
+{
+    size_t low = 0;
+    size_t high = fileCount;
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        int order = file(middle).path.compare(path);
+        if (order == 0) return middle;
+        if (order < 0) low = middle + 1;
+        else high = middle;
+    }
+    return std::nullopt;
+}
+
+std::vector<std::string_view> scan_index::keys_of(uint32_t first, uint32_t count) const
+{
+    std::vector<std::string_view> keys;
+    std::vector<uint32_t> indexes = read_u32s(forwardOffset, forwardCount, first, count);
+    keys.reserve(indexes.size());
+    for (uint32_t keyIndex : indexes)
+    {
+        if (keyIndex < keyCount) keys.push_back(key(keyIndex));
+    }
+    return keys;
+}
+
+std::vector<std::string_view> scan_index::file_imports(size_t index) const
+{
+    scan_index_file record;
+    std::memcpy(&record, bytes.data() + filesOffset + index * sizeof(record), sizeof(record));
+    return keys_of(record.firstImport, record.importCount);
+}
+
+std::vector<std::string_view> scan_index::file_exports(size_t index) const
+{
+    scan_index_file record;
+    std::memcpy(&record, bytes.data() + filesOffset + index * sizeof(record), sizeof(record));
+    return keys_of(record.firstExport, record.exportCount);
+}
+
+std::string_view scan_index::key(size_t index) const
+{
+    scan_index_key record;
+    std::memcpy(&record, bytes.data() + keysOffset + index * sizeof(record), sizeof(record));
+    return string_at(record.keyOffset, record.keyLength);
+}
+
+std::pair<size_t, size_t> scan_index::find_keys(std::string_view module, std::string_view function) const
+{
+    std::string wanted = make_key(module, function);
+    // with an empty function the wanted key is "module::", a prefix of every key of that module
+    bool prefix = function.empty();
+    auto first_where = [this](auto&& isPast) {
+        size_t low = 0;
+        size_t high = keyCount;
+        while (low < high)
+        {
+            size_t middle = low + (high - low) / 2;
+            if (isPast(key(middle))) high = middle;
+            else low = middle + 1;
+        }
+        return low;
+    };
+
+    size_t first = first_where([&wanted](std::string_view candidate) { return candidate >= wanted; });
+    size_t last = first_where([&wanted, prefix](std::string_view candidate) {
+        return prefix ? candidate.substr(0, wanted.size()) > wanted : candidate > wanted;
+    });
+    return { first, std::max(first, last) };
+}
+
+std::vector<uint32_t> scan_index::importers(size_t keyIndex) const
+{
+    scan_index_key record;
+    std::memcpy(&record, bytes.data() + keysOffset + keyIndex * sizeof(record), sizeof(record));
+    return read_u32s(postingsOffset, postingCount, record.firstImporter, record.importerCount);
+}
+
+std::vector<uint32_t> scan_index::exporters(size_t keyIndex) const
+{
+    scan_index_key record;
+    std::memcpy(&record, bytes.data() + keysOffset + keyIndex * sizeof(record), sizeof(record));
+    return read_u32s(postingsOffset, postingCount, record.firstExporter, record.exporterCount);
+}
+
+std::string scan_index::make_key(std::string_view module, std::string_view function)
+{
+    // the loader matches module names case-insensitively, function names are exact
+    std::string key = util::to_lower(module);
+    key += "::";
+    key += function;
+    return key;
+}
+
+std::vector<uint8_t> scan_index::serialize(const std::string& root, std::vector<scanned_file> files)
+{
+    std::ranges::sort(files, {}, &scanned_file::path);
+
+    std::vector<std::string_view> keys;
+    for (const auto& scanned : files)
+    {
+        keys.insert(keys.end(), scanned.imports.begin(), scanned.imports.end());
+        keys.insert(keys.end(), scanned.exports.begin(), scanned.exports.end());
+    }
+    std::ranges::sort(keys);
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::unordered_map<std::string_view, uint32_t> keyIndexes;
+    keyIndexes.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        keyIndexes.emplace(keys[i], static_cast<uint32_t>(i));
+    }
+
+    std::vector<uint8_t> strings(root.begin(), root.end());
+    auto add_string = [&strings](std::string_view text) {
+        auto offset = static_cast<uint32_t>(strings.size());
+        strings.insert(strings.end(), text.begin(), text.end());
+        return offset;
+    };
+
+    // forward lists first, they also give the posting list sizes
+    std::vector<scan_index_file> fileRecords;
+    std::vector<uint32_t> forward;
+    std::vector<scan_index_key> keyRecords(keys.size(), scan_index_key {});
+    fileRecords.reserve(files.size());
+    auto add_forward = [&forward, &keyIndexes](const std::vector<std::string>& fileKeys) {
+        size_t first = forward.size();
+        for (const auto& fileKey : fileKeys) forward.push_back(keyIndexes.at(fileKey));
+        // a file importing the same function twice (two descriptors for one module) is listed once
+        std::sort(forward.begin() + static_cast<std::ptrdiff_t>(first), forward.end());
+        forward.erase(std::unique(forward.begin() + static_cast<std::ptrdiff_t>(first), forward.end()), forward.end());
+        return std::pair { static_cast<uint32_t>(first), static_cast<uint32_t>(forward.size() - first) };
+    };
+    for (const auto& scanned : files)
+    {
+        scan_index_file record {};
+        record.pathOffset = add_string(scanned.path);
+        record.pathLength = static_cast<uint32_t>(scanned.path.size());
+        record.size = scanned.size;
+        record.modifiedTime = scanned.modifiedTime;
+        std::tie(record.firstImport, record.importCount) = add_forward(scanned.imports);
+        std::tie(record.firstExport, record.exportCount) = add_forward(scanned.exports);
+        for (uint32_t i = 0; i < record.importCount; ++i) ++keyRecords[forward[record.firstImport + i]].importerCount;
+        for (uint32_t i = 0; i < record.exportCount; ++i) ++keyRecords[forward[record.firstExport + i]].exporterCount;
+        fileRecords.push_back(record);
+    }
+
+    uint32_t postingCount = 0;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        keyRecords[i].keyOffset = add_string(keys[i]);
+        keyRecords[i].keyLength = static_cast<uint32_t>(keys[i].size());
+        keyRecords[i].firstImporter = postingCount;
+        postingCount += keyRecords[i].importerCount;
+        keyRecords[i].firstExporter = postingCount;
+        postingCount += keyRecords[i].exporterCount;
+    }
+
+    // files are visited in path order, so every posting list comes out sorted
+    std::vector<uint32_t> postings(postingCount);
+    std::vector<uint32_t> filled(keys.size() * 2, 0);
+    for (size_t fileIndex = 0; fileIndex < fileRecords.size(); ++fileIndex)
+    {
+        const scan_index_file& record = fileRecords[fileIndex];
+        for (uint32_t i = 0; i < record.importCount; ++i)
+        {
+            uint32_t keyIndex = forward[record.firstImport + i];
+            postings[keyRecords[keyIndex].firstImporter + filled[keyIndex * 2]++] = static_cast<uint32_t>(fileIndex);
+        }
+        for (uint32_t i = 0; i < record.exportCount; ++i)
+        {
+            uint32_t keyIndex = forward[record.firstExport + i];
+            postings[keyRecords[keyIndex].firstExporter + filled[keyIndex * 2 + 1]++] = static_cast<uint32_t>(fileIndex);
+        }
+    }
+
+    scan_index_header header {};
+    std::memcpy(header.magic, SCAN_INDEX_MAGIC, 4);
+    header.version = SCAN_INDEX_VERSION;
+    header.fileCount = static_cast<uint32_t>(fileRecords.size());
+    header.keyCount = static_cast<uint32_t>(keyRecords.size());
+    header.forwardCount = static_cast<uint32_t>(forward.size());
+    header.postingCount = postingCount;
+    header.stringsSize = static_cast<uint32_t>(strings.size());
+    header.rootOffset = 0;
+    header.rootLength = static_cast<uint32_t>(root.size());
+
+    std::vector<uint8_t> data;
+    data.reserve(sizeof(header) + fileRecords.size() * sizeof(scan_index_file) + keyRecords.size() * sizeof(scan_index_key)
+        + (forward.size() + postings.size()) * 4 + strings.size());
+    auto append = [&data](const void* source, size_t size) {
+        auto begin = static_cast<const uint8_t*>(source);
+        data.insert(data.end(), begin, begin + size);
+    };
+    append(&header, sizeof(header));
+    append(fileRecords.data(), fileRecords.size() * sizeof(scan_index_file));
+    append(keyRecords.data(), keyRecords.size() * sizeof(scan_index_key));
+    append(forward.data(), forward.size() * 4);
+    append(postings.data(), postings.size() * 4);
+    append(strings.data(), strings.size());
+    return data;
+}
+
+bool scan_index::write(const std::string& path, const std::vector<uint8_t>& data, std::string& error)
+{
+    std::error_code ec;
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+
+    return util::replace_file(path, data, error);
+}
+
+std::string scan_index::default_path(const std::string& root)
+{
+    std::string key = root;
+#ifdef _WIN32
+    key = util::to_lower(key);
+#endif
+    return (std::filesystem::path(util::cache_directory("scans")) / (hash::to_hex(hash::fnv1a(key)) + ".sxi")).string();
+}
@@ -0,0 +1,76 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include "mapped_file.hpp"
+
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// imports and exports of one file found by a scan, keys are "module::function" with the module lower-cased
+struct scanned_file {
+    std::string path; // relative to the scan root, '/' separated
+    uint64_t size = 0;
+    int64_t modifiedTime = 0;
+    std::vector<std::string> imports;
+    std::vector<std::string> exports;
+};
+
+struct scan_file_entry {
+    std::string_view path; // points into the index
+    uint64_t size = 0;
+    int64_t modifiedTime = 0;
+};
+
+// reverse "who imports what" index over a directory tree, one mmap-able file
+// keys are sorted so lookups are a binary search over the mapping, every key lists the files
+// importing and exporting it, and every file lists its keys so a rescan can carry unchanged files over
+class scan_index {
+public:
+    [[nodiscard]] bool open(const std::string& path);
+    void close();
+
+    [[nodiscard]] const std::string& error() const { return lastError; }
+    [[nodiscard]] std::string_view root() const;
+
+    [[nodiscard]] size_t file_count() const { return fileCount; }
+    [[nodiscard]] scan_file_entry file(size_t index) const;
+    // files are sorted by path
+    [[nodiscard]] std::optional<size_t> find_file(std::string_view path) const;
+    [[nodiscard]] std::vector<std::string_view> file_imports(size_t index) const;
+    [[nodiscard]] std::vector<std::string_view> file_exports(size_t index) const;
+
+    [[nodiscard]] size_t key_count() const { return keyCount; }
+    [[nodiscard]] std::string_view key(size_t index) const;
+    // [first, last) of the keys for module::function, an empty function matches every key of the module
+    [[nodiscard]] std::pair<size_t, size_t> find_keys(std::string_view module, std::string_view function) const;
+    [[nodiscard]] std::vector<uint32_t> importers(size_t keyIndex) const;
+    [[nodiscard]] std::vector<uint32_t> exporters(size_t keyIndex) const;
+
+    [[nodiscard]] static std::string make_key(std::string_view module, std::string_view function);
+    [[nodiscard]] static std::vector<uint8_t> serialize(const std::string& root, std::vector<scanned_file> files);
+    // written next to the destination and renamed over it, readers never see a half written index
+    [[nodiscard]] static bool write(const std::string& path, const std::vector<uint8_t>& data, std::string& error);
+    [[nodiscard]] static std::string default_path(const std::string& root);
+
+private:
+    [[nodiscard]] bool validate();
+    [[nodiscard]] std::string_view string_at(uint32_t offset, uint32_t length) const;
+    [[nodiscard]] std::vector<uint32_t> read_u32s(uint64_t tableOffset, uint64_t tableCount, uint32_t first, uint32_t count) const;
+    [[nodiscard]] std::vector<std::string_view> keys_of(uint32_t first, uint32_t count) const;
+
+    mapped_file mapping;
+    std::span<const uint8_t> bytes;
+    std::string lastError;
+    uint32_t fileCount = 0;
+    uint32_t keyCount = 0;
+    uint32_t forwardCount = 0;
+    uint32_t postingCount = 0;
+    uint64_t filesOffset = 0;
+    uint64_t keysOffset = 0;
+    uint64_t forwardOffset = 0;
+    uint64_t postingsOffset = 0;
+    uint64_t stringsOffset = 0;
+};
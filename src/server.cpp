@@ -0,0 +1,371 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "server.hpp"
+
+#include <mutex>
+#include <spdlog/sinks/base_sink.h>
+
+// collects a request's log lines for its reply, the console would mix them into the reply stream
+class server_log_sink : public spdlog::sinks::base_sink<std::mutex> {
+public:
+    std::vector<std::pair<spdlog::level::level_enum, std::string>> lines;
+
+protected:
+    void sink_it_(const spdlog::details::log_msg& message) override
+    {
+        // the warnings carry terminal colors, a client has no use for them
+        std::string text;
+        std::string_view payload(message.payload.data(), message.payload.size());
+        for (size_t i = 0; i < payload.size(); ++i)
+        {
+            if (payload[i] == '\033' && i + 1 < payload.size() && payload[i + 1] == '[')
+            {
+                i = std::min(payload.find('m', i), payload.size() - 1);
+                continue;
+            }
+            text += payload[i];
+        }
+        lines.emplace_back(message.level, std::move(text));
+    }
+
+    void flush_() override {}
+};
+
+// cursor over one request line
+struct server_json_reader {
+    std::string_view text;
+    size_t position = 0;
+
+    void skip_space()
+    {
+        while (position < text.size() && (text[position] == ' ' || text[position] == '\t' || text[position] == '\r')) ++position;
+    }
+
+    bool consume(char c)
+    {
+        skip_space();
+        if (position >= text.size() || text[position] != c) return false;
+        ++position;
+        return true;
+    }
+
+    bool read_string(std::string& value)
+    {
+        if (!consume('"')) return false;
+        value.clear();
+        while (position < text.size())
+        {
+            char c = text[position++];
+            if (c == '"') return true;
+            if (c != '\\')
+            {
+                value += c;
+                continue;
+            }
+            if (position >= text.size()) return false;
+            char escape = text[position++];
+            switch (escape)
+            {
+            case '"': value += '"'; break;
+            case '\\': value += '\\'; break;
+            case '/': value += '/'; break;
+            case 'b': value += '\b'; break;
+            case 'f': value += '\f'; break;
+            case 'n': value += '\n'; break;
+            case 'r': value += '\r'; break;
+            case 't': value += '\t'; break;
+            case 'u':
+                {
+                    uint32_t codePoint;
+                    if (!read_hex4(codePoint)) return false;
+                    // a high surrogate needs its low half for anything outside the basic plane
+                    if (codePoint >= 0xD800 && codePoint < 0xDC00)
+                    {
+                        uint32_t low;
+                        if (position + 2 > text.size() || text[position] != '\\' || text[position + 1] != 'u') return false;
+                        position += 2;
+                        if (!read_hex4(low) || low < 0xDC00 || low >= 0xE000) return false;
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    append_utf8(value, codePoint);
+                    break;
+                }
+            default: return false;
+            }
+        }
+        return false;
+    }
+
+    bool read_hex4(uint32_t& value)
+    {
+        if (position + 4 > text.size()) return false;
+        value = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            char c = text[position++];
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= static_cast<uint32_t>(c - '0');
+            else if (c >= 'a' && c <= 'f') value |= static_cast<uint32_t>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') value |= static_cast<uint32_t>(c - 'A' + 10);
+            else return false;
+        }
+        return true;
+    }
+
+    static void append_utf8(std::string& out, uint32_t codePoint)
+    {
+        if (codePoint < 0x80)
+        {
+            out += static_cast<char>(codePoint);
+        } else if (codePoint < 0x800)
+        {
+            out += static_cast<char>(0xC0 | (codePoint >> 6));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else if (codePoint < 0x10000)
+        {
+            out += static_cast<char>(0xE0 | (codePoint >> 12));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else
+        {
+            out += static_cast<char>(0xF0 | (codePoint >> 18));
+            out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+    // numbers and literals are kept as their text, the arguments are strings anyway
+    bool read_bare(std::string& value)
+    {
+        skip_space();
+        size_t start = position;
+        while (position < text.size() && (std::isalnum(static_cast<unsigned char>(text[position])) || text[position] == '-' ||
+            text[position] == '+' || text[position] == '.'))
+        {
+            ++position;
+        }
+        value = std::string(text.substr(start, position - start));
+        return !value.empty();
+    }
+
+    bool at(char c)
+    {
+        skip_space();
+        return position < text.size() && text[position] == c;
+    }
+};
+
+int server::run(std::istream& input, std::FILE* output)
+{
+    output_writer out(64 * 1024);
+    out.attach(output);
+    spdlog::level::level_enum level = spdlog::get_level();
+    spdlog::info("Serving requests on stdin, one json object per line");
+
+    std::string line;
+    while (std::getline(input, line))
+    {
+        if (util::trim_string(line).empty()) continue;
+        bool keepRunning = handle(line, out, level);
+        // the client waits for the reply before it sends the next request
+        if (!out.flush())
+        {
+            spdlog::critical("Failed to write the reply: {}", out.error());
+            return 1;
+        }
+        if (!keepRunning) break;
+    }
+    spdlog::info("Served {} target reads from memory, {} from disk", targets.hits(), targets.misses());
+    return 0;
+}
+
+bool server::handle(const std::string& line, output_writer& out, spdlog::level::level_enum level)
+{
+    std::vector<server_field> fields;
+    std::string id = "null";
+    std::string error;
+    injection_job job;
+    auto sink = std::make_shared<server_log_sink>();
+    job_result result;
+    bool shutdown = false;
+    // one bad request gets an error reply, it must not take the server and its warm cache down with it
+    try
+    {
+        bool valid = parse_request(line, fields, id, error) && build_job(fields, job, error);
+        shutdown = valid && job.action == "shutdown";
+        if (!valid)
+        {
+            result = { false, error };
+        } else if (shutdown)
+        {
+            result = { true, "shutting down" };
+        } else
+        {
+            spdlog::logger log("serve", sink);
+            log.set_level(level);
+            result = injector::run(job, log, false, &targets);
+
+            // whatever the job wrote has to be read again by the next one
+            if (job.action != "list" && job.action != "resolve" && job.action != "diff" && job.action != "deps" && job.action != "scan" && job.action != "query")
+            {
+                targets.forget(job.save.empty() ? injector::default_save_path(job.target) : job.save);
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        result = { false, std::string("exception: ") + e.what() };
+    }
+
+    out.write("{\"id\":");
+    out.write(id);
+    out.write(",\"success\":");
+    out.write(result.success ? "true" : "false");
+    out.write(",\"message\":");
+    out.write_json_string(result.message);
+    out.write(fmt::format(",\"seconds\":{:.6f},\"log\":[", result.seconds));
+    for (size_t i = 0; i < sink->lines.size(); ++i)
+    {
+        if (i != 0) out.write(',');
+        out.write("{\"level\":");
+        auto levelName = spdlog::level::to_string_view(sink->lines[i].first);
+        out.write_json_string(std::string_view(levelName.data(), levelName.size()));
+        out.write(",\"message\":");
+        out.write_json_string(sink->lines[i].second);
+        out.write('}');
+    }
+    out.write("]}\n");
+    return !shutdown;
+}
+
+bool server::build_job(const std::vector<server_field>& fields, injection_job& job, std::string& error) const
+{
+    // the request's arguments replace the command line's, everything it doesn't name is inherited
+    arg_parser request = defaults;
+    for (const auto& field : fields)
+    {
+        bool known = std::ranges::any_of(defaults.default_args, [&field](const default_arg& arg) { return arg.name == field.name; });
+        if (!known || field.name == "serve" || field.name == "manifest")
+        {
+            error = "unknown field: " + field.name;
+            return false;
+        }
+        std::erase_if(request.args, [&field](const argument& arg) { return arg.name == field.name; });
+    }
+    for (const auto& field : fields)
+    {
+        if (!field.set) continue;
+        if (field.values.empty()) request.add_arg(field.name, "");
+        for (const auto& value : field.values) request.add_arg(field.name, value);
+    }
+
+    if (request.get_arg_value("action") == "shutdown")
+    {
+        job.action = "shutdown";
+        return true;
+    }
+    if (!request.has_arg("target") || !request.has_arg("action"))
+    {
+        error = "missing field: " + std::string(request.has_arg("target") ? "action" : "target");
+        return false;
+    }
+    job = makeJob(request);
+
+    if (!injector::is_valid_format(job.format))
+    {
+        error = "unknown format: " + job.format;
+        return false;
+    }
+    // stdout carries the replies
+    if (job.format != "text" && job.output.empty())
+    {
+        error = "json and tsv output need an output file in serve mode";
+        return false;
+    }
+    size_t threads;
+    if (request.has_arg("threads") && !injector::parse_thread_count(request.get_arg_value("threads"), threads))
+    {
+        error = "invalid thread count: " + request.get_arg_value("threads");
+        return false;
+    }
+    if (!parse_profile::is_valid(job.parseProfile))
+    {
+        error = "unknown parse profile: " + job.parseProfile;
+        return false;
+    }
+    // the server's stdin carries the requests
+    if (job.action == "resolve" && (job.queries == "-" || (job.queries.empty() && job.symbols.empty())))
+    {
+        error = "resolve needs symbol or a queries file in serve mode";
+        return false;
+    }
+    if (request.has_arg("symbols-file") && !injector::read_symbols_file(request.get_arg_value("symbols-file"), job.symbols))
+    {
+        error = "failed to read the symbols file: " + request.get_arg_value("symbols-file");
+        return false;
+    }
+    return true;
+}
+
+bool server::parse_request(std::string_view line, std::vector<server_field>& fields, std::string& id, std::string& error)
+{
+    server_json_reader reader { line };
+    error = "malformed request";
+    if (!reader.consume('{')) return false;
+    if (reader.consume('}'))
+    {
+        error.clear();
+        return true;
+    }
+    do
+    {
+        server_field field;
+        if (!reader.read_string(field.name) || !reader.consume(':')) return false;
+
+        if (field.name == "id")
+        {
+            // echoed back exactly as sent, strings included
+            reader.skip_space();
+            size_t start = reader.position;
+            std::string ignored;
+            if (reader.at('"') ? !reader.read_string(ignored) : !reader.read_bare(ignored)) return false;
+            id = std::string(line.substr(start, reader.position - start));
+            continue;
+        }
+
+        std::string value;
+        if (reader.at('"'))
+        {
+            if (!reader.read_string(value)) return false;
+            field.values.push_back(std::move(value));
+        } else if (reader.consume('['))
+        {
+            if (!reader.consume(']'))
+            {
+                do
+                {
+                    if (reader.at('"') ? !reader.read_string(value) : !reader.read_bare(value)) return false;
+                    field.values.push_back(std::move(value));
+                } while (reader.consume(','));
+                if (!reader.consume(']')) return false;
+            }
+            // an empty list clears the argument like false does
+            field.set = !field.values.empty();
+        } else
+        {
+            if (!reader.read_bare(value)) return false;
+            if (value == "false" || value == "null") field.set = false;
+            else if (value != "true") field.values.push_back(std::move(value));
+        }
+        fields.push_back(std::move(field));
+    } while (reader.consume(','));
+
+    if (!reader.consume('}')) return false;
+    reader.skip_space();
+    if (reader.position != line.size()) return false;
+    error.clear();
+    return true;
+}
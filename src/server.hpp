@@ -0,0 +1,44 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include "arg_parser.hpp"
+#include "injector.hpp"
+#include "output_writer.hpp"
+#include "target_cache.hpp"
+
+#include <istream>
+
+// one field of a request, a flag is true without values
+struct server_field {
+    std::string name;
+    std::vector<std::string> values;
+    bool set = true; // false and null clear what the command line gave
+};
+
+// --serve: newline delimited json requests in, one json reply per line out
+// a request uses the command line names, {"target": "app.exe", "action": "add", "symbol": ["a.dll::f"], "force": true}
+// strings and numbers are values, true sets a flag, arrays repeat an argument, "id" is echoed back as it was sent
+// every request starts from the server's own command line, targets stay parsed between requests (see target_cache)
+class server {
+public:
+    using job_factory = injection_job (*)(const arg_parser&);
+
+    server(const arg_parser& defaults, job_factory makeJob, size_t cachedTargets)
+        : defaults(defaults), makeJob(makeJob), targets(cachedTargets) {}
+
+    // until the input ends or a request asks for {"action": "shutdown"}, the exit code for the process
+    [[nodiscard]] int run(std::istream& input, std::FILE* output);
+
+private:
+    // false for a shutdown request
+    bool handle(const std::string& line, output_writer& out, spdlog::level::level_enum level);
+    [[nodiscard]] bool build_job(const std::vector<server_field>& fields, injection_job& job, std::string& error) const;
+
+    // flat objects only: string, number, true/false/null and arrays of strings or numbers as values
+    [[nodiscard]] static bool parse_request(std::string_view line, std::vector<server_field>& fields, std::string& id, std::string& error);
+
+    const arg_parser& defaults;
+    job_factory makeJob;
+    target_cache targets;
+};
@@ -0,0 +1,139 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "session.hpp"
+#include "pe_checksum.hpp"
+#include "util.hpp"
+
+#include <fstream>
+
+bool session::open(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return fail("failed to open " + path);
+    std::streamsize size = file.tellg();
+    if (size <= 0) return fail("file is empty");
+    std::vector<uint8_t> data(static_cast<size_t>(size));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(data.data()), size)) return fail("failed to read " + path);
+
+    image = std::move(data);
+    return load();
+}
+
+bool session::open(std::span<const uint8_t> bytes)
+{
+    image.assign(bytes.begin(), bytes.end());
+    return load();
+}
+
+const pe_import* session::find_import(std::string_view module, std::string_view function, bool delayLoad) const
+{
+    const import_index& index = delayLoad ? delaySlots : slots;
+    const import_record* record = index.find(module, function);
+    if (!record) return nullptr;
+    // the index was built from the list, a record's position is the import's
+    size_t position = static_cast<size_t>(record - index.records().data());
+    return delayLoad ? &delayList[position] : &importList[position];
+}
+
+std::optional<session_slot> session::find_slot(std::string_view module, std::string_view function) const
+{
+    const pe_import* entry = find_import(module, function);
+    if (!entry) return std::nullopt;
+    return session_slot { entry->slotRva, reader.offset_from_rva(entry->slotRva), reader.slot_width() };
+}
+
+std::optional<session_slot> session::find_slot(std::string_view module, uint16_t ordinal) const
+{
+    return find_slot(module, "#" + std::to_string(ordinal));
+}
+
+bool session::add(const std::vector<session_import>& functions, bool delayLoad)
+{
+    if (!is_open()) return fail("no image is open");
+    import_patcher patcher(image);
+    if (!patcher.load()) return fail(patcher.error());
+    for (const auto& function : functions)
+    {
+        if (delayLoad) patcher.add_delay_import(function.module, function.function, function.hint);
+        else patcher.add_import(function.module, function.function, function.hint);
+    }
+    return apply(patcher);
+}
+
+bool session::remove(const std::vector<session_import>& functions, bool delayLoad)
+{
+    if (!is_open()) return fail("no image is open");
+    import_patcher patcher(image);
+    if (!patcher.load()) return fail(patcher.error());
+    for (const auto& function : functions)
+    {
+        bool removed = delayLoad ? patcher.remove_delay_import(function.module, function.function) : patcher.remove_import(function.module, function.function);
+        if (!removed) return fail(patcher.error());
+    }
+    return apply(patcher);
+}
+
+bool session::write(const std::string& path)
+{
+    if (!is_open()) return fail("no image is open");
+    // an image linked without a checksum keeps it at zero, like the CLI's writes
+    uint64_t checksumOffset = reader.optional_header_offset() + pe::OPTIONAL_CHECKSUM;
+    if (pe::read<uint32_t>(image.data() + checksumOffset) != 0)
+    {
+        pe::write(image.data() + checksumOffset, pe_checksum::compute(image, checksumOffset));
+    }
+
+    // renamed over the path like the CLI's writes, hard links to it and the old file survive a failed write
+    if (util::file_exists(path) && util::is_file_locked(path)) return fail("the file to save to is locked: " + path);
+    std::string error;
+    if (!util::replace_file(path, image, error)) return fail(error);
+    return true;
+}
+
+bool session::load()
+{
+    reader = pe_reader(image);
+    importList.clear();
+    delayList.clear();
+    slots.build({}, 0);
+    delaySlots.build({}, 0);
+    if (!reader.parse())
+    {
+        std::string message = reader.error();
+        image.clear();
+        return fail(message);
+    }
+
+    importList = reader.imports();
+    delayList = reader.delay_imports();
+    slots.build(importList, reader.slot_width());
+    delaySlots.build(delayList, reader.slot_width());
+    return true;
+}
+
+bool session::apply(import_patcher& patcher)
+{
+    if (!patcher.build()) return fail(patcher.error());
+
+    // the patches are file offsets of the output, applied to a copy so a failure keeps the open image intact
+    std::vector<uint8_t> output = image;
+    output.resize(static_cast<size_t>(patcher.output_size()), 0);
+    for (const auto& patch : patcher.patches())
+    {
+        if (patch.offset + patch.bytes.size() > output.size()) return fail("patch is outside the output");
+        std::ranges::copy(patch.bytes, output.begin() + static_cast<std::ptrdiff_t>(patch.offset));
+    }
+    lastLayout = patcher.layout();
+
+    image = std::move(output);
+    return load();
+}
+
+bool session::fail(const std::string& message)
+{
+    lastError = message;
+    return false;
+}
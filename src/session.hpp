@@ -0,0 +1,76 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include "import_index.hpp"
+#include "import_patcher.hpp"
+#include "pe_reader.hpp"
+
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// a function to add or remove, "#123" for one by ordinal
+struct session_import {
+    std::string module;
+    std::string function;
+    uint16_t hint = 0; // index into the DLL's export name table, 0 lets the loader search
+};
+
+struct session_slot {
+    uint32_t rva = 0;
+    int64_t fileOffset = -1; // -1 for an IAT without file backing
+    uint32_t width = 0;      // 4 or 8 bytes
+};
+
+// a PE image opened once and queried or edited in memory, the in-process entry point of StaticInjectionCore
+// the lists and the slot index are built on open and after each edit, nothing touches the disk until write()
+// edits go through import_patcher, so they land exactly like the CLI's in-place patches
+class session {
+public:
+    [[nodiscard]] bool open(const std::string& path);
+    // the bytes are copied, the caller's buffer isn't needed afterwards
+    [[nodiscard]] bool open(std::span<const uint8_t> bytes);
+
+    [[nodiscard]] bool is_open() const { return !image.empty(); }
+    [[nodiscard]] std::span<const uint8_t> bytes() const { return image; }
+    [[nodiscard]] bool is_pe32_plus() const { return reader.is_pe32_plus(); }
+
+    // the views point into the session's copy, they stay valid until the next edit
+    [[nodiscard]] const std::vector<pe_import>& imports() const { return importList; }
+    [[nodiscard]] const std::vector<pe_import>& delay_imports() const { return delayList; }
+    [[nodiscard]] std::vector<pe_export> exports() const { return reader.exports(); }
+
+    // "#123" finds an import by ordinal, modules match case-insensitively like the loader does
+    [[nodiscard]] const pe_import* find_import(std::string_view module, std::string_view function, bool delayLoad = false) const;
+    // the IAT slot the loader writes the function's address to
+    [[nodiscard]] std::optional<session_slot> find_slot(std::string_view module, std::string_view function) const;
+    [[nodiscard]] std::optional<session_slot> find_slot(std::string_view module, uint16_t ordinal) const;
+
+    // all or nothing, a failed edit leaves the image as it was
+    [[nodiscard]] bool add(const std::vector<session_import>& functions, bool delayLoad = false);
+    [[nodiscard]] bool remove(const std::vector<session_import>& functions, bool delayLoad = false);
+    // byte and page cost of the last edit
+    [[nodiscard]] const layout_report& layout() const { return lastLayout; }
+
+    // refreshes the checksum of an image that has one, then writes the whole image to a temp file renamed over path
+    [[nodiscard]] bool write(const std::string& path);
+
+    [[nodiscard]] const std::string& error() const { return lastError; }
+
+private:
+    [[nodiscard]] bool load();
+    [[nodiscard]] bool apply(import_patcher& patcher);
+    [[nodiscard]] bool fail(const std::string& message);
+
+    std::vector<uint8_t> image;
+    pe_reader reader { {} };
+    std::vector<pe_import> importList;
+    std::vector<pe_import> delayList;
+    import_index slots;      // records in importList order
+    import_index delaySlots; // records in delayList order
+    layout_report lastLayout;
+    std::string lastError;
+};
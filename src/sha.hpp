@@ -0,0 +1,87 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+// block buffering and padding shared by both hashes, 64 byte blocks with a big-endian bit length at the end
+class sha_stream {
+public:
+    template <typename Compress>
+    void update(std::span<const uint8_t> data, Compress&& compress)
+    {
+        length += data.size();
+        size_t offset = 0;
+        if (buffered != 0)
+        {
+            size_t take = data.size() < 64 - buffered ? data.size() : 64 - buffered;
+            std::memcpy(buffer + buffered, data.data(), take);
+            buffered += take;
+            offset = take;
+            if (buffered < 64) return;
+            compress(buffer);
+            buffered = 0;
+        }
+        // whole blocks straight out of the input, no copy
+        for (; offset + 64 <= data.size(); offset += 64)
+        {
+            compress(data.data() + offset);
+        }
+        buffered = data.size() - offset;
+        if (buffered != 0) std::memcpy(buffer, data.data() + offset, buffered);
+    }
+
+    template <typename Compress>
+    void finish(Compress&& compress)
+    {
+        uint64_t bits = length * 8;
+        buffer[buffered++] = 0x80;
+        if (buffered > 56)
+        {
+            std::memset(buffer + buffered, 0, 64 - buffered);
+            compress(buffer);
+            buffered = 0;
+        }
+        std::memset(buffer + buffered, 0, 56 - buffered);
+        for (size_t i = 0; i < 8; ++i) buffer[56 + i] = static_cast<uint8_t>(bits >> (56 - i * 8));
+        compress(buffer);
+    }
+
+private:
+    uint8_t buffer[64] = {};
+    size_t buffered = 0;
+    uint64_t length = 0;
+};
+
+// streaming sha-1 and sha-256, enough to recompute authenticode digests without pulling in a crypto library
+class sha1 {
+public:
+    static constexpr size_t DIGEST_SIZE = 20;
+
+    void update(std::span<const uint8_t> data);
+    [[nodiscard]] std::array<uint8_t, DIGEST_SIZE> finish();
+
+private:
+    void compress(const uint8_t* block);
+
+    uint32_t state[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+    sha_stream stream;
+};
+
+class sha256 {
+public:
+    static constexpr size_t DIGEST_SIZE = 32;
+
+    void update(std::span<const uint8_t> data);
+    [[nodiscard]] std::array<uint8_t, DIGEST_SIZE> finish();
+
+private:
+    void compress(const uint8_t* block);
+
+    uint32_t state[8] = { 0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19 };
+    sha_stream stream;
+};
@@ -0,0 +1,58 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "target_cache.hpp"
+#include "util.hpp"
+
+parsed_target* target_cache::acquire(const std::string& path)
+{
+    std::string key = normalize(path);
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(path, ec);
+    if (ec) return nullptr;
+    int64_t modifiedTime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    if (ec) return nullptr;
+
+    auto it = std::ranges::find_if(entries, [&key](const auto& entry) { return entry->path == key; });
+    if (it != entries.end())
+    {
+        if ((*it)->size == size && (*it)->modifiedTime == modifiedTime)
+        {
+            ++hitCount;
+            entries.splice(entries.begin(), entries, it);
+            return entries.front().get();
+        }
+        entries.erase(it);
+    }
+
+    ++missCount;
+    auto entry = std::make_unique<parsed_target>();
+    entry->path = key;
+    entry->size = size;
+    entry->modifiedTime = modifiedTime;
+    entry->bytes.resize(static_cast<size_t>(size));
+    std::ifstream file(path, std::ios::binary);
+    if (!file.read(reinterpret_cast<char*>(entry->bytes.data()), static_cast<std::streamsize>(size)) || size == 0) return nullptr;
+
+    entries.push_front(std::move(entry));
+    while (entries.size() > capacity) entries.pop_back();
+    return entries.front().get();
+}
+
+void target_cache::forget(const std::string& path)
+{
+    std::string key = normalize(path);
+    std::erase_if(entries, [&key](const auto& entry) { return entry->path == key; });
+}
+
+std::string target_cache::normalize(const std::string& path)
+{
+    std::error_code ec;
+    std::string key = std::filesystem::weakly_canonical(path, ec).string();
+    if (ec) key = std::filesystem::absolute(path).string();
+#ifdef _WIN32
+    key = util::to_lower(key);
+#endif
+    return key;
+}
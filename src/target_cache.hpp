@@ -0,0 +1,45 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include "import_index.hpp"
+
+#include <list>
+#include <memory>
+
+// a target kept in memory between requests of a server
+// the bytes are a copy, the file stays free to be overwritten while its parse is reused
+struct parsed_target {
+    std::string path;
+    uint64_t size = 0;
+    int64_t modifiedTime = 0;
+    std::vector<uint8_t> bytes;
+    // empty until a job parsed it, and again once a LIEF rebuild edited it
+    std::unique_ptr<LIEF::PE::Binary> binary;
+    LIEF::PE::ParserConfig config; // what binary was parsed with
+    import_index imports;          // built whenever binary is, points into it
+};
+
+// least recently used targets keyed by path, an entry is only handed out while the file's size and mtime still match
+class target_cache {
+public:
+    explicit target_cache(size_t capacity) : capacity(std::max<size_t>(capacity, 1)) {}
+
+    // reads the file again when it changed on disk, nullptr when it can't be read
+    // the entry stays valid until the next acquire()
+    [[nodiscard]] parsed_target* acquire(const std::string& path);
+    // drops an entry, for files a job just wrote
+    void forget(const std::string& path);
+
+    [[nodiscard]] size_t size() const { return entries.size(); }
+    [[nodiscard]] uint64_t hits() const { return hitCount; }
+    [[nodiscard]] uint64_t misses() const { return missCount; }
+
+private:
+    [[nodiscard]] static std::string normalize(const std::string& path);
+
+    size_t capacity;
+    std::list<std::unique_ptr<parsed_target>> entries; // most recently used first
+    uint64_t hitCount = 0;
+    uint64_t missCount = 0;
+};
@@ -0,0 +1,56 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "thread_pool.hpp"
+
+thread_pool::thread_pool(size_t threadCount)
+{
+    if (threadCount == 0) threadCount = 1;
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        workers.emplace_back([this] { worker_loop(); });
+    }
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+    for (auto& worker : workers)
+    {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+size_t thread_pool::size() const
+{
+    return workers.size();
+}
+
+size_t thread_pool::default_thread_count()
+{
+    size_t count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+void thread_pool::worker_loop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+            // drain whatever is left before exiting so no future is left dangling
+            if (tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+// fixed-size pool, workers are spawned once and pull tasks until the pool is destroyed
+class thread_pool {
+public:
+    explicit thread_pool(size_t threadCount);
+    ~thread_pool();
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& task)
+    {
+        using result_t = std::invoke_result_t<F>;
+        auto packaged = std::make_shared<std::packaged_task<result_t()>>(std::forward<F>(task));
+        std::future<result_t> future = packaged->get_future();
+        {
+            std::lock_guard lock(mutex);
+            tasks.emplace([packaged] { (*packaged)(); });
+        }
+        condition.notify_one();
+        return future;
+    }
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] static size_t default_thread_count();
+
+private:
+    void worker_loop();
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+};
@@ -4,14 +4,18 @@
 
 #include "util.hpp"
 
-#include <softpub.h>
-
+#include <random>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 void util::enable_virtual_terminal()  {
+#ifdef _WIN32
     HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
     DWORD mode;
     GetConsoleMode(hOut, &mode);
     SetConsoleMode(hOut, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+#endif
 }
 
 void util::write(const std::string& text)
@@ -22,6 +26,7 @@ void util::write(const std::string& text)
 
 void util::clear_current_console_line()
 {
+#ifdef _WIN32
     HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     GetConsoleScreenBufferInfo(hConsole, &csbi);
@@ -30,20 +35,14 @@ void util::clear_current_console_line()
     DWORD size = csbi.dwSize.X - csbi.dwCursorPosition.X;
     FillConsoleOutputCharacterA(hConsole, ' ', size, coord, &written);
     SetConsoleCursorPosition(hConsole, coord);
-}
-
-DWORD util::offset_from_rva(DWORD rva, PIMAGE_SECTION_HEADER header)
-{
-    return rva + RVA_OFFSET(header);
-}
-
-DWORD util::rva_from_offset(DWORD offset, PIMAGE_SECTION_HEADER header)
-{
-    return offset - RVA_OFFSET(header);
+#else
+    write("\r\033[2K");
+#endif
 }
 
 void util::copy_to_clipboard(const std::string& string)
 {
+#ifdef _WIN32
     if (OpenClipboard(nullptr))
     {
         EmptyClipboard();
@@ -57,6 +56,10 @@ void util::copy_to_clipboard(const std::string& string)
     {
         spdlog::error("Failed to open clipboard");
     }
+#else
+    (void)string;
+    spdlog::error("Copying to the clipboard is only supported on Windows");
+#endif
 }
 
 bool util::file_exists(const std::string &name) {
@@ -79,6 +82,8 @@ bool util::copy_file(const std::string& source, const std::string& destination)
 
 bool util::is_file_locked(const std::string& filePath)
 {
+    // an ofstream would create a missing file, and nothing can hold a lock on it anyway
+    if (!file_exists(filePath)) return false;
     std::ifstream file(filePath);
     std::ofstream output(filePath, std::ios::app);
     bool isLocked = !file.is_open() || !output.is_open();
@@ -87,10 +92,88 @@ bool util::is_file_locked(const std::string& filePath)
     return isLocked;
 }
 
-bool util::equals_ignore_case(const std::string& str1, const std::string& str2)
+std::string util::temporary_path(const std::string& path)
+{
+#ifdef _WIN32
+    uint64_t process = GetCurrentProcessId();
+#else
+    uint64_t process = static_cast<uint64_t>(getpid());
+#endif
+    // thread ids repeat across processes and pids get reused, the random part covers both
+    thread_local std::mt19937_64 generator(std::random_device {}() ^ (static_cast<uint64_t>(std::random_device {}()) << 32));
+    return fmt::format("{}.{}-{:016x}.tmp", path, process, generator());
+}
+
+bool util::replace_file(const std::string& path, const std::function<bool(const std::string& temporaryPath)>& write, std::string& error)
+{
+    std::string temporaryPath = temporary_path(path);
+    std::error_code ec;
+    error.clear();
+    if (!write(temporaryPath))
+    {
+        if (error.empty()) error = "failed to write " + temporaryPath;
+        std::filesystem::remove(temporaryPath, ec);
+        return false;
+    }
+    std::filesystem::rename(temporaryPath, path, ec);
+    if (ec)
+    {
+        error = "failed to replace " + path + ": " + ec.message();
+        std::filesystem::remove(temporaryPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool util::replace_file(const std::string& path, std::span<const uint8_t> data, std::string& error)
+{
+    return replace_file(path, [&data, &error](const std::string& temporaryPath) {
+        std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!output.is_open())
+        {
+            error = "failed to create " + temporaryPath;
+            return false;
+        }
+        output.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        return output.good();
+    }, error);
+}
+
+bool util::equals_ignore_case(std::string_view str1, std::string_view str2)
+{
+    return str1.size() == str2.size() && std::ranges::equal(str1, str2,
+        [](const char a, const char b) { return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b)); });
+}
+
+int util::compare_ignore_case(std::string_view str1, std::string_view str2)
 {
-    return std::ranges::equal(str1, str2,
-                              [](const char a, const char b) { return tolower(a) == tolower(b); });
+    size_t length = std::min(str1.size(), str2.size());
+    for (size_t i = 0; i < length; ++i)
+    {
+        int a = std::tolower(static_cast<unsigned char>(str1[i]));
+        int b = std::tolower(static_cast<unsigned char>(str2[i]));
+        if (a != b) return a < b ? -1 : 1;
+    }
+    if (str1.size() != str2.size()) return str1.size() < str2.size() ? -1 : 1;
+    return 0;
+}
+
+std::string util::to_lower(std::string_view string)
+{
+    std::string lowered(string);
+    std::ranges::transform(lowered, lowered.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return lowered;
+}
+
+uint64_t util::hash_ignore_case(std::string_view string, uint64_t seed)
+{
+    uint64_t value = seed;
+    for (char c : string)
+    {
+        value ^= static_cast<uint8_t>(std::tolower(static_cast<unsigned char>(c)));
+        value *= hash::FNV_PRIME;
+    }
+    return value;
 }
 
 std::string util::trim_string(const std::string& string)
@@ -143,49 +226,28 @@ std::pair<std::string, std::string> util::split_string_once(const std::string& s
 
 std::string util::get_executable_name()
 {
+#ifdef _WIN32
     char buffer[MAX_PATH];
     GetModuleFileNameA(nullptr, buffer, MAX_PATH);
     std::string fullPath(buffer);
+#else
+    std::error_code ec;
+    std::string fullPath = std::filesystem::read_symlink("/proc/self/exe", ec).string();
+    if (ec) return "StaticInjection";
+#endif
     return std::filesystem::path(fullPath).filename().string();
 }
 
-bool util::has_code_signature(const std::string& filePath)
+std::string util::cache_directory(const std::string& name)
 {
-    if (!file_exists(filePath))
-    {
-        spdlog::error("File does not exist: {}", filePath);
-        return false;
-    }
-
-    HANDLE hFile = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
-    if (hFile == INVALID_HANDLE_VALUE)
-    {
-        spdlog::error("Failed to open file: {}", filePath);
-        return false;
-    }
-
-    WINTRUST_FILE_INFO fileInfo = {};
-    fileInfo.cbStruct = sizeof(WINTRUST_FILE_INFO);
-    fileInfo.pcwszFilePath = std::wstring(filePath.begin(), filePath.end()).c_str();
-    fileInfo.hFile = hFile;
-    fileInfo.pgKnownSubject = nullptr;
-
-    GUID guidAction = WINTRUST_ACTION_GENERIC_VERIFY_V2;
-    WINTRUST_DATA trustData = {};
-    trustData.cbStruct = sizeof(WINTRUST_DATA);
-    trustData.dwUIChoice = WTD_UI_NONE;
-    trustData.fdwRevocationChecks = WTD_REVOKE_NONE;
-    trustData.dwUnionChoice = WTD_CHOICE_FILE;
-    trustData.pFile = &fileInfo;
-    trustData.dwStateAction = WTD_STATEACTION_VERIFY;
-    trustData.dwProvFlags = WTD_SAFER_FLAG;
-    trustData.hWVTStateData = nullptr;
-
-    LONG lStatus = WinVerifyTrust(nullptr, &guidAction, &trustData);
-
-    trustData.dwStateAction = WTD_STATEACTION_CLOSE;
-    WinVerifyTrust(nullptr, &guidAction, &trustData);
-    CloseHandle(hFile);
-
-    return (lStatus == ERROR_SUCCESS);
-}
\ No newline at end of file
+#ifdef _WIN32
+    const char* base = std::getenv("LOCALAPPDATA");
+    if (base && *base) return (std::filesystem::path(base) / "StaticInjection" / name).string();
+#else
+    const char* base = std::getenv("XDG_CACHE_HOME");
+    if (base && *base) return (std::filesystem::path(base) / "StaticInjection" / name).string();
+    const char* home = std::getenv("HOME");
+    if (home && *home) return (std::filesystem::path(home) / ".cache" / "StaticInjection" / name).string();
+#endif
+    return (std::filesystem::temp_directory_path() / "StaticInjection" / name).string();
+}
@@ -4,9 +4,13 @@
 //
 #include <LIEF/PE.hpp>
 #include <LIEF/logging.hpp>
+#include <LIEF/BinaryStream/SpanStream.hpp>
 
-#define RVA_OFFSET(header) \
-(header->VirtualAddress - header->PointerToRawData)
+#include "hash.hpp"
+#include "pe_format.hpp"
+
+#include <functional>
+#include <span>
 
 class util {
 public:
@@ -14,15 +18,24 @@ public:
     static void write(const std::string& text);
     static void clear_current_console_line();
 
-    static DWORD offset_from_rva(DWORD rva, PIMAGE_SECTION_HEADER header);
-    static DWORD rva_from_offset(DWORD offset, PIMAGE_SECTION_HEADER header);
-
     static bool file_exists(const std::string &name);
     static void copy_to_clipboard(const std::string& string);
     static bool copy_file(const std::string& source, const std::string& destination);
+    // false for a path that doesn't exist yet, the check never creates it
     static bool is_file_locked(const std::string& filePath);
+    // a name next to path no other thread or process picks: the process id and a random part
+    static std::string temporary_path(const std::string& path);
+    // write() fills a temporary file next to path, which is then renamed over it so readers never see a half written file
+    // write() may set error itself, the temporary file is removed on any failure
+    static bool replace_file(const std::string& path, const std::function<bool(const std::string& temporaryPath)>& write, std::string& error);
+    static bool replace_file(const std::string& path, std::span<const uint8_t> data, std::string& error);
 
-    static bool equals_ignore_case(const std::string& str1, const std::string& str2);
+    // ascii only, the way the windows loader matches module names; every module name comparison goes through these
+    static bool equals_ignore_case(std::string_view str1, std::string_view str2);
+    static int compare_ignore_case(std::string_view str1, std::string_view str2);
+    static std::string to_lower(std::string_view string);
+    // fnv-1a over the lower-cased text, equal under equals_ignore_case means equal hashes. chains like hash::fnv1a
+    static uint64_t hash_ignore_case(std::string_view string, uint64_t seed = hash::FNV_OFFSET);
     static std::string trim_string(const std::string& string);
     static bool string_starts_with(const std::string& str, const std::string& prefix);
     static bool string_ends_with(const std::string& str, const std::string& suffix);
@@ -30,5 +43,6 @@ public:
     static std::pair<std::string, std::string> split_string_once(const std::string& str, const std::string& delimiter);
 
     static std::string get_executable_name();
-    static bool has_code_signature(const std::string& filePath);
+    // per-user cache directory for the given kind of entries, not created here
+    static std::string cache_directory(const std::string& name);
 };
\ No newline at end of file
@@ -0,0 +1,119 @@
+//
+// Created by emi on 10/17/2026.
+//
+
+#include "work_stealing_pool.hpp"
+
+#include <thread>
+
+work_stealing_pool::work_stealing_pool(size_t threadCount)
+{
+    if (threadCount == 0) threadCount = 1;
+    queues.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        queues.push_back(std::make_unique<worker_queue>());
+    }
+}
+
+void work_stealing_pool::push(size_t worker, task work)
+{
+    // counted before it's visible so no worker can see an empty pool while this task is on its way in
+    ++pending;
+    {
+        worker_queue& queue = *queues[worker % queues.size()];
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(work));
+    }
+    {
+        std::lock_guard lock(idleMutex);
+        ++pushes;
+    }
+    idle.notify_one();
+}
+
+void work_stealing_pool::run()
+{
+    // the calling thread works as worker 0 instead of sitting in join()
+    std::vector<std::thread> threads;
+    threads.reserve(queues.size() - 1);
+    for (size_t i = 1; i < queues.size(); ++i)
+    {
+        threads.emplace_back([this, i] { worker_loop(i); });
+    }
+    worker_loop(0);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void work_stealing_pool::cancel()
+{
+    for (auto& queue : queues)
+    {
+        std::lock_guard lock(queue->mutex);
+        pending -= queue->tasks.size();
+        queue->tasks.clear();
+    }
+    if (pending == 0) finish();
+}
+
+bool work_stealing_pool::pop(size_t worker, task& work)
+{
+    worker_queue& queue = *queues[worker];
+    std::lock_guard lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    work = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool work_stealing_pool::steal(size_t worker, task& work)
+{
+    // start at the next worker so thieves don't all pile onto the first queue
+    for (size_t i = 1; i < queues.size(); ++i)
+    {
+        worker_queue& queue = *queues[(worker + i) % queues.size()];
+        std::lock_guard lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        work = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void work_stealing_pool::worker_loop(size_t worker)
+{
+    task work;
+    while (true)
+    {
+        // read before looking at the queues, a push after that moves it and the wait below returns right away
+        uint64_t seen;
+        {
+            std::lock_guard lock(idleMutex);
+            seen = pushes;
+        }
+        if (pop(worker, work) || steal(worker, work))
+        {
+            work(worker);
+            work = nullptr;
+            if (--pending == 0) finish();
+            continue;
+        }
+        // another worker is still running something that may push more work
+        std::unique_lock lock(idleMutex);
+        idle.wait(lock, [this, seen] { return pending == 0 || pushes != seen; });
+        if (pending == 0) return;
+    }
+}
+
+void work_stealing_pool::finish()
+{
+    {
+        // taken so no worker is between checking pending and starting to wait
+        std::lock_guard lock(idleMutex);
+    }
+    idle.notify_all();
+}
@@ -0,0 +1,53 @@
+#pragma once
+//
+// Created by emi on 10/17/2026.
+//
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// pool for work that spawns more work, like a directory walk finding subdirectories
+// every worker owns a deque, it pushes and pops at the back so it stays depth first on what it just found,
+// idle workers steal from the front of the others where the oldest and usually biggest pieces of work sit
+class work_stealing_pool {
+public:
+    // the index of the worker running the task, pass it back to push() to keep new work local
+    using task = std::function<void(size_t worker)>;
+
+    explicit work_stealing_pool(size_t threadCount);
+
+    work_stealing_pool(const work_stealing_pool&) = delete;
+    work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+    // tasks must not throw, before run() any worker index spreads the initial work
+    void push(size_t worker, task work);
+    // blocks until every task is done, including the ones pushed while running
+    void run();
+    // drops everything still queued, tasks that are already running finish
+    void cancel();
+
+    [[nodiscard]] size_t size() const { return queues.size(); }
+
+private:
+    struct worker_queue {
+        std::mutex mutex;
+        std::deque<task> tasks;
+    };
+
+    [[nodiscard]] bool pop(size_t worker, task& work);
+    [[nodiscard]] bool steal(size_t worker, task& work);
+    void worker_loop(size_t worker);
+    // wakes every parked worker so they can see the pool is done
+    void finish();
+
+    std::vector<std::unique_ptr<worker_queue>> queues;
+    std::atomic<size_t> pending = 0; // queued plus running, workers exit once it drops to zero
+    // idle workers park here instead of spinning while one slow task may still push more work
+    std::mutex idleMutex;
+    std::condition_variable idle;
+    uint64_t pushes = 0; // bumped under idleMutex on every push, a parked worker wakes when it moves
+};